@@ -13,7 +13,7 @@ DECLARE_ENUM(performType,			run, abort, saveImg, editImg, rewriteImgs);
 DECLARE_ENUM(analysisResultStatus,	validationError, fatalError, imageSaved, imageEdited, imagesRewritten, complete, running, changed, waiting);
 DECLARE_ENUM(moduleStatus,			initializing, installNeeded, loading, installModPkgNeeded, readyForUse, error);
 DECLARE_ENUM(engineAnalysisStatus,	empty, toRun, running, changed, complete, error, exception, aborted, stopped, saveImg, editImg, rewriteImgs, synchingData);
-DECLARE_ENUM(enginesListRoles,		channel =  257, module, engineState, analysisStatus, runsWhat, running, idle, idleSoon); //hardcoded Qt::UserRole + 1, sue me.
+DECLARE_ENUM(enginesListRoles,		channel =  257, module, engineState, analysisStatus, runsWhat, running, idle, idleSoon, memory, analysesHeld); //hardcoded Qt::UserRole + 1, sue me.
 
 struct unexpectedEngineReply  : public std::runtime_error
 {
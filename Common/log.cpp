@@ -5,14 +5,27 @@
 #include <chrono>
 #ifdef WIN32
 #include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
 #endif
+#include <fcntl.h>
 
 #include <fstream>
 #include "utils.h"
 #include <codecvt>
 #include <fstream>
-
-std::ofstream Log::_logFile;// = bofstream();
+#include <sstream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <cstdlib>
+#include <csignal>
+#include <exception>
+#include <string_view>
+
+std::ofstream & Log::_logFile = *new std::ofstream(); //Never destroyed, so whatever logs from a static destructor can still write to it
 
 std::ostream* Log::_nullStream = &std::cout;
 
@@ -23,6 +36,8 @@ std::string	Log::_logFilePath		= "";
 logError	Log::_logError			= logError::noProblem;
 int			Log::_stdoutfd			= -1;
 int			Log::_engineNo			= -1;
+unsigned	Log::_categoriesOff		= 0;
+size_t		Log::_jsonMaxChars		= 4000;
 
 
 logType		Log::_default			=
@@ -32,6 +47,321 @@ logType		Log::_default			=
 	logType::null;
 #endif
 
+logLevel	Log::_level				=
+#ifdef JASP_DEBUG
+	logLevel::debug;
+#else
+	logLevel::info;
+#endif
+
+static std::mutex logFileMutex; //Only the LogWriter thread and (re)opening the file take this
+
+static std::atomic<int>		crashLogFd	= -1;		///< A descriptor of its own to the log file, write(2) on it is about all a signal handler may do
+static std::atomic<bool>	crashLogged	= false;	///< std::terminate ends in abort and thus SIGABRT, that one does not need to be logged again
+
+///
+/// Bounded multi-producer single-consumer queue (after Dmitry Vyukov's), each slot holds a complete message.
+/// Logging threads only do an atomic compare-exchange and a move to get their message in, a single background thread writes them to Log::_logFile.
+/// When it is full the logging thread yields until there is room again, messages are never dropped.
+/// Errors are written right away instead, after whatever was queued before them, so they are on disk even if the process dies right after.
+/// It is never destroyed: at exit the thread is stopped and anything logged after that, say from a static destructor, is written directly.
+class LogWriter
+{
+public:
+	static LogWriter & writer()
+	{
+		static LogWriter * writer = new LogWriter();
+		return *writer;
+	}
+
+	void push(std::string && message)
+	{
+		if(_stopped)
+		{
+			writeNow(std::move(message));
+			return;
+		}
+
+		std::call_once(_started, [this](){ _thread = std::thread(&LogWriter::run, this); });
+
+		size_t	pos = _enqueuePos.load(std::memory_order_relaxed);
+		Slot *	slot;
+
+		for(;;)
+		{
+			slot = &_slots[pos % _capacity];
+
+			ptrdiff_t dif = ptrdiff_t(slot->sequence.load(std::memory_order_acquire)) - ptrdiff_t(pos);
+
+			if(dif == 0)
+			{
+				if(_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else
+			{
+				if(dif < 0)
+					std::this_thread::yield(); //full, wait for the writer to catch up
+
+				pos = _enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		slot->message = std::move(message);
+		slot->sequence.store(pos + 1, std::memory_order_release);
+		_pushed++;
+	}
+
+	///Writes message and everything queued before it on the calling thread
+	void writeNow(std::string && message)
+	{
+		std::lock_guard<std::mutex> lock(logFileMutex);
+
+		drainLocked();
+		Log::_logFile << message;
+		Log::_logFile.flush();
+	}
+
+	void flush()
+	{
+		while(_thread.joinable() && !_stopped && _written < _pushed)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	///For the std::terminate handler: writes what is queued, what the crashing thread was still logging and why it crashed.
+	///The thread that crashed might hold logFileMutex, so that is only waited on for a little while.
+	static void crashed(const std::string & unfinished, const char * why)
+	{
+		if(crashLogged.exchange(true))
+			return;
+
+		std::unique_lock<std::mutex> lock(logFileMutex, std::defer_lock);
+
+		for(int tries=0; tries<50 && !lock.try_lock(); tries++)
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+		writer().drainLocked();
+		Log::_logFile << unfinished << Log::getTimestamp() << ": Crashed with " << why << std::endl;
+	}
+
+private:
+	LogWriter() : _slots(new Slot[_capacity])
+	{
+		for(size_t i=0; i<_capacity; i++)
+			_slots[i].sequence = i;
+
+		std::atexit([](){ LogWriter::writer().stop(); });
+	}
+
+	void stop()
+	{
+		_stopped	= true;
+		_stop		= true;
+
+		if(_thread.joinable())
+			_thread.join();
+
+		std::lock_guard<std::mutex> lock(logFileMutex);
+		drainLocked(); //Anything pushed while the thread was stopping
+	}
+
+	///Only with logFileMutex held, that makes whoever holds it the single consumer
+	void drainLocked()
+	{
+		std::string	message;
+		size_t		wrote = 0;
+
+		for(; pop(message); wrote++)
+			Log::_logFile << message;
+
+		if(wrote)
+			Log::_logFile.flush();
+
+		_written += wrote;
+	}
+
+	bool pop(std::string & message)
+	{
+		Slot & slot = _slots[_dequeuePos % _capacity];
+
+		if(slot.sequence.load(std::memory_order_acquire) != _dequeuePos + 1)
+			return false;
+
+		message = std::move(slot.message);
+		slot.sequence.store(_dequeuePos + _capacity, std::memory_order_release);
+		_dequeuePos++;
+
+		return true;
+	}
+
+	void run()
+	{
+		for(;;)
+		{
+			const size_t writtenBefore = _written;
+			{
+				std::lock_guard<std::mutex> lock(logFileMutex);
+				drainLocked();
+			}
+
+			if(_written == writtenBefore)
+			{
+				if(_stop)
+					return;
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			}
+		}
+	}
+
+	struct Slot
+	{
+		std::atomic<size_t>	sequence;
+		std::string			message;
+	};
+
+	static constexpr size_t		_capacity	= 4096;
+	std::unique_ptr<Slot[]>		_slots;
+	std::atomic<size_t>			_enqueuePos	= 0,
+								_pushed		= 0,
+								_written	= 0;
+	size_t						_dequeuePos	= 0;
+	std::atomic<bool>			_stop		= false,
+								_stopped	= false;
+	std::once_flag				_started;
+	std::thread					_thread;
+};
+
+///Collects what a thread logs until std::endl or a flush and then hands it to the LogWriter as a single message.
+///A message that was never ended goes along as soon as the thread starts the next one, or when the thread exits.
+class LogRecordBuffer : public std::stringbuf
+{
+public:
+	LogRecordBuffer(bool alwaysSynchronous = false) : _alwaysSynchronous(alwaysSynchronous) {}
+	~LogRecordBuffer() { sync(); }
+
+	void startRecord(bool synchronous)
+	{
+		sync();
+		_synchronous = synchronous || _alwaysSynchronous;
+	}
+
+protected:
+	int sync() override
+	{
+		if(!str().empty())
+		{
+			if(_synchronous || _alwaysSynchronous)	LogWriter::writer().writeNow(str());
+			else									LogWriter::writer().push(str());
+
+			str("");
+		}
+
+		return 0;
+	}
+
+private:
+	const bool	_alwaysSynchronous;
+	bool		_synchronous = false;
+};
+
+static thread_local bool logRecordGone = false; ///< Trivially destructible, so it can still be read after the other thread_locals of the thread were destroyed
+
+struct LogRecord
+{
+	LogRecordBuffer	buffer;
+	std::ostream	stream{&buffer};
+
+	~LogRecord() { logRecordGone = true; }
+};
+
+///The buffer and stream of the calling thread, or for whatever is logged after those were destroyed (like from static destructors on the main thread) one that writes directly
+static LogRecord & logRecord()
+{
+	static thread_local LogRecord	record;
+	static LogRecord			*	afterExit = new LogRecord{LogRecordBuffer(true)};
+
+	return logRecordGone ? *afterExit : record;
+}
+
+static LogRecordBuffer	& logRecordBuffer() { return logRecord().buffer; }
+static std::ostream		& logRecordStream() { return logRecord().stream; }
+
+static std::terminate_handler previousTerminateHandler = nullptr;
+
+///Replaces crashLogFd by a fresh descriptor to filePath, or by none if filePath is empty
+static void crashLogFdOpen(const std::string & filePath)
+{
+	int fd = -1;
+
+	if(filePath != "")
+#ifdef WIN32
+		fd = _open(filePath.c_str(), _O_WRONLY | _O_APPEND | _O_CREAT, _S_IREAD | _S_IWRITE);
+#else
+		fd = open(filePath.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+#endif
+
+	int previous = crashLogFd.exchange(fd);
+
+	if(previous != -1)
+#ifdef WIN32
+		_close(previous);
+#else
+		close(previous);
+#endif
+}
+
+///Anything that allocates, locks or touches the queue might be what crashed, so only a message that was there all along is written straight to the file.
+///Whatever was still queued is lost, std::terminate does get to write that out.
+static void logCrashSignalHandler(int signal)
+{
+	const int			fd	= crashLogFd.load();
+	std::string_view	why	=	signal == SIGSEGV	? "\nCrashed with SIGSEGV, whatever was still queued for the log is lost.\n"
+							:	signal == SIGABRT	? "\nCrashed with SIGABRT, whatever was still queued for the log is lost.\n"
+							:	signal == SIGFPE	? "\nCrashed with SIGFPE, whatever was still queued for the log is lost.\n"
+							:						  "\nCrashed with SIGILL, whatever was still queued for the log is lost.\n";
+
+	if(fd != -1 && !crashLogged.exchange(true))
+	{
+#ifdef WIN32
+		[[maybe_unused]] int		wrote = _write(fd, why.data(), unsigned(why.size()));
+#else
+		[[maybe_unused]] ssize_t	wrote = write(fd, why.data(), why.size());
+#endif
+	}
+
+	std::signal(signal, SIG_DFL);
+	std::raise(signal);
+}
+
+///Only takes a signal nobody else handles yet, R for one has its own SIGSEGV handler in the engines
+static void installCrashSignalHandler(int signal)
+{
+	auto previous = std::signal(signal, logCrashSignalHandler);
+
+	if(previous != SIG_DFL && previous != SIG_ERR)
+		std::signal(signal, previous);
+}
+
+static void installCrashHandlers()
+{
+	static std::once_flag installed;
+
+	std::call_once(installed, []()
+	{
+		for(int signal : { SIGSEGV, SIGABRT, SIGFPE, SIGILL })
+			installCrashSignalHandler(signal);
+
+		previousTerminateHandler = std::set_terminate([]()
+		{
+			LogWriter::crashed(logRecordBuffer().str(), "std::terminate");
+
+			if(previousTerminateHandler)	previousTerminateHandler();
+			else							std::abort();
+		});
+	});
+}
+
 void Log::setDefaultDestination(logType newDestination)
 {
 	if(newDestination == logType::file) //It doesnt make any sense to have the default non-file logType be file...
@@ -51,6 +381,7 @@ void Log::setDefaultDestination(logType newDestination)
 void Log::setWhere(logType where)
 {
 	log() << std::flush;
+	flush();
 
 	if(where == _where)
 		return;
@@ -73,13 +404,68 @@ void Log::setLogFileName(const std::string & filePath)
 	_logFilePath = filePath;
 
 	if(_where == logType::file)
+	{
+		flush();
 		redirectStdOut();
+	}
 }
 
 void Log::init(std::ostream* nullStream)
 {
 	_where			= _default;
 	_nullStream		= nullStream;
+
+	if(const char * level = std::getenv("JASP_LOG_LEVEL"))
+		try							{ _level = logLevelFromString(level); }
+		catch(std::exception & e)	{ std::cerr << "JASP_LOG_LEVEL '" << level << "' is not one of debug, info, warning or error" << std::endl; }
+
+	if(const char * categoriesOff = std::getenv("JASP_LOG_CATEGORIES_OFF"))
+	{
+		std::stringstream	categories(categoriesOff);
+		std::string			category;
+
+		while(std::getline(categories, category, ','))
+			try							{ setCategoryEnabled(logCategoryFromString(category), false); }
+			catch(std::exception & e)	{ std::cerr << "JASP_LOG_CATEGORIES_OFF contains unknown category '" << category << "'" << std::endl; }
+	}
+
+	if(const char * jsonMax = std::getenv("JASP_LOG_JSON_MAX"))
+		_jsonMaxChars = std::strtoul(jsonMax, nullptr, 10);
+}
+
+void Log::setCategoryEnabled(logCategory category, bool enabled)
+{
+	unsigned bit = 1u << unsigned(category);
+
+	_categoriesOff = enabled ? _categoriesOff & ~bit : _categoriesOff | bit;
+}
+
+bool Log::enabled(logLevel level, logCategory category)
+{
+	return _where != logType::null && level >= _level && !(_categoriesOff & (1u << unsigned(category)));
+}
+
+void Log::flush()
+{
+	if(_where == logType::file)
+		logRecordStream() << std::flush;
+
+	LogWriter::writer().flush();
+}
+
+std::string Log::json(const Json::Value & json)
+{
+	std::string styled = json.toStyledString();
+
+	if(_level == logLevel::debug || _jsonMaxChars == 0 || styled.size() <= _jsonMaxChars)
+		return styled;
+
+	size_t cut = _jsonMaxChars;
+
+	while(cut > 0 && (styled[cut] & 0xC0) == 0x80) //dont cut an utf8 character in half
+		cut--;
+
+	return styled.substr(0, cut) + "\n... (" + std::to_string(styled.size() - cut) + " more characters, set JASP_LOG_LEVEL=debug to see all of it)";
 }
 
 void Log::redirectStdOut()
@@ -87,6 +473,7 @@ void Log::redirectStdOut()
 	switch(_where)
 	{
 	default:
+		crashLogFdOpen(""); //Nothing left for the signal handlers to write to
 		break;
 
 	case logType::file:
@@ -102,6 +489,11 @@ void Log::redirectStdOut()
 		//_currentFile = freopen(_logFilePath.c_str(), "a", stdout);
 		//if(!_currentFile)
 
+		std::lock_guard<std::mutex> lock(logFileMutex);
+
+		if(_logFile.is_open())
+			_logFile.close();
+
 		_logFile.open(_logFilePath.c_str(), std::ios_base::app | std::ios_base::out);
 
 		if(_logFile.fail())
@@ -111,6 +503,9 @@ void Log::redirectStdOut()
 			redirectStdOut();
 			return;
 		}
+
+		crashLogFdOpen(_logFilePath);
+		installCrashHandlers();
 		break;
 	};
 	}
@@ -122,19 +517,26 @@ Json::Value	Log::createLogCfgMsg()
 {
 	Json::Value json	= Json::objectValue;
 
-	json["where"]		= logTypeToString(_where);
+	json["where"]			= logTypeToString(_where);
+	json["level"]			= logLevelToString(_level);
+	json["categoriesOff"]	= _categoriesOff;
+	json["jsonMaxChars"]	= Json::UInt64(_jsonMaxChars);
 
 	return json;
 }
 
 void Log::parseLogCfgMsg(const Json::Value & json)
 {
+	if(json.isMember("level"))			_level			= logLevelFromString(json["level"].asString());
+	if(json.isMember("categoriesOff"))	_categoriesOff	= json["categoriesOff"].asUInt();
+	if(json.isMember("jsonMaxChars"))	_jsonMaxChars	= json["jsonMaxChars"].asUInt64();
+
 	setWhere(logTypeFromString(json["where"].asString()));
 }
 
 const char * Log::getTimestamp()
 {
-	static char buf[13];
+	static thread_local char buf[13];
 	static auto startTime = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::system_clock::now());
 
 	std::chrono::milliseconds duration = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::system_clock::now()) - startTime;
@@ -155,6 +557,27 @@ const char * Log::getTimestamp()
 }
 
 std::ostream & Log::log(bool addTimestamp)
+{
+	if(!enabled(logLevel::info))
+		return *_nullStream;
+
+	return destination(addTimestamp);
+}
+
+std::ostream & Log::log(logLevel level, logCategory category)
+{
+	if(!enabled(level, category))
+		return *_nullStream;
+
+	std::ostream & out = destination(true, level >= logLevel::error);
+
+	if(level != logLevel::info)				out << logLevelToString(level)			<< " ";
+	if(category != logCategory::general)	out << "[" << logCategoryToString(category)	<< "] ";
+
+	return out;
+}
+
+std::ostream & Log::destination(bool addTimestamp, bool synchronous)
 {
 	switch(_where)
 	{
@@ -164,8 +587,10 @@ std::ostream & Log::log(bool addTimestamp)
 	}
 	case logType::file:
 	{
-		if (addTimestamp) _logFile << Log::getTimestamp() << ": ";
-		return _logFile;
+		std::ostream & out = logRecordStream();
+		logRecordBuffer().startRecord(synchronous);
+		if (addTimestamp) out << Log::getTimestamp() << ": ";
+		return out;
 	}
 	case logType::cout:
 	default:
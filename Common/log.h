@@ -6,8 +6,13 @@
 #include <json/json.h>
 #include <ostream>
 
-DECLARE_ENUM(logType,  cout, file, null);
-DECLARE_ENUM(logError, noProblem, fileNotOpen, filePathNotSet);
+DECLARE_ENUM(logType,		cout, file, null);
+DECLARE_ENUM(logError,		noProblem, fileNotOpen, filePathNotSet);
+DECLARE_ENUM(logLevel,		debug, info, warning, error);
+DECLARE_ENUM(logCategory,	general, ipc, data, modules, results, engine);
+
+///Only evaluates whatever is streamed into it when that level and category would actually end up somewhere, use it for anything expensive to format.
+#define JASPLOG(LEVEL, CATEGORY) if(!Log::enabled(logLevel::LEVEL, logCategory::CATEGORY)) {} else Log::log(logLevel::LEVEL, logCategory::CATEGORY)
 
 ///
 /// As might be obvious from the name this is the main class for logging.
@@ -16,11 +21,31 @@ DECLARE_ENUM(logError, noProblem, fileNotOpen, filePathNotSet);
 /// In both cases a setting can be turned on to write it all to files, then a file for Desktop is created and one for each running engine. 
 /// They will all have the exact same timestamp in the filename to easily group them.
 /// For almost all messages a timestamp and identifier is added. But because the output from R (and some other places) comes in in pieces we omit that there.
+///
+/// Messages have a logLevel and a logCategory, plain log() is info and general. Anything below level() or in a category that was switched off is dropped, 
+/// and with JASPLOG it isn't even formatted. The level and categories can be set through JASP_LOG_LEVEL (debug, info, warning or error) and
+/// JASP_LOG_CATEGORIES_OFF (comma separated, e.g. "ipc,data") in the environment, which the engines inherit from Desktop.
+/// When logging to file each thread collects its message in its own buffer and hands it over at std::endl (or flush) to a lock-free queue,
+/// a background thread writes those to the file so that the thread that logs never waits on the disk.
+/// Errors are the exception, those are written before log() returns the next time, or at std::endl, so they survive a crash right after.
+/// At std::terminate and at exit whatever is still queued is written first. A fatal signal nobody else handles only gets a line saying which one,
+/// because a signal handler cannot safely do more than write(2) something it already had.
 /// 
 class Log
 {
 public:
 	static std::ostream & log(bool addTimestamp = true);
+	static std::ostream & log(logLevel level, logCategory category);
+
+	static bool			enabled(logLevel level, logCategory category = logCategory::general);
+	static std::string	json(const Json::Value & json);						///< Styled, but cut short beyond jsonMaxChars() unless the level is debug
+	static void			flush();											///< Waits until everything logged so far was written
+
+	static logLevel		level()							{ return _level; }
+	static void			setLevel(logLevel level)		{ _level = level; }
+	static void			setCategoryEnabled(logCategory category, bool enabled);
+	static size_t		jsonMaxChars()					{ return _jsonMaxChars; }
+	static void			setJsonMaxChars(size_t maxChars){ _jsonMaxChars = maxChars; }
 
 	static std::string	logFileNameBase;
 
@@ -42,6 +67,7 @@ public:
 private:
 						Log() { }
 	static void			redirectStdOut();
+	static std::ostream & destination(bool addTimestamp, bool synchronous = false);
 	static const char * getTimestamp();
 
 	static logType		_default;
@@ -51,7 +77,12 @@ private:
 	static int			_stdoutfd,
 						_engineNo;
 	static std::ostream*	_nullStream;
-	static std::ofstream	_logFile;
+	static std::ofstream &	_logFile;
+	static logLevel			_level;
+	static unsigned			_categoriesOff;
+	static size_t			_jsonMaxChars;
+
+	friend class LogWriter;
 
 };
 
@@ -20,10 +20,17 @@
 #ifdef _WIN32
 #include <windows.h>
 #include <tlhelp32.h>
+#include <psapi.h>
 #else
 #include "unistd.h"
 #endif
 
+#ifdef __APPLE__
+#include <mach/mach.h>
+#elif !defined(_WIN32)
+#include <fstream>
+#endif
+
 unsigned long ProcessInfo::currentPID()
 {
 
@@ -90,3 +97,35 @@ bool ProcessInfo::isParentRunning()
 	return getppid() != 1;
 #endif
 }
+
+size_t ProcessInfo::residentMemory()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.WorkingSetSize;
+
+	return 0;
+
+#elif defined(__APPLE__)
+	mach_task_basic_info_data_t	info;
+	mach_msg_type_number_t		count = MACH_TASK_BASIC_INFO_COUNT;
+
+	if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS)
+		return info.resident_size;
+
+	return 0;
+
+#else
+	//The second number is the resident set in pages
+	std::ifstream	statm("/proc/self/statm");
+	size_t			size		= 0,
+					resident	= 0;
+
+	if(statm >> size >> resident)
+		return resident * sysconf(_SC_PAGESIZE);
+
+	return 0;
+#endif
+}
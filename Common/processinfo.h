@@ -18,6 +18,7 @@
 #ifndef PROCESSINFO_H
 #define PROCESSINFO_H
 
+#include <cstddef>
 
 ///
 /// Get your PID here!
@@ -31,6 +32,9 @@ public:
 
 	static bool isParentRunning();
 
+	///How many bytes of this process are in memory right now, 0 if that is unknown
+	static size_t residentMemory();
+
 };
 
 #endif // PROCESS_H
@@ -168,6 +168,8 @@ void TempFiles::deleteOrphans()
 						std::filesystem::remove_all(p, error);
 						if (error)
 							Log::log() << "Error when deleting directory: " << error.message() << std::endl;
+
+						std::filesystem::remove(Utils::osPath(Utils::osPath(p) + journalPostfix), error);
 					}
 					else
 						aliveIDs.push_back(p.filename().string());
@@ -177,8 +179,17 @@ void TempFiles::deleteOrphans()
 					std::filesystem::remove_all(p, error);
 					if (error)
 						Log::log() << "Error when deleting directory, had no status file and " << error.message() << std::endl;
+
+					std::filesystem::remove(Utils::osPath(Utils::osPath(p) + journalPostfix), error);
 				}
 			}
+			else if (p.extension() == journalPostfix && !std::filesystem::exists(Utils::osPath(p.parent_path() / p.stem()), error))
+			{
+				//A journal whose session dir was removed already, without it there is nothing to recover
+				std::filesystem::remove(p, error);
+				if (error)
+					Log::log() << "Error when deleting journal: " << error.message() << std::endl;
+			}
 		}
 
 		//Delete files in the root not associated with the IDs that have been active for x time
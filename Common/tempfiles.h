@@ -54,11 +54,14 @@ public:
 	static std::string	createTmpFolder();
 
 	static std::string	sessionDirName() { return _sessionDirName; }
+
+	static constexpr const char * journalPostfix = ".journal";								///< AutosaveJournal writes to sessionDirName() + journalPostfix
+
 	static stringvec	retrieveList(int id = -1);
 
 	static void			deleteList(const stringvec &files);
 	static void			deleteAll(int id = -1);
-	static void			deleteOrphans();
+	static void			deleteOrphans();												///< Also removes the journal AutosaveJournal keeps next to an orphaned session dir, or one whose dir is gone
 
 	static void			deleteStrayRootFiles(const stringvec& validIDs, long outOfDateDelta);
 
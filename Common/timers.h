@@ -1,6 +1,11 @@
 #ifndef TIMERS_H
 #define TIMERS_H
 
+#include "tracing.h"
+
+///
+/// JASPTIMER_SCOPE always records a span for Tracing (which costs next to nothing unless tracing was switched on), the other timers only exist with PROFILE_JASP.
+
 #ifdef PROFILE_JASP
 
 ///
@@ -30,7 +35,7 @@ struct _JaspTimerScopeMeasure
 
 	const char * _name;
 };
-#define JASPTIMER_SCOPE(TIMERNAME) _JaspTimerScopeMeasure singleScopeTimer(#TIMERNAME)
+#define JASPTIMER_SCOPE(TIMERNAME) _JaspTimerScopeMeasure singleScopeTimer(#TIMERNAME); JASPTRACE_SCOPE_STR(#TIMERNAME)
 #define JASPTIMER_CLASS(TIMERNAME) _JaspTimerScopeMeasure singleScopeTimer = #TIMERNAME;
 
 #else
@@ -41,7 +46,7 @@ struct _JaspTimerScopeMeasure
 #define JASPTIMER_PRINT(  TIMERNAME ) /* TIMERNAME */
 #define JASPTIMER_FINISH( TIMERNAME ) /* TIMERNAME */
 #define JASPTIMER_PRINTALL() /* bla bla bla */
-#define JASPTIMER_SCOPE(TIMERNAME) /* Hmm hmm */
+#define JASPTIMER_SCOPE(TIMERNAME) JASPTRACE_SCOPE_STR(#TIMERNAME)
 #define JASPTIMER_CLASS(TIMERNAME) /* Hmm hmm */
 #endif
 
@@ -0,0 +1,261 @@
+#include "tracing.h"
+#include "processinfo.h"
+#include <unordered_map>
+#include <fstream>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <cstdlib>
+#include <algorithm>
+#include <tuple>
+#include <map>
+
+static const std::string	traceEnv			= std::getenv("JASP_TRACE") ? std::getenv("JASP_TRACE") : "";
+std::atomic<bool>			Tracing::_enabled	(traceEnv != "" && traceEnv != "0");
+std::string					Tracing::_exportPath(traceEnv.size() > 5 && traceEnv.compare(traceEnv.size() - 5, 5, ".json") == 0 ? traceEnv : "");
+
+static const size_t			maxRemoteEvents	= 1000000;
+
+///Each field is atomic (and relaxed) only so that another thread may copy a span while its own thread is writing a newer one elsewhere in the ring
+struct TraceSpan
+{
+	std::atomic<uint32_t>	id;
+	std::atomic<int64_t>	begin,
+							end;
+};
+
+///Only its own thread writes to it, others read it through snapshot() which skips what was overwritten while it was reading
+struct ThreadTraceBuffer
+{
+	static constexpr size_t	capacity = 1 << 14;
+
+	ThreadTraceBuffer(uint32_t tid) : spans(new TraceSpan[capacity]), tid(tid) {}
+
+	void record(uint32_t id, int64_t begin, int64_t end)
+	{
+		size_t		index	= written.load(std::memory_order_relaxed);
+		TraceSpan & span	= spans[index % capacity];
+
+		span.id		.store(id,		std::memory_order_relaxed);
+		span.begin	.store(begin,	std::memory_order_relaxed);
+		span.end	.store(end,		std::memory_order_relaxed);
+
+		written.store(index + 1, std::memory_order_release);
+	}
+
+	///Calls copy(id, begin, end) for every span from index `from` onwards that is still in the ring, and returns up to where it got
+	template<typename COPY> size_t snapshot(size_t from, COPY copy) const
+	{
+		size_t	until	= written.load(std::memory_order_acquire),
+				first	= std::max(from, until > capacity ? until - capacity : 0);
+
+		std::vector<std::tuple<uint32_t, int64_t, int64_t>> copied;
+		copied.reserve(until - first);
+
+		for(size_t i=first; i<until; i++)
+		{
+			const TraceSpan & span = spans[i % capacity];
+			copied.emplace_back(span.id.load(std::memory_order_relaxed), span.begin.load(std::memory_order_relaxed), span.end.load(std::memory_order_relaxed));
+		}
+
+		//Anything the owner might have been overwriting while we copied can't be trusted
+		size_t	now				= written.load(std::memory_order_acquire),
+				firstIntact		= now >= capacity ? now - capacity + 1 : 0;
+
+		for(size_t i=std::max(first, firstIntact); i<until; i++)
+			std::apply(copy, copied[i - first]);
+
+		return until;
+	}
+
+	std::unique_ptr<TraceSpan[]>	spans;
+	std::atomic<size_t>				written		= 0;
+	size_t							sentRemote	= 0;	///< Only touched while holding TraceRegistry::mutex
+	uint32_t						tid;
+};
+
+///Everything shared between threads, behind a function so that a scope traced during static initialization finds it constructed
+struct TraceRegistry
+{
+	std::mutex												mutex;
+	std::vector<std::shared_ptr<ThreadTraceBuffer>>			buffers;
+	std::vector<std::string>								names;
+	std::unordered_map<std::string, uint32_t>				ids;
+	std::string												processName		= "Desktop";
+	Json::Value												remoteEvents	= Json::arrayValue;
+	std::map<std::string, std::string>						remoteProcesses; //pid -> name
+
+	static TraceRegistry & registry()
+	{
+		static TraceRegistry * registry = new TraceRegistry(); //Never destroyed, threads might still be tracing while the process exits
+		return *registry;
+	}
+};
+
+static ThreadTraceBuffer & threadTraceBuffer()
+{
+	static thread_local std::shared_ptr<ThreadTraceBuffer> buffer = []()
+	{
+		TraceRegistry & reg = TraceRegistry::registry();
+		std::lock_guard<std::mutex> lock(reg.mutex);
+
+		reg.buffers.push_back(std::make_shared<ThreadTraceBuffer>(uint32_t(reg.buffers.size())));
+
+		return reg.buffers.back();
+	}();
+
+	return *buffer;
+}
+
+void Tracing::setProcessName(const std::string & processName)
+{
+	TraceRegistry & reg = TraceRegistry::registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	reg.processName = processName;
+}
+
+uint32_t Tracing::intern(const char * name)
+{
+	TraceRegistry & reg = TraceRegistry::registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+
+	auto found = reg.ids.find(name);
+
+	if(found != reg.ids.end())
+		return found->second;
+
+	reg.names.push_back(name);
+	return reg.ids[name] = uint32_t(reg.names.size() - 1);
+}
+
+int64_t Tracing::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracing::record(uint32_t id, int64_t begin, int64_t end)
+{
+	threadTraceBuffer().record(id, begin, end);
+}
+
+Json::Value Tracing::takeSpansForRemote()
+{
+	TraceRegistry & reg = TraceRegistry::registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+
+	Json::Value								spans	= Json::arrayValue,
+											names	= Json::arrayValue;
+	std::unordered_map<uint32_t, uint32_t>	nameIndex;
+
+	for(auto & buffer : reg.buffers)
+		buffer->sentRemote = buffer->snapshot(buffer->sentRemote, [&](uint32_t id, int64_t begin, int64_t end)
+		{
+			if(!nameIndex.count(id))
+			{
+				nameIndex[id] = names.size();
+				names.append(reg.names[id]);
+			}
+
+			Json::Value span(Json::arrayValue);
+			span.append(nameIndex[id]);
+			span.append(buffer->tid);
+			span.append(Json::Int64(begin));
+			span.append(Json::Int64(end - begin));
+			spans.append(span);
+		});
+
+	if(spans.size() == 0)
+		return Json::nullValue;
+
+	Json::Value remote		= Json::objectValue;
+	remote["process"]		= reg.processName;
+	remote["pid"]			= Json::UInt64(ProcessInfo::currentPID());
+	remote["names"]			= names;
+	remote["spans"]			= spans;
+
+	return remote;
+}
+
+static Json::Value chromeEvent(const std::string & name, const std::string & pid, uint32_t tid, int64_t begin, int64_t duration)
+{
+	Json::Value event	= Json::objectValue;
+	event["name"]		= name;
+	event["cat"]		= "jasp";
+	event["ph"]			= "X";
+	event["ts"]			= double(begin)		/ 1000.0; //Chrome wants microseconds
+	event["dur"]		= double(duration)	/ 1000.0;
+	event["pid"]		= pid;
+	event["tid"]		= tid;
+
+	return event;
+}
+
+void Tracing::addRemoteSpans(const Json::Value & remote)
+{
+	if(!remote.isObject() || !remote["spans"].isArray() || !remote["names"].isArray())
+		return;
+
+	TraceRegistry & reg = TraceRegistry::registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+
+	const std::string	pid		= remote["pid"].asString();
+	const Json::Value &	names	= remote["names"];
+
+	reg.remoteProcesses[pid] = remote["process"].asString();
+
+	for(const Json::Value & span : remote["spans"])
+		if(reg.remoteEvents.size() < maxRemoteEvents && span.isArray() && span.size() == 4)
+			reg.remoteEvents.append(chromeEvent(names[span[0].asUInt()].asString(), pid, span[1].asUInt(), span[2].asInt64(), span[3].asInt64()));
+}
+
+Json::Value Tracing::chromeTrace()
+{
+	TraceRegistry & reg = TraceRegistry::registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+
+	Json::Value			events	= reg.remoteEvents;
+	const std::string	pid		= std::to_string(ProcessInfo::currentPID());
+
+	auto processName = [&](const std::string & pid, const std::string & name)
+	{
+		Json::Value meta	= Json::objectValue;
+		meta["name"]		= "process_name";
+		meta["ph"]			= "M";
+		meta["pid"]			= pid;
+		meta["args"]["name"]= name;
+		events.append(meta);
+	};
+
+	processName(pid, reg.processName);
+
+	for(const auto & pidName : reg.remoteProcesses)
+		processName(pidName.first, pidName.second);
+
+	for(auto & buffer : reg.buffers)
+		buffer->snapshot(0, [&](uint32_t id, int64_t begin, int64_t end)
+		{
+			events.append(chromeEvent(reg.names[id], pid, buffer->tid, begin, end - begin));
+		});
+
+	Json::Value trace			= Json::objectValue;
+	trace["traceEvents"]		= events;
+	trace["displayTimeUnit"]	= "ns";
+
+	return trace;
+}
+
+bool Tracing::exportChromeTrace(const std::string & path)
+{
+	std::ofstream out(path, std::ios_base::out | std::ios_base::trunc);
+
+	if(!out.is_open())
+		return false;
+
+	Json::StreamWriterBuilder builder;
+	builder["indentation"] = "";
+
+	std::unique_ptr<Json::StreamWriter>(builder.newStreamWriter())->write(chromeTrace(), &out);
+
+	return out.good();
+}
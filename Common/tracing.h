@@ -0,0 +1,61 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <json/json.h>
+
+///
+/// Records spans (a scope that began and ended at some nanosecond) from any thread at very low cost, in Desktop as well as in the engines.
+/// Unlike the timers in timers.h this is always compiled in, recording starts when the environment variable JASP_TRACE is set (the engines inherit it) or through setEnabled.
+/// If JASP_TRACE is the path of a .json file Desktop writes the whole session there when it closes, in the Chrome trace format which chrome://tracing and ui.perfetto.dev can open.
+///
+/// Each scope name is interned once per call site, after that a span is an id, a thread and two timestamps.
+/// Those go into a fixed size ring buffer per thread so that threads never wait on eachother and a long session doesn't use ever more memory.
+/// The engines attach what they recorded to the messages they send anyway and Desktop adds that to its own timeline with addRemoteSpans.
+class Tracing
+{
+public:
+	static bool			enabled()				{ return _enabled.load(std::memory_order_relaxed); }
+	static void			setEnabled(bool enabled){ _enabled = enabled; }
+	static void			setProcessName(const std::string & processName);		///< How this process is called in the timeline, "Desktop" unless set
+
+	static uint32_t		intern(const char * name);
+	static int64_t		now();																	///< Nanoseconds on a clock that is shared by all processes on this machine
+	static void			record(uint32_t id, int64_t begin, int64_t end);
+
+	static Json::Value	takeSpansForRemote();													///< Everything recorded in this process since the last call, compact enough to send to Desktop
+	static void			addRemoteSpans(const Json::Value & spans);
+	static Json::Value	chromeTrace();															///< Everything recorded here or received through addRemoteSpans
+	static bool			exportChromeTrace(const std::string & path);
+	static std::string	exportPath()			{ return _exportPath; }
+
+private:
+						Tracing() {}
+
+	static std::atomic<bool>	_enabled;
+	static std::string			_exportPath;
+};
+
+///Records the time between its construction and destruction under the id it got
+class TraceScope
+{
+public:
+	TraceScope(uint32_t id) : _id(id), _begin(Tracing::enabled() ? Tracing::now() : -1) {}
+	~TraceScope() { if(_begin >= 0) Tracing::record(_id, _begin, Tracing::now()); }
+
+private:
+	uint32_t	_id;
+	int64_t		_begin;
+};
+
+#define JASPTRACE_CONCAT_(A, B) A ## B
+#define JASPTRACE_CONCAT(A, B) JASPTRACE_CONCAT_(A, B)
+
+///The name is interned only once, the first time this line runs
+#define JASPTRACE_SCOPE_STR(NAMESTR)	static const uint32_t JASPTRACE_CONCAT(_jaspTraceId, __LINE__) = Tracing::intern(NAMESTR); \
+										TraceScope JASPTRACE_CONCAT(_jaspTraceScope, __LINE__)(JASPTRACE_CONCAT(_jaspTraceId, __LINE__))
+#define JASPTRACE_SCOPE(NAME)			JASPTRACE_SCOPE_STR(#NAME)
+
+#endif // TRACING_H
@@ -91,7 +91,7 @@ void ArchiveReader::openEntry(const string &archivePath, const string &entryPath
 
 }
 
-void ArchiveReader::writeEntryToTempFiles(std::function<void(float)> progressCallback)
+void ArchiveReader::writeEntryToTempFiles(std::function<void(float)> progressCallback, const std::string & asFile)
 {
     if(!_isOpen)
         throw runtime_error("No archive loaded for writeEntryToTempFiles!");
@@ -107,7 +107,7 @@ void ArchiveReader::writeEntryToTempFiles(std::function<void(float)> progressCal
         throw runtime_error("Entry '"+_entryPath+"' has zero bytes data...");
 
 
-    std::ofstream file(TempFiles::createSpecific("", _entryPath).c_str(),  std::ios::out | std::ios::binary);
+    std::ofstream file(TempFiles::createSpecific("", asFile.empty() ? _entryPath : asFile).c_str(),  std::ios::out | std::ios::binary);
 
     static char streamBuff[8192 * 32];
     file.rdbuf()->pubsetbuf(streamBuff, sizeof(streamBuff)); //Set the buffer manually to make it much faster our issue https://github.com/jasp-stats/INTERNAL-jasp/issues/436 and solution from:  https://stackoverflow.com/a/15177770
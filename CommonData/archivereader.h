@@ -118,8 +118,9 @@ public:
 
     /**
      * @brief Saves the loaded entry as a file in tempfiles folder, progressCallback gets values from 0...1
+     * @param asFile Name of the file in tempfiles, if empty the path of the entry is used
      */
-    void writeEntryToTempFiles(std::function<void(float)> progressCallback = std::function<void(float)>());
+    void writeEntryToTempFiles(std::function<void(float)> progressCallback = std::function<void(float)>(), const std::string & asFile = "");
 
 	/**
 	 * @brief extension The file extension of the last archive entry.
@@ -58,6 +58,9 @@ void Column::dbLoad(int id, bool getValues)
 	db().columnGetComputedInfo(	_id, _analysisId, _invalidated, _forceTypes, _codeType, _rCode, _error, _constructorJson);
 	
 	_emptyValues->fromJson(emptyVals);
+	
+	_contentHashValid		= db().columnGetContentHash(_id, _contentHash);
+	_contentHashEmptyValues	= _emptyValues->generation(); //It was stored for the empty values that were stored with it
 
 	labelsTempReset();
 	db().labelsLoad(this);
@@ -462,6 +465,8 @@ stringset Column::mergeOldMissingDataMap(const Json::Value &missingData)
 		}
 	}
 	
+	_nonEmptyCountInvalidate();
+	
 	foundEmpty.erase(""); //So for some currently inscrutable reason empty strings were also stored in the missing data map... Remove any occurences.
 	
 	return foundEmpty;
@@ -475,6 +480,9 @@ columnType Column::setValues(const stringvec & values, const stringvec & labels,
 		(*aChange) = true;
 
 	assert(values.size() == labels.size() || labels.size() == 0);
+	
+	contentHashInvalidate();
+	_nonEmptyCountInvalidate();
 
 	size_t prevSize = _ints.size();
 	
@@ -487,33 +495,16 @@ columnType Column::setValues(const stringvec & values, const stringvec & labels,
 		_dbls[resetRow] = EmptyValues::missingValueDouble;
 	}
 	
-	bool	onlyDoubles = true, 
-			onlyInts	= true;
-	
 	//Make sure we have only 1 label per value and display combo, because otherwise this will get too complicated
 	if(labelsMergeDuplicates() && aChange)
 		(*aChange) = true;
 	
-	intset	ints;  // to suggest whether this is a scalar or not we need to know whether we have more than treshold ints or not.
-	int		tmpInt;
-	double	tmpDbl;
+	// to suggest whether this is a scalar or not we need to know whether we have more than treshold ints or not, setValue parses every value anyway so it counts them for us.
+	ColumnUtils::ValuesSniffed	sniffed;
+	const intset			&	ints	= sniffed.uniqueInts;
 	
 	for(size_t i=0; i<values.size(); i++)
-	{
-		setValue(i, values[i], labels.size() ? labels[i] : "", false);
-		
-		
-		if(values[i] != "" || (labels.size() && labels[i] != ""))
-		{
-			if(ColumnUtils::getIntValue(values[i], tmpInt))
-				ints.insert(tmpInt);
-			else
-				onlyInts = false;
-			
-			if(!ColumnUtils::getDoubleValue(values[i], tmpDbl))
-				onlyDoubles = false;
-		}
-	}
+		setValue(i, values[i], labels.size() ? labels[i] : "", false, &sniffed);
 	
 	if(labelsRemoveOrphans() && aChange)
 		(*aChange) = true;
@@ -522,14 +513,14 @@ columnType Column::setValues(const stringvec & values, const stringvec & labels,
 	dbUpdateValues(false);
 	
 	//Now determine what the most logical columntype would be given the current values AND empty values!
-	if(onlyInts && ints.size() <= thresholdScale && ints.size() > 0)
+	if(sniffed.onlyInts() && ints.size() <= thresholdScale)
 	{
 		if(ints.size() == 2)				return columnType::nominal;
 		if(ints.size() <= thresholdScale)	return columnType::ordinal;
 		return columnType::scale;
 	}
 	
-	if(onlyDoubles)
+	if(sniffed.onlyDoubles())
 		return columnType::scale;
 	
 	
@@ -589,6 +580,8 @@ bool Column::setDescriptions(strstrmap labelToDescriptionMap)
 			
 			anyChange = true;
 			
+			contentHashInvalidate();
+			
 			//Now we need to make sure that the _ints category points to the label
 			for(size_t row=0; row<_ints.size(); row++)
 				if(Utils::isEqual(_dbls[row], doubleValue))
@@ -631,17 +624,43 @@ void Column::_dbUpdateLabelOrder(bool noIncRevisionWhenBatchedPlease)
 	
 	labelsHandleAutoSort(false);
 
-	intintmap orderPerDbIds;
-
 	for(size_t i=0; i<_labels.size(); i++)
-	{
-		_labels[i]->setOrder(i);
-		orderPerDbIds[_labels[i]->dbId()] = i;
-	}
+		if(_labels[i]->order() != int(i))
+		{
+			_labels[i]->setOrder(i);
+			_labelsOrderDirty.insert(_labels[i]);
+		}
+	
+	//The labels changed even if their order didn't, so the revision needs to go up at the flush
+	_labelsOrderFlushPending	= true;
+	_labelsTempRevision			= -1; //Otherwise labelsTemp would only be recreated after the flush
+	
+	_data->labelsOrderChanged(this);
+}
+
+void Column::labelsOrderFlush()
+{
+	if(!_labelsOrderFlushPending)
+		return;
+	
+	JASPTIMER_SCOPE(Column::labelsOrderFlush);
+	
+	intintmap orderPerDbIds;
+	
+	for(Label * label : _labels)
+		if(_labelsOrderDirty.count(label) && label->dbId() != -1)
+			orderPerDbIds[label->dbId()] = label->order();
+	
+	_labelsOrderDirty.clear();
+	_labelsOrderFlushPending = false;
 
 	db().labelsSetOrder(orderPerDbIds);
 	
+	const bool nonEmptyCountValid = _nonEmptyCountValid;
+	
 	incRevision(false);
+	
+	_nonEmptyCountValid = nonEmptyCountValid; //Which rows have a value doesn't depend on the order of their labels
 }
 
 void Column::_sortLabelsByOrder()
@@ -654,6 +673,10 @@ void Column::labelsClear()
 	db().labelsClear(_id);
 	_labels.clear();
 	_labelByIntsIdMap.clear();
+	_labelsIndexDrop();
+	_labelsFreeIntsIdFrom = 0;
+	_labelsOrderDirty.clear();
+	_labelsOrderFlushPending = false;
 	
 	incRevision(false);
 }
@@ -673,6 +696,10 @@ void Column::endBatchedLabelsDB(bool wasWritingBatch)
 	
 	if(_batchedLabelDepth == 0)
 	{
+		//Either everything was just written or it was just loaded, so nothing is left to flush
+		_labelsOrderDirty.clear();
+		_labelsOrderFlushPending = false;
+		
 		if(wasWritingBatch)
 		{
 			db().labelsWrite(this);
@@ -704,14 +731,15 @@ int Column::labelsAdd(const std::string &display)
 
 int Column::labelsAdd(const std::string & display, const std::string & description, const Json::Value & originalValue)
 {
-	sizetset intIds;
+	return labelsAdd(_labelsFreeIntsId(), display, true, description, originalValue);
+}
+
+int Column::_labelsFreeIntsId()
+{
+	while(_labelByIntsIdMap.count(_labelsFreeIntsIdFrom))
+		_labelsFreeIntsIdFrom++;
 	
-	for(Label * label : _labels)
-		intIds.insert(label->intsId());
-		
-	for(size_t newIntId = 0; ; newIntId++)
-		if(intIds.count(newIntId) == 0)
-			return labelsAdd(newIntId, display, true, description, originalValue);
+	return _labelsFreeIntsIdFrom;
 }
 
 int Column::labelsAdd(int value, const std::string & display, bool filterAllows, const std::string & description, const Json::Value & originalValue, int order, int id)
@@ -722,7 +750,11 @@ int Column::labelsAdd(int value, const std::string & display, bool filterAllows,
 	_labels.push_back(label);
 	
 	_labelByIntsIdMap[label->intsId()] = label;
+	
+	if(_labelsIndexed)
+		_labelsIndexAdd(label);
 
+	_nonEmptyCountInvalidate(); //Rows might refer to its intsId already, labelsOrderFlush leaves the count alone
 	_dbUpdateLabelOrder(true);
 	return label->intsId();
 }
@@ -738,9 +770,11 @@ void Column::labelsRemoveByIntsId(std::set<int> valuesToRemove)
 			_labels.begin(),
 			_labels.end(),
 			[&](Label * label) {
-				if(std::find(valuesToRemove.begin(), valuesToRemove.end(), label->intsId()) != valuesToRemove.end())
+				if(valuesToRemove.count(label->intsId()))
 				{
-						_labelByIntsIdMap.erase(label->intsId());
+					_labelsIndexRemove(label);
+					_labelByIntsIdMap.erase(label->intsId());
+					_labelsFreeIntsIdFrom = std::min(_labelsFreeIntsIdFrom, std::max(0, label->intsId()));
 					label->dbDelete();
 					delete label;
 					return true;
@@ -749,6 +783,7 @@ void Column::labelsRemoveByIntsId(std::set<int> valuesToRemove)
 			}),
 			_labels.end());
 
+	_nonEmptyCountInvalidate(); //Rows with those intsIds lost their label, labelsOrderFlush leaves the count alone
 	_dbUpdateLabelOrder();
 }
 
@@ -761,6 +796,7 @@ strintmap Column::labelsResetValues(int & maxValue)
 	strintmap result;
 	int labelValue = 0;
 	_labelByIntsIdMap.clear();
+	_labelsFreeIntsIdFrom = 0;
 
 	for (Label * label : _labels)
 	{
@@ -783,6 +819,8 @@ strintmap Column::labelsResetValues(int & maxValue)
 
 void Column::labelsRemoveBeyond(size_t indexToStartRemoving)
 {
+	contentHashInvalidate();
+	
 	for(size_t i=indexToStartRemoving; i<_labels.size(); i++)
 		delete _labels[i];
 	
@@ -940,9 +978,70 @@ void Column::_resetLabelValueMap()
 	for(Label * label : _labels)
 		_labelByIntsIdMap[label->intsId()] = label;
 	
+	_labelsFreeIntsIdFrom = 0;
+	_labelsIndexDrop();
 	labelsTempReset();
 }
 
+std::string Column::_labelsIndexValueKey(const Label * label)
+{
+	return label->originalValue().type() == Json::realValue ? ColumnUtils::doubleToString(label->originalValue().asDouble()) : label->originalValueAsString();
+}
+
+void Column::_labelsIndexBuild() const
+{
+	JASPTIMER_SCOPE(Column::_labelsIndexBuild);
+	
+	_labelsByValueIndex		.clear();
+	_labelsByDisplayIndex	.clear();
+	_labelsByValueIndex		.reserve(_labels.size());
+	_labelsByDisplayIndex	.reserve(_labels.size());
+	
+	for(Label * label : _labels)
+		_labelsIndexAdd(label);
+	
+	_labelsIndexed = true;
+}
+
+void Column::_labelsIndexAdd(Label * label) const
+{
+	_labelsByValueIndex		[_labelsIndexValueKey(label)]	.insert(label);
+	_labelsByDisplayIndex	[label->label()]				.insert(label);
+}
+
+void Column::_labelsIndexRemove(Label * label)
+{
+	if(!_labelsIndexed)
+		return;
+	
+	auto removeFrom = [&](std::unordered_map<std::string, Labelset> & index, const std::string & key)
+	{
+		auto found = index.find(key);
+		
+		if(found == index.end() || !found->second.erase(label))
+			return false;
+		
+		if(found->second.empty())
+			index.erase(found);
+		
+		return true;
+	};
+	
+	//If it isnt under its current key it changed without telling us, and then we can't trust the rest either
+	if(!removeFrom(_labelsByValueIndex, _labelsIndexValueKey(label)) | !removeFrom(_labelsByDisplayIndex, label->label()))
+		_labelsIndexDrop();
+}
+
+void Column::_labelsIndexDrop()
+{
+	if(!_labelsIndexed)
+		return;
+	
+	_labelsByValueIndex		.clear();
+	_labelsByDisplayIndex	.clear();
+	_labelsIndexed			= false;
+}
+
 std::string Column::_getLabelDisplayStringByValue(int key, bool ignoreEmptyValue) const
 {
 	if (key == EmptyValues::missingValueInteger)
@@ -1266,6 +1365,8 @@ bool Column::replaceDoubleLabelFromRowWithDouble(size_t row, double dbl)
 			if(Utils::isEqual(dblsRef, originalDbl))
 				dblsRef = dbl;
 	
+	_nonEmptyCountInvalidate();
+	
 	_labelsTempDbls[row]	=  dbl;
 	_labelsTemp[row]		=  ColumnUtils::doubleToString(dbl);
 	
@@ -1274,6 +1375,9 @@ bool Column::replaceDoubleLabelFromRowWithDouble(size_t row, double dbl)
 
 void Column::labelValueChanged(Label *label, double aDouble)
 {
+	_labelsIndexDrop();
+	_nonEmptyCountInvalidate();
+	
 	//Lets assume that all occurences of a label in _dbls are the same.
 	//So when we encounter one that is the same as what is passed here we can return immediately
 	
@@ -1297,6 +1401,9 @@ void Column::labelsHandleAutoSort(bool doDbUpdateEtc)
 
 void Column::labelDisplayChanged(Label *label)
 {
+	_labelsIndexDrop();
+	_nonEmptyCountInvalidate(); //The new display might be an empty value
+	
 	if(_labelsTempRevision < _revision)
 		return; //We dont care about this change anymore if the list is out of date
 
@@ -1334,8 +1441,7 @@ bool Column::setStringValue(size_t row, const std::string & userEntered, const s
 	double		newDoubleToSet	= EmptyValues::missingValueDouble;
 	bool		itsADouble		= ColumnUtils::getDoubleValue(userEntered, newDoubleToSet),
 				itsMissingVal	= isEmptyValue(userEntered),
-				nothingThereYet	=	!std::any_of(_ints.begin(), _ints.end(), [&](int i)		{ return !(i == Label::DOUBLE_LABEL_VALUE || i == EmptyValues::missingValueInteger || labelByIntsId(i)->isEmptyValue()); }) 
-								&&	!std::any_of(_dbls.begin(), _dbls.end(), [&](double d)	{ return !(std::isnan(d) || isEmptyValue(d)); });
+				nothingThereYet	= nonEmptyCount() == 0;
 	
 	if(nothingThereYet && !itsMissingVal)
 	{
@@ -1351,7 +1457,7 @@ bool Column::setStringValue(size_t row, const std::string & userEntered, const s
 	return setValue(row, userEntered, labelButOnlyFromSpreadsheetPaste, writeToDB);
 }
 
-bool Column::setValue(size_t row, const std::string & value, const std::string & label, bool writeToDB)
+bool Column::setValue(size_t row, const std::string & value, const std::string & label, bool writeToDB, ColumnUtils::ValuesSniffed * sniffed)
 {
 	JASPTIMER_SCOPE(Column::setValue(size_t row, const std::string & value, const std::string & label, writeToDB));
     
@@ -1359,13 +1465,27 @@ bool Column::setValue(size_t row, const std::string & value, const std::string &
 	//if both are "" we just want to clear the cell
 	//the assumption is that this is not direct user-input, but internal jasp stuff.
 	if(value == "" && label == "")
+	{
+		if(sniffed)
+			sniffed->add(ColumnUtils::valueKind::empty, 0, false);
+		
 		return setValue(row, EmptyValues::missingValueDouble, writeToDB);
+	}
+	
+	int								intValue		= 0;
+	double							newDoubleToSet	= EmptyValues::missingValueDouble;
+	const ColumnUtils::valueKind	kind			= ColumnUtils::sniffValue(value, intValue, newDoubleToSet);
+	
+	if(sniffed)
+		sniffed->add(kind, intValue, label != "");
 	
 	bool	labelIsValue	= value == label,
 			justAValue		= label == "";			///< To help us handle updates from synchronisation from csv (users might have added different label-texts
-	double	newDoubleToSet	= EmptyValues::missingValueDouble,
-			oldDouble		= _dbls[row];	
-	bool	itsADouble		= ColumnUtils::getDoubleValue(value, newDoubleToSet);
+	double	oldDouble		= _dbls[row];	
+	bool	itsADouble		= kind == ColumnUtils::valueKind::integer || kind == ColumnUtils::valueKind::decimal || kind == ColumnUtils::valueKind::commaDecimal;
+	
+	if(!itsADouble)
+		newDoubleToSet = EmptyValues::missingValueDouble; //Same as ColumnUtils::getDoubleValue
 	Label * newLabel		= justAValue ? labelByValue(value) : labelByValueAndDisplay(value, label);
 	Label * oldLabel		= _ints[row] == Label::DOUBLE_LABEL_VALUE ? nullptr : labelByIntsId(_ints[row]);
 	
@@ -1432,31 +1552,81 @@ bool Column::setValue(size_t row, int valueInt, double valueDbl, bool writeToDB)
 	if(row >= _dbls.size())
 		return false;
 	
-	bool changed = !Utils::isEqual(_dbls[row], valueDbl) || _ints[row] != valueInt;
+	bool		changed			= !Utils::isEqual(_dbls[row], valueDbl) || _ints[row] != valueInt,
+				updateHash		= changed && _contentHashUpToDate(),
+				updateCount		= _nonEmptyCountUpToDate();
+	uint64_t	contentHash		= updateHash ? _contentHash ^ _contentHashRow(row) : _contentHash; //Take out the old row
+	size_t		nonEmpty		= updateCount ? _nonEmptyCount - _rowHasValue(row) : 0;
 	
 	_dbls[row] = valueDbl;
 	_ints[row] = valueInt;
 	
+	if(updateHash)
+		contentHash ^= _contentHashRow(row); //And put in the new one
+	
+	if(updateCount)
+		nonEmpty += _rowHasValue(row);
+	
 	if(writeToDB && !_data->writeBatchedToDB())
 	{
 		db().columnSetValue(_id, row, valueInt, valueDbl);
 		incRevision(false);
 	}
 	
+	if(updateHash)
+		_contentHashSet(contentHash);
+	
+	if(updateCount)
+	{
+		_nonEmptyCount		= nonEmpty;
+		_nonEmptyCountValid	= true;
+	}
+	
 	return changed;
 }
 
 void Column::rowInsertEmptyVal(size_t row)
 {
-	_dbls.insert(_dbls.begin() + row, EmptyValues::missingValueDouble);
-	_ints.insert(_ints.begin() + row, EmptyValues::missingValueInteger);
+	rowsInsertEmptyVal(row, 1);
+}
+
+void Column::rowsInsertEmptyVal(size_t row, size_t count)
+{
+	_dbls.insert(_dbls.begin() + row, count, EmptyValues::missingValueDouble);
+	_ints.insert(_ints.begin() + row, count, EmptyValues::missingValueInteger);
+	
+	contentHashInvalidate(); //Every row after this one moved, so no point in updating it row by row
+	//Empty rows don't change the nonEmptyCount
 }
 
 void Column::rowDelete(size_t row)
 {
-	_dbls.erase(_dbls.begin() + row);
-	_ints.erase(_ints.begin() + row);
+	rowsDelete({{row, 1}});
+}
+
+void Column::rowsDelete(const rowRanges & ranges)
+{
+	if(ranges.empty())
+		return;
+	
+	size_t write = ranges[0].first;
+	
+	for(size_t r=0; r<ranges.size(); r++)
+	{
+		const size_t	keepFrom	= ranges[r].first + ranges[r].second,
+						keepTill	= r + 1 < ranges.size() ? ranges[r + 1].first : _ints.size();
+		
+		std::copy(_dbls.begin() + keepFrom, _dbls.begin() + keepTill, _dbls.begin() + write);
+		std::copy(_ints.begin() + keepFrom, _ints.begin() + keepTill, _ints.begin() + write);
+		
+		write += keepTill - keepFrom;
+	}
+	
+	_dbls.resize(write);
+	_ints.resize(write);
 	
+	contentHashInvalidate();
+	_nonEmptyCountInvalidate();
 	labelsTempReset();
 }
 
@@ -1465,6 +1635,8 @@ void Column::setRowCount(size_t rows)
 	_dbls.resize(rows);
 	_ints.resize(rows);
 	
+	contentHashInvalidate();
+	_nonEmptyCountInvalidate();
 	labelsTempReset();
 }
 
@@ -1485,13 +1657,12 @@ Labelset Column::labelsByDisplay(const std::string & display) const
 {
 	JASPTIMER_SCOPE(Column::labelByDisplay);
 
-	Labels found;
-	std::copy_if(_labels.begin(), _labels.end(), std::back_inserter(found), [&display](Label * label)
-	{
-		return label->label() == display;
-	});
+	if(!_labelsIndexed)
+		_labelsIndexBuild();
+	
+	auto found = _labelsByDisplayIndex.find(display);
 	
-	return Labelset(found.begin(), found.end());
+	return found == _labelsByDisplayIndex.end() ? Labelset() : found->second;
 }
 
 Label * Column::labelByValue(const std::string & value) const
@@ -1504,63 +1675,76 @@ Labelset Column::labelsByValue(const std::string & value) const
 {
 	JASPTIMER_SCOPE(Column::labelByValue);
 
-	Labels found;
-	std::copy_if(_labels.begin(), _labels.end(), std::back_inserter(found), [&value](Label * label)
+	Labelset found;
+	
+	if(value == "") //Every double that is an empty value also shows as "", the index doesn't know about emptyvalues so we look for those the slow way
 	{
-		return label->originalValueAsString() == value;
-	});
+		for(Label * label : _labels)
+			if(label->originalValueAsString() == value)
+				found.insert(label);
+		
+		return found;
+	}
+
+	if(!_labelsIndexed)
+		_labelsIndexBuild();
+	
+	auto indexed = _labelsByValueIndex.find(value);
 	
-	return Labelset(found.begin(), found.end());
+	if(indexed != _labelsByValueIndex.end())
+		for(Label * label : indexed->second)
+			if(label->originalValueAsString() == value) //A double that became an empty value is still under its number
+				found.insert(label);
+	
+	return found;
 }
 
 Label * Column::labelByValueAndDisplay(const std::string &value, const std::string &labelText) const
 {
 	JASPTIMER_SCOPE(Column::labelsByValueAndDisplay);
 
-	Labels found;
-	for(Label * label : _labels)
-		if(label->originalValueAsString() == value && label->label() == labelText)
+	for(Label * label : labelsByDisplay(labelText))
+		if(label->originalValueAsString() == value)
 			return label;
 	
-	
 	return nullptr;
 }
 
 bool Column::labelsMergeDuplicates()
 {
-	bool thereWasDuplication = false;
+	JASPTIMER_SCOPE(Column::labelsMergeDuplicates);
 	
-	for(size_t labelIndex=0; labelIndex < _labels.size(); labelIndex++)
+	std::map<std::pair<std::string, std::string>, Label*>	firstLabel;	///< value and display -> first label with those
+	std::unordered_map<int, int>							mergeInto;	///< intsId of a duplicate -> intsId of the label it is merged into
+	intset													duplicates;
+	
+	for(Label * label : _labels)
 	{
-		const std::string	value		= _labels[labelIndex]->originalValueAsString(),
-							labelText	= _labels[labelIndex]->label();
-		Labels found;
-		std::copy_if(_labels.begin(), _labels.end(), std::back_inserter(found), [&value, &labelText](Label * label)
-		{
-			return label->originalValueAsString() == value && label->label() == labelText;
-		});
+		Label *& first = firstLabel[{label->originalValueAsString(), label->label()}];
 		
-		if(found.size() > 1)
+		if(!first)
+			first = label; //First one wins
+		else
 		{
-			thereWasDuplication = true;
-		
-			//First one wins
-			for(size_t f=1; f<found.size(); f++)
-				for(int & anInt : _ints)
-					if(anInt == found[f]->intsId())
-						anInt = found[0]->intsId();
-		
-			found.erase(found.begin());
-			intset ids;
-			
-			for(Label * label : found)
-				ids.insert(label->intsId());
-			
-			labelsRemoveByIntsId(ids);
+			mergeInto[label->intsId()] = first->intsId();
+			duplicates.insert(label->intsId());
 		}
 	}
 	
-	return thereWasDuplication;
+	if(duplicates.empty())
+		return false;
+	
+	for(int & anInt : _ints)
+	{
+		auto merged = mergeInto.find(anInt);
+		
+		if(merged != mergeInto.end())
+			anInt = merged->second;
+	}
+	
+	labelsRemoveByIntsId(duplicates);
+	
+	return true;
 }
 
 bool Column::labelsRemoveOrphans()
@@ -1767,6 +1951,9 @@ void Column::resetFilter()
 void Column::incRevision(bool labelsTempCanBeMaintained)
 {
 	assert(_id != -1);
+	
+	contentHashInvalidate(); //Anything could have changed, DatabaseInterface::columnIncRevision also clears it from the db
+	_nonEmptyCountInvalidate();
 
 	if(!_data->writeBatchedToDB())
 	{
@@ -1792,9 +1979,78 @@ bool Column::checkForUpdates()
 	return true;
 }
 
-bool Column::isColumnDifferentFromStringValues(const std::string & title, const stringvec & strVals, const stringvec & strLabs, const stringset & strEmptyVals) const 
+bool Column::isColumnDifferentFromContentHash(const std::string & title, uint64_t contentHash, const stringset & strEmptyVals)
+{
+	return !(title == _title && strEmptyVals == emptyValues()->emptyStrings() && contentHash == this->contentHash());
+}
+
+uint64_t Column::contentHash()
+{
+	if(!_contentHashUpToDate())
+	{
+		JASPTIMER_SCOPE(Column::contentHash recalculate);
+		
+		uint64_t hash = 0;
+		
+		for(size_t row=0; row<rowCount(); row++)
+			hash ^= _contentHashRow(row);
+		
+		_contentHashSet(hash);
+	}
+	
+	return _contentHash;
+}
+
+size_t Column::nonEmptyCount()
+{
+	if(!_nonEmptyCountUpToDate())
+	{
+		JASPTIMER_SCOPE(Column::nonEmptyCount recount);
+		
+		_nonEmptyCount = 0;
+		
+		for(size_t row=0; row<_ints.size(); row++)
+			if(_rowHasValue(row))
+				_nonEmptyCount++;
+		
+		_nonEmptyCountEmptyValues	= _emptyValues->generation();
+		_nonEmptyCountValid			= true;
+	}
+	
+	return _nonEmptyCount;
+}
+
+bool Column::_rowHasValue(size_t row) const
+{
+	const int intsId = _ints[row];
+	
+	if(intsId != Label::DOUBLE_LABEL_VALUE && intsId != EmptyValues::missingValueInteger)
+	{
+		Label * label = labelByIntsId(intsId);
+		
+		if(label && !label->isEmptyValue())
+			return true;
+	}
+	
+	return !std::isnan(_dbls[row]) && !isEmptyValue(_dbls[row]);
+}
+
+uint64_t Column::_contentHashRow(size_t row) const
+{
+	return ColumnUtils::contentHashRow(row, getValue(row), getLabel(row));
+}
+
+void Column::_contentHashSet(uint64_t hash)
+{
+	_contentHash			= hash;
+	_contentHashEmptyValues	= _emptyValues->generation();
+	_contentHashValid		= true;
+}
+
+void Column::contentHashPersist()
 {
-	return !(title == _title && strEmptyVals == emptyValues()->emptyStrings() && strVals == valuesAsStrings() && strLabs == labelsAsStrings());
+	if(_contentHashUpToDate() && _id != -1 && !_data->writeBatchedToDB())
+		db().columnSetContentHash(_id, _contentHash);
 }
 
 void Column::upgradeSetDoubleLabelsInInts()
@@ -1927,6 +2183,8 @@ void Column::deserializeLabelsForCopy(const Json::Value & labels)
 	beginBatchedLabelsDB();
 	_labelByIntsIdMap.clear();
 	_labels.clear();
+	_labelsIndexDrop();
+	_labelsFreeIntsIdFrom = 0;
 
 	if (labels.isArray())
 		for (const Json::Value& labelJson : labels)
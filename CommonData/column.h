@@ -6,11 +6,15 @@
 #include "columntype.h"
 #include "utils.h"
 #include <list>
+#include <unordered_map>
 #include "emptyvalues.h"
+#include "columnutils.h"
 
 class DataSet;
 class Analysis;
 
+typedef std::vector<std::pair<size_t, size_t>> rowRanges; ///< first row and number of rows, sorted and not overlapping
+
 /// A column of data
 /// 
 /// It can have 3 columnTypes, scalar, ordinal or nominal (nominalText is a relict of the past).
@@ -84,7 +88,11 @@ public:
 			void					incRevision(bool labelsTempCanBeMaintained = true);
 			bool					checkForUpdates();
 
-			bool					isColumnDifferentFromStringValues(const std::string & title, const stringvec & strVals, const stringvec & strLabs, const stringset & strEmptyVals) const;
+			bool					isColumnDifferentFromContentHash( const std::string & title, uint64_t contentHash, const stringset & strEmptyVals);
+			size_t					nonEmptyCount();	///< Rows with a value that isn't empty, kept up to date by setValue and otherwise counted again when it is needed
+			uint64_t				contentHash();		///< Hash over value and label of each row, the same as ColumnUtils::contentHash(valuesAsStrings(), labelsAsStrings()) but kept up to date by setValue and otherwise calculated again when it is needed
+			void					contentHashPersist();	///< Stores the hash in the Columns table, if it is known, so the next dbLoad doesn't need to calculate it. Done at the end of a batch and during syncing
+			void					contentHashInvalidate()	{ _contentHashValid = false; }
 
 			columnType				type()					const	{ return _type;				}
 			int						id()					const	{ return _id;				}
@@ -154,14 +162,16 @@ public:
 			void					labelDisplayChanged(Label * label);
 			
 			bool					setStringValue(				size_t row, const std::string & value, const std::string & label = "", bool writeToDB = true); ///< Does two things, if label=="" it will handle user input, as value or label depending on columnType. Otherwise it will simply try to use userEntered as a value. But this will trigger the setting of type
-			bool					setValue(					size_t row, const std::string & value, const std::string & label,	bool writeToDB = true);
+			bool					setValue(					size_t row, const std::string & value, const std::string & label,	bool writeToDB = true, ColumnUtils::ValuesSniffed * sniffed = nullptr); ///< If sniffed is given the value is counted in it as well, so setValues can use the same parse to suggest a type
 			bool					setValue(					size_t row, int					value,								bool writeToDB = true);
 			bool					setValue(					size_t row, double				value,								bool writeToDB = true);
 			bool					setValue(					size_t row, int					valueInt, double valueDbl,			bool writeToDB = true);
 			columnType				setValues(			const stringvec &	values, const stringvec &	labels, int thresholdScale, bool * changedSomething = nullptr); ///< Returns what would be the most sensible columntype
 			bool					setDescriptions(	strstrmap labelToDescriptionMap); ///<Returns any changes
 			void					rowInsertEmptyVal(size_t row);
+			void					rowsInsertEmptyVal(size_t row, size_t count);
 			void					rowDelete(size_t row);
+			void					rowsDelete(const rowRanges & ranges);		///< Removes all ranges in a single pass over the rows after the first one
 			void					setRowCount(size_t row);
 
 			Labels				&	labels()																						{ return _labels; }
@@ -186,6 +196,8 @@ public:
 
 			intset					getUniqueLabelValues() const;
 			
+			void					labelsOrderFlush();		///< Writes the order of the labels that changed it since the last flush and increments the revision, DataSet::labelsOrderChanged decides when
+			bool					labelsOrderFlushPending()	const	{ return _labelsOrderFlushPending; }
 			void					beginBatchedLabelsDB();
 			void					endBatchedLabelsDB(bool wasWritingBatch = true);
 			bool					batchedLabelDepth()	{ return _batchedLabelDepth; }
@@ -231,13 +243,25 @@ public:
 
 protected:
 			void					_checkForDependencyLoop(stringset foundNames, std::list<std::string> loopList);
-			void					_dbUpdateLabelOrder(bool noIncRevisionWhenBatchedPlease = false);		///< Sets the order of the _labels to label.order and in DB
+			void					_dbUpdateLabelOrder(bool noIncRevisionWhenBatchedPlease = false);		///< Sets the order of the _labels to label.order, the DB and revision follow at labelsOrderFlush
 			void					_sortLabelsByOrder();		///< Sorts the labels by label.order
 			std::string				_getLabelDisplayStringByValue(int key, bool ignoreEmptyValue = false) const;
 			columnTypeChangeResult	_changeColumnToNominalOrOrdinal(enum columnType newColumnType);
 			columnTypeChangeResult	_changeColumnToScale();
 			void					_convertVectorIntToDouble(intvec & intValues, doublevec & doubleValues);
 			void					_resetLabelValueMap();
+			void					_labelsIndexBuild()								const;
+			void					_labelsIndexAdd(	Label * label)				const;
+			void					_labelsIndexRemove(	Label * label);
+			void					_labelsIndexDrop();
+	static	std::string				_labelsIndexValueKey(const Label * label);		///< originalValueAsString but without asking the emptyvalues, so it doesn't change when those do
+			int						_labelsFreeIntsId();							///< Lowest intsId not used by any label
+			uint64_t				_contentHashRow(size_t row) const;
+			void					_contentHashSet(uint64_t hash);
+			bool					_rowHasValue(size_t row)	const;
+			bool					_contentHashUpToDate()		const	{ return _contentHashValid && _contentHashEmptyValues == _emptyValues->generation(); }	///< Empty values hash as an empty label, so the hash is only good for the empty values it was made with
+			bool					_nonEmptyCountUpToDate()	const	{ return _nonEmptyCountValid && _nonEmptyCountEmptyValues == _emptyValues->generation(); }
+			void					_nonEmptyCountInvalidate()			{ _nonEmptyCountValid = false; }
 			doublevec				valuesNumericOrdered();			
 
 private:
@@ -268,7 +292,20 @@ private:
 			intvec					_ints;
 			stringset				_dependsOnColumns;
 			std::map<int, Label*>	_labelByIntsIdMap;
+			int						_labelsFreeIntsIdFrom	= 0;	///< All intsIds below this one are in use
+	mutable	std::unordered_map<std::string, Labelset>
+									_labelsByValueIndex,		///< See _labelsIndexValueKey, built on the first lookup and kept up to date by labelsAdd and labelsRemoveByIntsId
+									_labelsByDisplayIndex;
+	mutable	bool					_labelsIndexed			= false;
+			std::set<const Label*>	_labelsOrderDirty;				///< Labels whose order changed since the last labelsOrderFlush
+			bool					_labelsOrderFlushPending	= false;
 			int						_batchedLabelDepth	= 0;
+			uint64_t				_contentHash				= 0;
+			size_t					_contentHashEmptyValues		= 0;	///< EmptyValues::generation() it was made with
+			bool					_contentHashValid			= false;
+			size_t					_nonEmptyCount				= 0,
+									_nonEmptyCountEmptyValues	= 0;	///< EmptyValues::generation() it was counted with
+			bool					_nonEmptyCountValid			= false;
 	static	bool					_autoSortByValuesByDefault;
 			
 			
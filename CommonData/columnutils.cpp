@@ -5,9 +5,11 @@
 #ifndef IGNORE_BOOST
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/lexical_cast/try_lexical_convert.hpp>
 #endif
-#include <codecvt>
-#include <regex>
+#include <charconv>
+#include <array>
+#include <cstring>
 #include "emptyvalues.h"
 #include "timers.h"
 
@@ -16,28 +18,147 @@ using namespace std;
 using namespace boost::posix_time;
 using namespace boost;
 
-bool ColumnUtils::getIntValue(const string &value, int &intValue)
+///Accepts the same as boost::lexical_cast<int> (an optional sign followed by digits and nothing else) but never throws
+static bool parseInt(std::string_view value, int & intValue)
 {
-	try
+	const char	*	begin	= value.data(),
+				*	end		= begin + value.size();
+	
+	if(begin != end && *begin == '+' && ++begin != end && *begin == '-') //from_chars doesn't want a plus but shouldn't get to see "+-1" as "-1" either
+		return false;
+	
+	int parsed;
+	auto [ptr, ec] = std::from_chars(begin, end, parsed);
+	
+	if(ec != std::errc() || ptr != end || begin == end)
+		return false;
+	
+	intValue = parsed;
+	return true;
+}
+
+///Accepts what boost::lexical_cast<double> does, including inf and nan, but never throws
+static bool parseDouble(std::string_view value, double & doubleValue)
+{
+#ifdef __cpp_lib_to_chars
+	const char	*	begin	= value.data(),
+				*	end		= begin + value.size();
+	
+	if(begin != end && *begin == '+' && ++begin != end && *begin == '-')
+		return false;
+	
+	double parsed;
+	auto [ptr, ec] = std::from_chars(begin, end, parsed);
+	
+	if(ec != std::errc() || ptr != end || begin == end)
+		return false;
+	
+	doubleValue = parsed;
+	return true;
+#else
+	//Not every standard library has a floating point from_chars yet, this is slower but doesn't throw either
+	return boost::conversion::try_lexical_convert(value, doubleValue);
+#endif
+}
+
+///Does what deEuropeaniseForImport does (drop the dots and make the first comma a dot) into a buffer on the stack instead of a new string
+static bool parseEuropeanDouble(std::string_view value, double & doubleValue)
+{
+	char	buffer[64];
+	size_t	len			= 0;
+	bool	hadComma	= false;
+	
+	if(value.size() > sizeof(buffer))
+		return parseDouble(ColumnUtils::deEuropeaniseForImport(std::string(value)), doubleValue);
+	
+	for(const char & k : value)
+		if		(k == '.')					continue;
+		else if	(k == ',' && !hadComma)		{ buffer[len++] = '.';	hadComma = true; }
+		else								  buffer[len++] = k;
+	
+	return parseDouble(std::string_view(buffer, len), doubleValue);
+}
+
+///Anything that could start a number or inf/nan, lets us skip the parsers for most text without looking further than the first byte
+static bool couldBeNumeric(unsigned char first)
+{
+	static const auto table = []()
 	{
-		intValue = boost::lexical_cast<int>(value);
-		return true;
+		std::array<bool, 256> numeric{};
+		
+		for(unsigned char c : std::string_view("0123456789+-.,iInN\xE2")) //0xE2 is where the utf-8 for infinity starts
+			numeric[c] = true;
+		
+		return numeric;
+	}();
+	
+	return table[first];
+}
+
+ColumnUtils::valueKind ColumnUtils::sniffValue(std::string_view value, int & intValue, double & doubleValue)
+{
+	if(value.empty())
+		return valueKind::empty;
+	
+	if(!couldBeNumeric(value[0]))
+		return valueKind::text;
+	
+	if(parseInt(value, intValue))
+	{
+		doubleValue = intValue;
+		return valueKind::integer;
+	}
+	
+	if(value == "∞" || value == "-∞")
+	{
+		doubleValue = std::numeric_limits<double>::infinity() * (value == "-∞" ? -1 : 1);
+		return valueKind::decimal;
 	}
-	catch (...)	{}
+	
+	if(value.find(',') == std::string_view::npos)
+		return parseDouble(value, doubleValue)			? valueKind::decimal		: valueKind::text;
+	else
+		return parseEuropeanDouble(value, doubleValue)	? valueKind::commaDecimal	: valueKind::text;
+}
 
-	return false;
+ColumnUtils::ValuesSniffed ColumnUtils::sniffValues(const stringvec & values, const stringvec & labels)
+{
+	JASPTIMER_SCOPE(ColumnUtils::sniffValues);
+	
+	ValuesSniffed	sniffed;
+	int				intValue;
+	double			doubleValue;
+	
+	for(size_t i=0; i<values.size(); i++)
+	{
+		const valueKind kind = sniffValue(values[i], intValue, doubleValue);
+		sniffed.add(kind, intValue, i < labels.size() && labels[i] != "");
+	}
+	
+	return sniffed;
 }
 
-bool ColumnUtils::isIntValue(const string &value)
+void ColumnUtils::ValuesSniffed::add(valueKind kind, int intValue, bool hasLabel)
 {
-	try
+	switch(kind)
 	{
-		boost::lexical_cast<int>(value);
-		return true;
+	case valueKind::empty:			(hasLabel ? texts : empty)++;					break;
+	case valueKind::integer:		integers++;		uniqueInts.insert(intValue);	break;
+	case valueKind::decimal:		decimals++;										break;
+	case valueKind::commaDecimal:	commaDecimals++;								break;
+	case valueKind::text:			texts++;										break;
 	}
-	catch (...)	{}
+}
 
-	return false;
+bool ColumnUtils::getIntValue(const string &value, int &intValue)
+{
+	return parseInt(value, intValue);
+}
+
+bool ColumnUtils::isIntValue(const string &value)
+{
+	int dummy;
+	return parseInt(value, dummy);
 }
 
 bool ColumnUtils::getIntValue(const double &value, int &intValue)
@@ -66,20 +187,19 @@ bool ColumnUtils::getDoubleValue(const string &value, double &doubleValue)
 {
 	doubleValue = EmptyValues::missingValueDouble;
 	
-	if(value == "∞" || value == "-∞")
-	{
-		doubleValue = std::numeric_limits<double>::infinity() * (value == "-∞" ? -1 : 1);
-		return true;
-	}
+	int dummy;
 	
-	try
+	switch(sniffValue(value, dummy, doubleValue))
 	{
-		doubleValue = boost::lexical_cast<double>(deEuropeaniseForImport(value));
+	case valueKind::integer:
+	case valueKind::decimal:
+	case valueKind::commaDecimal:
 		return true;
+		
+	default:
+		doubleValue = EmptyValues::missingValueDouble;
+		return false;
 	}
-	catch (...) {}
-
-	return false;
 }
 
 doubleset ColumnUtils::getDoubleValues(const stringset & values, bool stripNAN)
@@ -97,8 +217,8 @@ doubleset ColumnUtils::getDoubleValues(const stringset & values, bool stripNAN)
 
 bool ColumnUtils::isDoubleValue(const string &value)
 {
-	static double last;
-	return getDoubleValue(value, last);
+	double dummy;
+	return getDoubleValue(value, dummy);
 }
 
 
@@ -230,41 +350,161 @@ std::string ColumnUtils::doubleToString(double dbl, int precision)
 }
 
 
-// hex should be 4 hexadecimals characters
-std::string ColumnUtils::_convertEscapedUnicodeToUTF8(std::string hex)
+static int hexDigit(char c)
 {
-	JASPTIMER_SCOPE(ColumnUtils::_convertEscapedUnicodeToUTF8);
-			
-	std::istringstream iss(hex);
+	if(c >= '0' && c <= '9')	return c - '0';
+	if(c >= 'a' && c <= 'f')	return c - 'a' + 10;
+	if(c >= 'A' && c <= 'F')	return c - 'A' + 10;
+	return -1;
+}
 
-	uint32_t bytes;
-#ifdef _WIN32
-	static std::wstring_convert<std::codecvt_utf8<unsigned int>, unsigned int> conv;
-#else
-	static std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv;
-#endif
-	// Read the 4 hexadecimals as bytes, and convert these bytes into UTF8.
-	if (iss >> std::hex >> bytes) hex = conv.to_bytes(char32_t(bytes));
+/// Reads the codepoint from "<U+FFFF>" at pos, or returns -1 when there is no such escape there
+static int32_t readEscapedCodepoint(const char * pos, const char * end)
+{
+	if(end - pos < 8 || pos[0] != '<' || pos[1] != 'U' || pos[2] != '+' || pos[7] != '>')
+		return -1;
+
+	int32_t codepoint = 0;
+
+	for(int i=3; i<7; i++)
+	{
+		int digit = hexDigit(pos[i]);
+
+		if(digit < 0)
+			return -1;
+
+		codepoint = (codepoint << 4) | digit;
+	}
+
+	return codepoint;
+}
+
+static char * writeUTF8(char32_t codepoint, char * out)
+{
+	if(codepoint < 0x80)
+		*out++ = char(codepoint);
+	else if(codepoint < 0x800)
+	{
+		*out++ = char(0xC0 |  (codepoint >> 6));
+		*out++ = char(0x80 |  (codepoint		& 0x3F));
+	}
+	else if(codepoint < 0x10000)
+	{
+		*out++ = char(0xE0 |  (codepoint >> 12));
+		*out++ = char(0x80 | ((codepoint >> 6)	& 0x3F));
+		*out++ = char(0x80 |  (codepoint		& 0x3F));
+	}
+	else
+	{
+		*out++ = char(0xF0 |  (codepoint >> 18));
+		*out++ = char(0x80 | ((codepoint >> 12)	& 0x3F));
+		*out++ = char(0x80 | ((codepoint >> 6)	& 0x3F));
+		*out++ = char(0x80 |  (codepoint		& 0x3F));
+	}
 
-	return hex;
+	return out;
 }
 
 // Replace all <U+FFFF> in str by their UT8 characters.
 void ColumnUtils::convertEscapedUnicodeToUTF8(std::string& inputStr)
+{
+	inputStr.resize(convertEscapedUnicodeToUTF8(inputStr.data(), inputStr.size()));
+}
+
+/// A single pass that never needs more room than it started with: an escape is 8 bytes and what replaces it at most 4, even for a surrogate pair (16 bytes).
+/// So the output is written over the input, behind where we are reading. Until the first escape nothing is written at all.
+/// Surrogate pairs (as R writes characters outside the BMP on windows) are combined into a single character, a lone surrogate is not valid UTF8 and stays as it is.
+size_t ColumnUtils::convertEscapedUnicodeToUTF8(char * str, size_t size)
 {
 	JASPTIMER_SCOPE(ColumnUtils::convertEscapedUnicodeToUTF8);
-	
-	static const std::regex unicodeExpression ("<U\\+([0-9a-fA-F]{4})>");
 
-	std::smatch match;
-	auto begin	= inputStr.cbegin();
+	const char	*	read	= str,
+				*	end		= str + size;
+	char		*	write	= nullptr;
 
-	while (std::regex_search(begin, inputStr.cend(), match, unicodeExpression))
+	while(read < end)
 	{
-		std::string utf8 = _convertEscapedUnicodeToUTF8(match[1].str()); // match 1 is the first group of the regexp: that is the 4 hexadecimals.
-		auto pos = match.position(0); // position of the whole sequence in str.
-		inputStr.replace(begin + pos, begin + pos + 8, utf8); // 8 is the number of characters of '<U+FFFF>'
-		// str iterators cannot be trusted after replace. They must be recalculated from str.
-		begin = inputStr.begin() + pos;
+		const char * bracket = static_cast<const char *>(memchr(read, '<', end - read));
+
+		if(!bracket)
+			bracket = end;
+
+		if(write)
+		{
+			memmove(write, read, bracket - read);
+			write += bracket - read;
+		}
+
+		read = bracket;
+
+		if(read == end)
+			break;
+
+		int32_t		codepoint	= readEscapedCodepoint(read, end);
+		ptrdiff_t	consumed	= 8;
+
+		if(codepoint >= 0xD800 && codepoint <= 0xDBFF)
+		{
+			int32_t low = readEscapedCodepoint(read + 8, end);
+
+			if(low >= 0xDC00 && low <= 0xDFFF)
+			{
+				codepoint	= 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+				consumed	= 16;
+			}
+			else
+				codepoint = -1;
+		}
+		else if(codepoint >= 0xDC00 && codepoint <= 0xDFFF)
+			codepoint = -1;
+
+		if(codepoint < 0)
+		{
+			if(write)
+				*write++ = '<';
+			read++;
+			continue;
+		}
+
+		if(!write)
+			write = str + (read - str);
+
+		write	=  writeUTF8(char32_t(codepoint), write);
+		read	+= consumed;
 	}
+
+	return write ? size_t(write - str) : size;
+}
+
+uint64_t ColumnUtils::contentHashRow(size_t row, const std::string & value, const std::string & label)
+{
+	//FNV-1a over value and label, with a byte that cannot occur in utf-8 between them so that ("ab", "c") and ("a", "bc") differ
+	constexpr uint64_t fnvPrime = 1099511628211ULL;
+	
+	uint64_t hash = 14695981039346656037ULL;
+	
+	for(unsigned char c : value)	{ hash ^= c;	hash *= fnvPrime; }
+									  hash ^= 0xFF;	hash *= fnvPrime;
+	for(unsigned char c : label)	{ hash ^= c;	hash *= fnvPrime; }
+	
+	//Mix in the row (splitmix64 finalizer) so that xor'ing the rows together still depends on their order
+	hash ^= (row + 1) * 0x9E3779B97F4A7C15ULL;
+	hash  = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	hash  = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+	
+	return hash ^ (hash >> 31);
+}
+
+uint64_t ColumnUtils::contentHash(const stringvec & values, const stringvec & labels)
+{
+	JASPTIMER_SCOPE(ColumnUtils::contentHash);
+	
+	static const std::string noLabel;
+	
+	uint64_t hash = 0;
+	
+	for(size_t row=0; row<values.size(); row++)
+		hash ^= contentHashRow(row, values[row], row < labels.size() ? labels[row] : noLabel);
+	
+	return hash;
 }
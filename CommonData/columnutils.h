@@ -2,6 +2,7 @@
 #define COLUMNUTILS_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 #include <map>
@@ -12,6 +13,27 @@ class ColumnUtils
 public:
 	friend class PreferencesModel;
 
+	enum class valueKind { empty, integer, decimal, commaDecimal, text };	///< commaDecimal is a number that only parsed after deEuropeaniseForImport
+
+	///What sniffValues found in a batch of values, enough to suggest a columnType
+	struct ValuesSniffed
+	{
+		size_t	empty			= 0,
+				integers		= 0,
+				decimals		= 0,
+				commaDecimals	= 0,
+				texts			= 0;
+		intset	uniqueInts;
+
+		void	add(valueKind kind, int intValue, bool hasLabel);		///< Counts a single value as sniffValue classified it, an empty value with a non-empty label counts as text
+
+		bool	onlyInts()		const { return integers > 0 && decimals + commaDecimals + texts == 0;	}
+		bool	onlyDoubles()	const { return texts == 0;												}
+	};
+
+	static valueKind		sniffValue(		std::string_view	  value,	int & intValue, double & doubleValue);	///< Never throws or allocates, doubleValue is also set for integers
+	static ValuesSniffed	sniffValues(	const stringvec		& values,	const stringvec & labels = {});			///< An empty value with a non-empty label counts as text
+
 	static bool			getIntValue(	const std::string	& value, int	& intValue);
 	static bool			getIntValue(	const double		& value, int	& intValue);
 	static bool			getDoubleValue(	const std::string	& value, double	& doubleValue);
@@ -21,6 +43,7 @@ public:
 	static bool			isDoubleValue(	const std::string	& value);
 
 	static void			convertEscapedUnicodeToUTF8(			std::string & inputStr);
+	static size_t		convertEscapedUnicodeToUTF8(			char * str, size_t size);	///< Converts in place and returns the new size, which is never larger
 	static std::string	deEuropeaniseForImport(					std::string   value);		//Convert a string to a double with a dot for a separator
 
 	static std::string	doubleToString(			double dbl, int precision = 10);
@@ -28,8 +51,9 @@ public:
 	
 	static bool			convertVecToInt(	const stringvec & values, intvec	& intValues, intset & uniqueValues);
 	static bool			convertVecToDouble(	const stringvec & values, doublevec	& doubleValues);
-private:
-	static std::string _convertEscapedUnicodeToUTF8(	std::string hex);
+	
+	static uint64_t		contentHashRow(	size_t row, const std::string & value, const std::string & label);	///< Hash of a single row of a column, these are xor'ed together in contentHash so that a single row can be swapped out cheaply
+	static uint64_t		contentHash(	const stringvec & values, const stringvec & labels);				///< labels may be empty, otherwise it should be as long as values
 };
 
 #endif // COLUMNUTILS_H
@@ -5,11 +5,16 @@
 #include "timers.h"
 #include "utils.h"
 #include "log.h"
+#include <cstring>
+#include <algorithm>
 
 DatabaseInterface * DatabaseInterface::_singleton = nullptr;
 
 //#define SIR_LOG_A_LOT
 
+static const size_t	maxCachedStatements	= 128,
+					maxRowsPerInsert	= 512;
+
 const std::string DatabaseInterface::_dbConstructionSql =
 // The actual definition can be found in "internalDbDefinition.sql"!
 #include "internalDbDefinition.h"
@@ -44,6 +49,16 @@ void DatabaseInterface::upgradeDBFromVersion(Version originalVersion)
 		runStatements("ALTER TABLE DataSets  ADD 	COLUMN dataFileTimestamp	INT;");
 	}
 
+	if(!tableHasColumn("Columns", "contentHash"))
+	{
+		runStatements("ALTER TABLE Columns  ADD 	COLUMN contentHash			INT NULL;");
+	}
+
+	if(!tableHasColumn("DataSets", "rowsDeltaJson"))
+	{
+		runStatements("ALTER TABLE DataSets ADD 	COLUMN rowsDeltaJson		TEXT NULL;");
+	}
+
 	transactionWriteEnd();
 }
 
@@ -484,6 +499,11 @@ int DatabaseInterface::columnIndexForId(int columnId)
 	});
 }
 
+void DatabaseInterface::dataSetBatchedValuesUpdate(DataSet * data, std::function<void(float)> progressCallback)
+{
+	dataSetBatchedValuesUpdate(data, data->columns(), progressCallback);
+}
+
 void DatabaseInterface::dataSetBatchedValuesUpdate(DataSet * data, Columns columns, std::function<void(float)> progressCallback)
 {
 	JASPTIMER_SCOPE(DatabaseInterface::dataSetBatchedValuesUpdate);
@@ -494,6 +514,7 @@ void DatabaseInterface::dataSetBatchedValuesUpdate(DataSet * data, Columns colum
 	// But maybe we should update instead, maybe it speeds up the application?
 	//As this data isnt synced anyway this shouldnt be a problem because it'd be invalidated after a single edit anyway
 	runStatements("DELETE FROM " + dataSetName(data->id()));
+	runStatements("UPDATE Columns SET contentHash=NULL WHERE dataSet=" + std::to_string(data->id()) + ";"); //The values in memory might have changed without Column::incRevision being called
 
 	std::stringstream statement;
 	
@@ -507,54 +528,74 @@ void DatabaseInterface::dataSetBatchedValuesUpdate(DataSet * data, Columns colum
 	}
 
 	//And the filtername and rowNumber
-	statement << filterName(data->filter()->id()) << ", " << "rowNumber) VALUES (";
+	statement << filterName(data->filter()->id()) << ", " << "rowNumber) VALUES ";
 
+	std::string rowParams = "(";
 	for(size_t i=0; i<columns.size(); i++)
-		statement << "?, ?, ";
-	statement << "?, ?);"; //filter and rowNumber
+		rowParams += "?, ?, ";
+	rowParams += "?, ?)"; //filter and rowNumber
 
-	//We put a size_t outside the bindParamStore lambda to set it without having to change the signature
-	size_t rowOutside=0;
-	bindParametersType bindParamStore = [&](sqlite3_stmt * stmt)
+	//Many rows per INSERT means sqlite has to step through a statement much less often
+	auto insertStatement = [&](size_t rows)
 	{
-		size_t i=1;
-		for(Column * col : columns)
-		{
-			_doubleTroubleBinder(	stmt,	i++, col->dbls()[rowOutside]);
-			sqlite3_bind_int(		stmt,	i++, col->ints()[rowOutside]);
-		}
+		std::string insert = statement.str();
+
+		for(size_t r=0; r<rows; r++)
+			insert += (r == 0 ? "" : ", ") + rowParams;
 
-		sqlite3_bind_int(stmt,	i++, data->filter()->filtered()[rowOutside]);
-		sqlite3_bind_int(stmt,	i++, rowOutside+1);
+		return insert + ";";
 	};
 
-	const float rowsInverse		= 1.0 / float(data->rowCount());
-	const int	updateInterval	= std::max(1, data->rowCount() / 100);
+	const size_t	rowCount		= data->rowCount(),
+					rowsPerInsert	= _rowsPerInsert(columns.size() * 2 + 2),
+					fullInserts		= rowCount / rowsPerInsert;
+	const float		rowsInverse		= 1.0 / float(std::max<size_t>(1, rowCount));
 
-	_runStatementsRepeatedly(
-		statement.str(),
-		[&](bindParametersType ** bindParameters, size_t row)
+	//We put the rows outside the bindParamStore lambda to set them without having to change the signature
+	size_t firstRowOutside = 0, rowsOutside = 0;
+	bindParametersType bindParamStore = [&](sqlite3_stmt * stmt)
+	{
+		size_t i=1;
+		for(size_t row = firstRowOutside; row < firstRowOutside + rowsOutside; row++)
 		{
-			if(row >= data->rowCount())
+			for(Column * col : columns)
 			{
-				progressCallback(1);
-				return false;
+				_doubleTroubleBinder(	stmt,	i++, col->dbls()[row]);
+				sqlite3_bind_int(		stmt,	i++, col->ints()[row]);
 			}
 
-			rowOutside = row;
+			sqlite3_bind_int(stmt,	i++, data->filter()->filtered()[row]);
+			sqlite3_bind_int(stmt,	i++, row+1);
+		}
+	};
+
+	auto insertRows = [&](size_t fromRow, size_t inserts, size_t rowsPerStatement)
+	{
+		if(inserts == 0 || rowsPerStatement == 0)
+			return;
 
-			static int prevUpdate = 0;
+		rowsOutside = rowsPerStatement;
 
-			if(prevUpdate + updateInterval <= rowOutside)
+		_runStatementsRepeatedly(
+			insertStatement(rowsPerStatement),
+			[&](bindParametersType ** bindParameters, size_t insert) //An INSERT steps once, so this counts the inserts
 			{
-				progressCallback(float(rowOutside) * rowsInverse);
-				prevUpdate = rowOutside;
-			}
+				if(insert >= inserts)
+					return false;
 
-			(*bindParameters) = &bindParamStore;
+				firstRowOutside = fromRow + insert * rowsPerStatement;
+				progressCallback(float(firstRowOutside) * rowsInverse);
 
-			return true;
-		});
+				(*bindParameters) = &bindParamStore;
+
+				return true;
+			});
+	};
+
+	insertRows(0,							fullInserts,	rowsPerInsert);
+	insertRows(fullInserts * rowsPerInsert,	1,				rowCount - fullInserts * rowsPerInsert); //And whatever is left
+
+	progressCallback(1);
 
 	transactionWriteEnd();
 }
@@ -828,6 +869,30 @@ int DatabaseInterface::dataSetGetFilter(int dataSetId)
 	return runStatementsId("SELECT id FROM Filters WHERE dataSet=? LIMIT 1;", [&](sqlite3_stmt *stmt) { sqlite3_bind_int(stmt, 1, dataSetId); });
 }
 
+void DatabaseInterface::dataSetSetRowsDelta(int dataSetId, const std::string & rowsDeltaJson)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::dataSetSetRowsDelta);
+	runStatements("UPDATE DataSets SET rowsDeltaJson=? WHERE id=?;", [&](sqlite3_stmt *stmt)
+	{
+		sqlite3_bind_text(stmt, 1, rowsDeltaJson.c_str(), rowsDeltaJson.length(), SQLITE_TRANSIENT);
+		sqlite3_bind_int( stmt, 2, dataSetId);
+	});
+}
+
+std::string DatabaseInterface::dataSetGetRowsDelta(int dataSetId)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::dataSetGetRowsDelta);
+	std::string rowsDeltaJson;
+
+	runStatements("SELECT rowsDeltaJson FROM DataSets WHERE id=?;", [&](sqlite3_stmt *stmt) { sqlite3_bind_int(stmt, 1, dataSetId); },
+		[&](size_t, sqlite3_stmt *stmt)
+		{
+			rowsDeltaJson = _wrap_sqlite3_column_text(stmt, 0);
+		});
+
+	return rowsDeltaJson;
+}
+
 std::string DatabaseInterface::filterName(int filterIndex) const
 {
 	JASPTIMER_SCOPE(DatabaseInterface::filterName);
@@ -929,7 +994,7 @@ int DatabaseInterface::columnIncRevision(int columnId)
 		sqlite3_bind_int(stmt, 1, columnId);
 	};
 
-				runStatements(	"UPDATE Columns SET revision=revision+1	WHERE id=?;", prepare);
+				runStatements(	"UPDATE Columns SET revision=revision+1, contentHash=NULL	WHERE id=?;", prepare);
 	int rev =	runStatementsId("SELECT revision FROM Columns			WHERE id=?;", prepare);
 
 	transactionWriteEnd();
@@ -943,6 +1008,40 @@ int DatabaseInterface::columnGetRevision(int columnId)
 	return runStatementsId("SELECT revision FROM Columns WHERE id=?;", [&](sqlite3_stmt *stmt) { sqlite3_bind_int(stmt, 1, columnId); });
 }
 
+void DatabaseInterface::dataSetClearContentHashes(int dataSetId)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::dataSetClearContentHashes);
+	runStatements("UPDATE Columns SET contentHash=NULL WHERE dataSet=?;", [&](sqlite3_stmt * stmt) { sqlite3_bind_int(stmt, 1, dataSetId); });
+}
+
+void DatabaseInterface::columnSetContentHash(int columnId, uint64_t contentHash)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::columnSetContentHash);
+	runStatements("UPDATE Columns SET contentHash=? WHERE id=?;", [&](sqlite3_stmt * stmt)
+	{
+		sqlite3_bind_int64(stmt,	1, sqlite3_int64(contentHash));
+		sqlite3_bind_int(stmt,		2, columnId);
+	});
+}
+
+bool DatabaseInterface::columnGetContentHash(int columnId, uint64_t & contentHash)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::columnGetContentHash);
+	
+	bool stored = false;
+	
+	runStatements("SELECT contentHash FROM Columns WHERE id=?;", [&](sqlite3_stmt *stmt) { sqlite3_bind_int(stmt, 1, columnId); },
+	[&](size_t row, sqlite3_stmt *stmt)
+	{
+		stored = sqlite3_column_type(stmt, 0) != SQLITE_NULL;
+		
+		if(stored)
+			contentHash = uint64_t(sqlite3_column_int64(stmt, 0));
+	});
+	
+	return stored;
+}
+
 
 void DatabaseInterface::columnSetName(int columnId, const std::string &name)
 {
@@ -1388,7 +1487,8 @@ void DatabaseInterface::_runStatements(const std::string & statements, bindParam
 	Log::log() << "Running statements: '" << statements << "'" << std::endl;
 #endif
 
-	sqlite3_stmt * dbStmt = nullptr;
+	preparedStatement	prepared(this);
+	sqlite3_stmt	*&	dbStmt = prepared.stmt;
 
 	const char	*	start	= statements.c_str(),
 				*	current	= start,
@@ -1400,7 +1500,7 @@ void DatabaseInterface::_runStatements(const std::string & statements, bindParam
 
 	do
 	{
-		ret	= sqlite3_prepare_v2(_db, current, total - (current - start), &dbStmt, &tail);
+		ret	= prepared.prepare(current, total - (current - start), &tail);
 		row = 0;
 
 		if(bindParameters)
@@ -1432,8 +1532,7 @@ void DatabaseInterface::_runStatements(const std::string & statements, bindParam
 			}
 			while((ret == SQLITE_BUSY || ret == SQLITE_ROW) && ret != SQLITE_DONE);
 
-			ret = sqlite3_finalize(dbStmt);
-			dbStmt = nullptr;
+			ret = prepared.finish();
 		}
 
 		remain	= total - (tail - start);
@@ -1465,7 +1564,8 @@ void DatabaseInterface::_runStatementsRepeatedly(const std::string & statements,
 	Log::log() << "Running statements repeatedly: '" << statements << "'" << std::endl;
 #endif
 
-	sqlite3_stmt * dbStmt = nullptr;
+	preparedStatement	prepared(this);
+	sqlite3_stmt	*&	dbStmt = prepared.stmt;
 
 	const char	*	start		= statements.c_str(),
 				*	current		= start,
@@ -1480,7 +1580,7 @@ void DatabaseInterface::_runStatementsRepeatedly(const std::string & statements,
 
 	do
 	{
-		ret	= sqlite3_prepare_v2(_db, current, total - (current - start), &dbStmt, &tail);
+		ret	= prepared.prepare(current, total - (current - start), &tail);
 
 		row = 0;
 
@@ -1527,9 +1627,7 @@ void DatabaseInterface::_runStatementsRepeatedly(const std::string & statements,
 			throw std::runtime_error(errorMsg);
 		}
 
-		ret = sqlite3_finalize(dbStmt);
-		dbStmt = nullptr;
-
+		ret = prepared.finish();
 
 		remain	= total - (tail - start);
 		//Log::log() << "Just ran `" + std::string(current, tail) + "` which returned " << ret << " and " << remain << " remaining." << std::endl;
@@ -1553,6 +1651,233 @@ void DatabaseInterface::_runStatementsRepeatedly(const std::string & statements,
 	}
 }
 
+///Statements without parameters are usually built with the ids in them and won't be seen again, so those are not kept.
+///Neither is a second copy of one that is in use already, by a query nested in the processRow of another or by the other thread.
+int DatabaseInterface::_prepareStatement(const char * sql, size_t length, sqlite3_stmt ** stmt, const char ** tail, cachedStatement *& cached)
+{
+	cached = nullptr;
+
+	if(!std::memchr(sql, '?', length))
+		return sqlite3_prepare_v2(_db, sql, length, stmt, tail);
+
+	const std::string			key(sql, length);
+	std::lock_guard<std::mutex>	lock(_statementCacheLock);
+	auto						found = _statementCache.find(key);
+
+	if(found != _statementCache.end())
+	{
+		if(found->second.inUse)
+			return sqlite3_prepare_v2(_db, sql, length, stmt, tail);
+
+		cached			= &found->second;
+		cached->inUse	= true;
+		*stmt			= cached->stmt;
+		*tail			= sql + cached->length;
+
+		sqlite3_reset(*stmt);
+		sqlite3_clear_bindings(*stmt);
+
+		return SQLITE_OK;
+	}
+
+	int ret = sqlite3_prepare_v2(_db, sql, length, stmt, tail);
+
+	if(ret != SQLITE_OK || !*stmt)
+		return ret;
+
+	if(_statementCache.size() >= maxCachedStatements) //Simpler than keeping track of which was used least recently, and the ones that matter are back after a single run
+	{
+		for(auto it = _statementCache.begin(); it != _statementCache.end();)
+		{
+			if(it->second.inUse)
+				it++;
+			else
+			{
+				sqlite3_finalize(it->second.stmt);
+				it = _statementCache.erase(it);
+			}
+		}
+	}
+
+	cached = &(_statementCache[key] = { *stmt, size_t(*tail - sql), true });
+
+	return ret;
+}
+
+int DatabaseInterface::_finishStatement(sqlite3_stmt * stmt, cachedStatement * cached)
+{
+	if(!cached)
+		return sqlite3_finalize(stmt);
+
+	int ret = sqlite3_reset(stmt);
+
+	std::lock_guard<std::mutex> lock(_statementCacheLock);
+	cached->inUse = false;
+
+	return ret;
+}
+
+int DatabaseInterface::preparedStatement::finish()
+{
+	if(!stmt)
+		return SQLITE_OK;
+
+	int ret = _db->_finishStatement(stmt, _cached);
+
+	stmt	= nullptr;
+	_cached	= nullptr;
+
+	return ret;
+}
+
+void DatabaseInterface::_clearStatementCache()
+{
+	std::lock_guard<std::mutex> lock(_statementCacheLock);
+
+	for(auto & sqlStatement : _statementCache)
+		sqlite3_finalize(sqlStatement.second.stmt);
+
+	_statementCache.clear();
+}
+
+size_t DatabaseInterface::_rowsPerInsert(size_t parametersPerRow) const
+{
+	const size_t maxParameters = std::max(1, sqlite3_limit(_db, SQLITE_LIMIT_VARIABLE_NUMBER, -1));
+
+	return std::clamp<size_t>(maxParameters / std::max<size_t>(1, parametersPerRow), 1, maxRowsPerInsert);
+}
+
+void DatabaseInterface::configureConnection()
+{
+	//WAL lets readers (the engines) go on while Desktop writes and the other way around, and with WAL NORMAL is still safe for a file we only keep for a session
+	runStatements("PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;");
+}
+
+void DatabaseInterface::checkpoint()
+{
+	JASPTIMER_SCOPE(DatabaseInterface::checkpoint);
+
+	if(!_db)
+		return;
+
+	int busy = 0;
+
+	runStatements("PRAGMA wal_checkpoint(TRUNCATE);", [](sqlite3_stmt *){}, [&](size_t, sqlite3_stmt * stmt) { busy = sqlite3_column_int(stmt, 0); });
+
+	if(busy)
+	{
+		std::string errorMsg = "DatabaseInterface::checkpoint could not finish because some other connection is still busy with the database.";
+		Log::log() << errorMsg << std::endl;
+		throw std::runtime_error(errorMsg);
+	}
+}
+
+///Copies every page in one go, an engine might hold a lock for a moment so that is waited out for a while but not forever
+static void backupDatabase(sqlite3 * from, sqlite3 * to, const std::string & what)
+{
+	sqlite3_backup * backup = sqlite3_backup_init(to, "main", from, "main");
+
+	if(!backup)
+	{
+		std::string errorMsg = what + " failed because of: " + sqlite3_errmsg(to);
+		Log::log() << errorMsg << std::endl;
+		throw std::runtime_error(errorMsg);
+	}
+
+	int ret = SQLITE_OK;
+
+	for(int tries = 0; tries < 1000; tries++)
+	{
+		ret = sqlite3_backup_step(backup, -1);
+
+		if(ret != SQLITE_BUSY && ret != SQLITE_LOCKED)
+			break;
+
+		sqlite3_sleep(10);
+	}
+
+	sqlite3_backup_finish(backup);
+
+	if(ret != SQLITE_DONE)
+	{
+		std::string errorMsg = what + " failed because of: " + sqlite3_errstr(ret);
+		Log::log() << errorMsg << std::endl;
+		throw std::runtime_error(errorMsg);
+	}
+}
+
+void DatabaseInterface::snapshotTo(const std::string & file)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::snapshotTo);
+	assert(_db && _transactionWriteDepth == 0);
+
+	std::error_code error;
+	std::filesystem::remove(file, error);
+
+	sqlite3 * snapshot = nullptr;
+
+	if(sqlite3_open_v2(file.c_str(), &snapshot, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL) != SQLITE_OK)
+	{
+		std::string errorMsg = "DatabaseInterface::snapshotTo couldn't open '" + file + "' because of: " + (snapshot ? sqlite3_errmsg(snapshot) : "not even a broken sqlite3 obj was returned...");
+		Log::log() << errorMsg << std::endl;
+		sqlite3_close(snapshot);
+		throw std::runtime_error(errorMsg);
+	}
+
+	try
+	{
+		backupDatabase(_db, snapshot, "DatabaseInterface::snapshotTo '" + file + "'");
+
+		//The pages copied still say WAL, taking the snapshot out of that mode leaves a single file behind that needs no -wal or -shm next to it
+		if(sqlite3_exec(snapshot, "PRAGMA journal_mode=DELETE;", NULL, NULL, NULL) != SQLITE_OK)
+			throw std::runtime_error("DatabaseInterface::snapshotTo couldn't leave WAL mode in '" + file + "' because of: " + sqlite3_errmsg(snapshot));
+	}
+	catch(...)
+	{
+		sqlite3_close(snapshot);
+		throw;
+	}
+
+	sqlite3_close(snapshot);
+}
+
+void DatabaseInterface::restoreFrom(const std::string & file)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::restoreFrom);
+	assert(_db && _transactionWriteDepth == 0 && _transactionReadDepth == 0);
+
+	sqlite3 * source = nullptr;
+
+	if(sqlite3_open_v2(file.c_str(), &source, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK)
+	{
+		std::string errorMsg = "DatabaseInterface::restoreFrom couldn't open '" + file + "' because of: " + (source ? sqlite3_errmsg(source) : "not even a broken sqlite3 obj was returned...");
+		Log::log() << errorMsg << std::endl;
+		sqlite3_close(source);
+		throw std::runtime_error(errorMsg);
+	}
+
+	try
+	{
+		backupDatabase(source, _db, "DatabaseInterface::restoreFrom '" + file + "'");
+	}
+	catch(...)
+	{
+		sqlite3_close(source);
+		throw;
+	}
+
+	sqlite3_close(source);
+}
+
+void DatabaseInterface::reconnect()
+{
+	JASPTIMER_SCOPE(DatabaseInterface::reconnect);
+	assert(_transactionWriteDepth == 0 && _transactionReadDepth == 0);
+
+	close();
+	load();
+}
+
 void DatabaseInterface::create()
 {
 	JASPTIMER_SCOPE(DatabaseInterface::create);
@@ -1563,6 +1888,10 @@ void DatabaseInterface::create()
 		Log::log() << "DatabaseInterface::create: Removing existing sqlite internal db at " << dbFile() << std::endl;
 		std::filesystem::remove(dbFile());
 	}
+
+	for(const char * postfix : {"-wal", "-shm"}) //A log left behind would otherwise be applied to our fresh database
+		if(std::filesystem::exists(dbFile() + postfix))
+			std::filesystem::remove(dbFile() + postfix);
 	
 	int ret = sqlite3_open_v2(dbFile().c_str(), &_db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX, NULL);
 
@@ -1574,6 +1903,7 @@ void DatabaseInterface::create()
 	else
 		Log::log() << "Opened internal sqlite database for creation at '" << dbFile() << "'." << std::endl;
 
+	configureConnection();
 
 	transactionWriteBegin();
 	runStatements(_dbConstructionSql);
@@ -1597,6 +1927,8 @@ void DatabaseInterface::load()
 	}
 	else
 		Log::log() << "Opened internal sqlite database for loading at '" << dbFile() << "'." << std::endl;
+
+	configureConnection();
 }
 
 void DatabaseInterface::close()
@@ -1604,6 +1936,7 @@ void DatabaseInterface::close()
 	JASPTIMER_SCOPE(DatabaseInterface::close);
 	if(_db)
 	{
+		_clearStatementCache(); //Otherwise sqlite3_close refuses
 		sqlite3_close(_db);
 		_db = nullptr;
 	}
@@ -6,6 +6,8 @@
 #include <string>
 #include "utils.h"
 #include <json/json.h>
+#include <unordered_map>
+#include <mutex>
 #include "version.h"
 
 
@@ -51,6 +53,11 @@ class DatabaseInterface;
 ///		|---------------------> Filters [id, info...] 
 ///		|---------------------> Column  [id, info...] -> Labels [ id, columnId, info... ]
 /// 
+/// The database runs in WAL mode, so the engines can keep reading while Desktop writes, which does mean that
+/// internal.sqlite should never be copied or replaced as a file while it is open, use snapshotTo() and restoreFrom() for that.
+/// Statements with parameters (a '?') are kept prepared in _statementCache under their sql, so running them again only needs a reset and new binds.
+/// A cached statement is marked as in use while it is being stepped, a nested query or another thread then prepares a fresh one and eviction passes it by.
+/// 
 class DatabaseInterface
 {
 public:
@@ -86,7 +93,10 @@ public:
 	int			dataSetIncRevision(		int dataSetId);
 	int			dataSetGetRevision(		int dataSetId);
 	int			dataSetGetFilter(		int dataSetId);
+	void		dataSetSetRowsDelta(	int dataSetId, const std::string & rowsDeltaJson);	///< See DataSet::rowsDeltaApply
+	std::string	dataSetGetRowsDelta(	int dataSetId);
 	void		dataSetInsertEmptyRow(	int dataSetId, size_t row);
+	void		dataSetClearContentHashes(int dataSetId);											///< Forgets the contentHash of all its columns, for instance because the workspace empty values changed
 
 	void		dataSetBatchedValuesUpdate(DataSet * data, std::vector<Column*> columns, std::function<void(float)> progressCallback = [](float){});
 	void		dataSetBatchedValuesUpdate(DataSet * data, std::function<void(float)> progressCallback = [](float){});
@@ -118,6 +128,8 @@ public:
 	void		columnSetIndex(			int columnId, int index);		///< If this is used by JASP and changes the index the assumption is all will be brought in order. By setting the indices correct for all columns.
 	int			columnIncRevision(		int columnId);
 	int			columnGetRevision(		int columnId);
+	void		columnSetContentHash(	int columnId, uint64_t   contentHash);
+	bool		columnGetContentHash(	int columnId, uint64_t & contentHash);	///< Returns false if no hash was stored (anymore) for this column
 
 	//id stuff:
 	int			columnGetDataSetId(			int columnId);
@@ -157,16 +169,50 @@ public:
 	void		transactionWriteEnd(bool rollback = false);		///< runs COMMIT or ROLLBACK based on rollback and ends the transaction.  Tracks whether nested and only does BEGIN+COMMIT at lowest depth
 	void		transactionReadBegin();							///< runs BEGIN DEFERRED and waits for sqlite to not be busy anymore if some other process is writing  Tracks whether nested and only does BEGIN+COMMIT at lowest depth
 	void		transactionReadEnd();							///< runs COMMIT and ends the transaction. Tracks whether nested and only does BEGIN+COMMIT at lowest depth
+
+	void		checkpoint();									///< Moves everything in the write-ahead log into internal.sqlite itself and empties the log, throws if another connection kept it from finishing
+	void		reconnect();									///< Closes and loads internal.sqlite again, in WAL mode sqlite doesn't notice the file was replaced by another and would keep using what it cached
+	void		snapshotTo(	const std::string & file);			///< Writes a consistent copy of the database to file through sqlite3_backup, including whatever is still in the write-ahead log
+	void		restoreFrom(const std::string & file);			///< Replaces everything in the database by what is in file through sqlite3_backup, the engines see that as any other write so none of them keeps stale pages
+
 	
 private:
 	void		_doubleTroubleBinder(sqlite3_stmt *stmt, int param, double dbl);	///< Needed to work around the lack of support for NAN, INF and NEG_INF in sqlite, converts those to string to make use of sqlite flexibility
 	double		_doubleTroubleReader(sqlite3_stmt *stmt, int colI);					///< The reading counterpart to _doubleTroubleBinder to convert string representations of NAN, INF and NEG_INF back to double
 	void		_runStatements(				const std::string & statements,						std::function<void(sqlite3_stmt *stmt)> *	bindParameters = nullptr,	std::function<void(size_t row, sqlite3_stmt *stmt)> *	processRow = nullptr);	///< Runs several sql statements without looking at the results. Unless processRow is not NULL, then this is called for each row.
 	void		_runStatementsRepeatedly(	const std::string & statements, std::function<bool(	std::function<void(sqlite3_stmt *stmt)> **	bindParameters, size_t row)> bindParameterFactory, std::function<void(size_t row, size_t repetition, sqlite3_stmt *stmt)> * processRow = nullptr);
+	struct cachedStatement
+	{
+		sqlite3_stmt	*	stmt;
+		size_t				length;			///< How much of the sql it was prepared from it used, to know where the next statement starts
+		bool				inUse = false;	///< Between _prepareStatement and _finishStatement, nobody else may reset or finalize it then
+	};
+
+	int			_prepareStatement(			const char * sql, size_t length, sqlite3_stmt ** stmt, const char ** tail, cachedStatement *& cached);	///< sqlite3_prepare_v2 or a reset statement from _statementCache, cached tells _finishStatement what to do
+	int			_finishStatement(			sqlite3_stmt * stmt, cachedStatement * cached);																///< Finalizes or resets stmt, returns what sqlite3_finalize would
+	void		_clearStatementCache();
+
+	///Holds what _prepareStatement gave out and finishes it on the way out, also when sqlite or a callback throws, so a cached statement cannot stay in use forever.
+	struct preparedStatement
+	{
+		preparedStatement(DatabaseInterface * db) : _db(db) {}
+		~preparedStatement() { finish(); }
+
+		int				prepare(const char * sql, size_t length, const char ** tail)	{ finish(); return _db->_prepareStatement(sql, length, &stmt, tail, _cached); }
+		int				finish();																										///< What _finishStatement returns, or SQLITE_OK if there is nothing to finish
+
+		sqlite3_stmt	*	stmt	= nullptr;
+
+	private:
+		DatabaseInterface	*	_db;
+		cachedStatement		*	_cached	= nullptr;
+	};
+	size_t		_rowsPerInsert(				size_t parametersPerRow)	const;															///< How many rows fit in a single multirow INSERT without exceeding the maximum number of parameters
 
 	void		create();										///< Creates a new sqlite database in sessiondir and loads it
 	void		load();											///< Loads a sqlite database from sessiondir (after loading a jaspfile)
 	void		close();										///< Closes the loaded database and disconnects
+	void		configureConnection();							///< Switches to WAL and sets the pragmas that go with it, must run outside of a transaction
 	bool		tableHasColumn(const std::string & tableName, const std::string & columnName);
 
 	int			_transactionWriteDepth	= 0,
@@ -174,6 +220,9 @@ private:
 
 	sqlite3	*	_db = nullptr;
 
+	std::unordered_map<std::string, cachedStatement>	_statementCache;		///< Its nodes stay put when it grows, so a cachedStatement * remains valid until it is evicted, which never happens while in use
+	std::mutex											_statementCacheLock;	///< The AsyncLoader thread runs queries as well
+
 	static			std::string _wrap_sqlite3_column_text(sqlite3_stmt * stmt, int iCol);
 	static const	std::string _dbConstructionSql;
 
@@ -77,7 +77,28 @@ void DataSet::endBatchedToDB(std::function<void(float)> progressCallback, Column
 		columns = _columns;
 
 	db().dataSetBatchedValuesUpdate(this, columns, progressCallback);
+	labelsOrderFlush();
 	incRevision(); //Should trigger reload at engine end
+	
+	for(Column * column : columns)
+		column->contentHashPersist(); //dataSetBatchedValuesUpdate cleared them, but setValue kept the ones in memory up to date
+}
+
+void DataSet::labelsOrderChanged(Column * column)
+{
+	if(_writeBatchedToDB)
+		return;
+	
+	if(!_labelsOrderFlushScheduler || !_labelsOrderFlushScheduler())
+		column->labelsOrderFlush();
+}
+
+void DataSet::labelsOrderFlush()
+{
+	JASPTIMER_SCOPE(DataSet::labelsOrderFlush);
+	
+	for(Column * column : _columns)
+		column->labelsOrderFlush();
 }
 
 int DataSet::getColumnIndex(const std::string & name) const 
@@ -409,6 +430,145 @@ void DataSet::setRowCount(size_t rowCount)
 	_filter->reset();
 }
 
+void DataSet::rowsInsert(size_t row, size_t count)
+{
+	JASPTIMER_SCOPE(DataSet::rowsInsert);
+	
+	row = std::min(row, size_t(rowCount()));
+	
+	if(count == 0)
+		return;
+	
+	const int fromRevision = _revision;
+	
+	db().transactionWriteBegin();
+	beginBatchedToDB();
+	
+	_rowsInsert(row, count);
+	_filter->reset();
+	
+	endBatchedToDB();
+	
+	Json::Value delta	= Json::objectValue;
+	delta["insert"]		= Json::arrayValue;
+	delta["insert"]		.append(Json::UInt64(row));
+	delta["insert"]		.append(Json::UInt64(count));
+	
+	rowsDeltaStore(fromRevision, delta);
+	
+	db().transactionWriteEnd();
+}
+
+void DataSet::rowsDelete(rowRanges ranges)
+{
+	JASPTIMER_SCOPE(DataSet::rowsDelete);
+	
+	std::sort(ranges.begin(), ranges.end());
+	
+	//Clip them to the data and merge those that overlap or touch, which is what Column::rowsDelete expects
+	rowRanges merged;
+	for(auto range : ranges)
+	{
+		range.second = std::min(range.first + range.second, size_t(rowCount())) - std::min(range.first, size_t(rowCount()));
+		
+		if(range.second == 0)
+			continue;
+		
+		if(merged.size() && merged.back().first + merged.back().second >= range.first)
+			merged.back().second = std::max(merged.back().first + merged.back().second, range.first + range.second) - merged.back().first;
+		else
+			merged.push_back(range);
+	}
+	
+	if(merged.empty())
+		return;
+	
+	const int fromRevision = _revision;
+	
+	db().transactionWriteBegin();
+	beginBatchedToDB();
+	
+	_rowsDelete(merged);
+	_filter->reset();
+	
+	endBatchedToDB();
+	
+	Json::Value delta	= Json::objectValue;
+	delta["delete"]		= Json::arrayValue;
+	
+	for(const auto & range : merged)
+	{
+		Json::Value jsonRange = Json::arrayValue;
+		jsonRange.append(Json::UInt64(range.first));
+		jsonRange.append(Json::UInt64(range.second));
+		delta["delete"].append(jsonRange);
+	}
+	
+	rowsDeltaStore(fromRevision, delta);
+	
+	db().transactionWriteEnd();
+}
+
+void DataSet::_rowsInsert(size_t row, size_t count)
+{
+	for(Column * column : _columns)
+		column->rowsInsertEmptyVal(row, count);
+	
+	_rowCount += count;
+}
+
+void DataSet::_rowsDelete(const rowRanges & ranges)
+{
+	for(Column * column : _columns)
+		column->rowsDelete(ranges);
+	
+	for(const auto & range : ranges)
+		_rowCount -= range.second;
+}
+
+///The delta only describes the step from fromRevision to the current revision, any other change to the dataset increments the revision without a delta and so makes the engines load everything again
+void DataSet::rowsDeltaStore(int fromRevision, const Json::Value & delta)
+{
+	Json::Value stored	= delta;
+	stored["from"]		= fromRevision;
+	stored["to"]		= _revision;
+	
+	db().dataSetSetRowsDelta(_dataSetID, stored.toStyledString());
+}
+
+///Used by checkForUpdates to move the rows in memory instead of loading the whole dataset again when only rows were inserted or deleted
+bool DataSet::rowsDeltaApply(int dbRevision)
+{
+	JASPTIMER_SCOPE(DataSet::rowsDeltaApply);
+	
+	Json::Value delta;
+	
+	if(!Json::Reader().parse(db().dataSetGetRowsDelta(_dataSetID), delta) || !delta.isObject() || delta["from"].asInt() != _revision || delta["to"].asInt() != dbRevision)
+		return false;
+	
+	if(delta.isMember("insert"))
+		_rowsInsert(delta["insert"][0].asUInt64(), delta["insert"][1].asUInt64());
+	
+	else if(delta.isMember("delete"))
+	{
+		rowRanges ranges;
+		for(const Json::Value & range : delta["delete"])
+			ranges.push_back({range[0].asUInt64(), range[1].asUInt64()});
+		
+		_rowsDelete(ranges);
+	}
+	
+	if(_rowCount != db().dataSetRowCount(_dataSetID))
+		return false; //Something is off, the dbLoad that follows will set it straight
+	
+	_filter->dbLoad();
+	_revision = dbRevision;
+	
+	Log::log() << "DataSet::rowsDeltaApply moved the rows in memory instead of loading all data." << std::endl;
+	
+	return true;
+}
+
 void DataSet::incRevision()
 {
 	assert(_dataSetID != -1);
@@ -431,10 +591,11 @@ bool DataSet::checkForUpdates(stringvec * colsChanged, stringvec * colsRemoved,
 	for(Column * col : _columns)
 		prevCols.insert(col->name());
 	
-	size_t rowCountPrev = rowCount();
-	
+	size_t		rowCountPrev	= rowCount();
+	const int	dbRevision		= db().dataSetGetRevision(_dataSetID);
+	const bool	rowsMoved		= _revision != dbRevision && rowsDeltaApply(dbRevision);
 		
-	if(_revision != db().dataSetGetRevision(_dataSetID))
+	if(_revision != dbRevision)
 	{
 		dbLoad();
 		
@@ -461,14 +622,18 @@ bool DataSet::checkForUpdates(stringvec * colsChanged, stringvec * colsRemoved,
 	}
 	else
 	{
-		bool somethingChanged = _filter->checkForUpdates();
+		bool somethingChanged = _filter->checkForUpdates() || rowsMoved;
+		
+		if(colsChanged && rowsMoved)
+			for(Column * col : _columns)
+				colsChanged->push_back(col->name());
 
 		for(Column * col : _columns)
 			if(col->checkForUpdates())
 			{
 				somethingChanged = true;
 
-				if(colsChanged)
+				if(colsChanged && !rowsMoved)
 					colsChanged->push_back(col->name());
 			}
 		
@@ -557,6 +722,10 @@ void DataSet::setWorkspaceEmptyValues(const stringset &values)
 {
 	_emptyValues->setEmptyValues(values);
 	dbUpdate();
+	
+	//Those are hashed as empty labels, so the hashes stored for columns that use the workspace empty values are off now
+	if(_dataSetID != -1)
+		db().dataSetClearContentHashes(_dataSetID);
 }
 
 void DataSet::setDescription(const std::string &desc)
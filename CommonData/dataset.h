@@ -52,6 +52,10 @@ public:
 
 			bool			allColumnsPassFilter()					const;
 
+			void			labelsOrderChanged(Column * column);											///< Flushes the label order of column right away unless the scheduler took it or a batch is being written, endBatchedToDB flushes then
+			void			labelsOrderFlush();																///< Calls Column::labelsOrderFlush on all columns
+			void			setLabelsOrderFlushScheduler(std::function<bool()> scheduler) { _labelsOrderFlushScheduler = scheduler; }	///< The scheduler should make sure labelsOrderFlush gets called later and return true, or false when it can't from this thread, Desktop does it once per turn of the eventloop
+
 			qsizetype		getMaximumColumnWidthInCharacters(size_t columnIndex) const;
 			stringvec		getColumnNames();
 
@@ -61,6 +65,8 @@ public:
 
 			void			setColumnCount(	size_t colCount);
 			void			setRowCount(	size_t rowCount);
+			void			rowsInsert(		size_t row, size_t count);	///< Inserts empty rows in all columns and stores them as delta for the engines, see rowsDeltaApply
+			void			rowsDelete(		rowRanges ranges);			///< Removes the rows in all columns with a single pass each and stores them as delta for the engines, ranges may be unsorted
 
 			void			incRevision() override;
 			bool			checkForUpdates(stringvec * colsChanged = nullptr, stringvec * colsRemoved = nullptr, bool * newColumns = nullptr, bool * rowCountChanged = nullptr);
@@ -85,6 +91,10 @@ public:
 
 private:			
 			void					upgradeTo019(const Json::Value & emptyVals);
+			void					_rowsInsert(		size_t row, size_t count);
+			void					_rowsDelete(		const rowRanges & ranges);
+			void					rowsDeltaStore(		int fromRevision, const Json::Value & delta);
+			bool					rowsDeltaApply(		int dbRevision);
 			void					setEmptyValuesJsonOldStuff(	const Json::Value & emptyValues);
 			
 			
@@ -102,6 +112,7 @@ private:
 	
 	bool						_writeBatchedToDB		= false,
 								_dataFileSynch			= false;
+	std::function<bool()>		_labelsOrderFlushScheduler;
 	static stringset			_defaultEmptyvalues;	// Default empty values if workspace do not have its own empty values (used for backward compatibility)
 	std::string					_description;
 };
@@ -16,6 +16,7 @@ void EmptyValues::resetEmptyValues()
 {
 	_emptyStrings.clear();
 	_emptyDoubles.clear();
+	_generation++;
 }
 
 EmptyValues::~EmptyValues()
@@ -68,6 +69,7 @@ void EmptyValues::setEmptyValues(const stringset& values, bool custom)
 	_emptyStrings	= values;
 	_emptyDoubles	= ColumnUtils::getDoubleValues(values);
 	_hasEmptyValues	= custom;
+	_generation++;
 }
 
 bool EmptyValues::hasEmptyValues() const
@@ -78,6 +80,7 @@ bool EmptyValues::hasEmptyValues() const
 void EmptyValues::setHasCustomEmptyValues(bool hasThem)
 {
 	_hasEmptyValues = hasThem;
+	_generation++;
 	
 	if(_parent)
 		setEmptyValues(!_hasEmptyValues ? stringset() : _parent->_emptyStrings, _hasEmptyValues);
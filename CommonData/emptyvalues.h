@@ -22,6 +22,7 @@ public:
 	const	stringset		&	emptyStringsColumnModel()							const;
 	const	doubleset		&	emptyDoubles()										const;
 			bool				hasEmptyValues()									const;
+			size_t				generation()										const	{ return _generation + (_parent ? _parent->generation() : 0); } ///< Goes up whenever these or the parent's empty values change, so anything derived from them can tell it is out of date
 			void				setHasCustomEmptyValues(bool hasThem);
 		    void				setEmptyValues(const stringset	& values);
 			void				setEmptyValues(const stringset	& values, bool custom);
@@ -41,6 +42,7 @@ private:
 			stringset			_emptyStrings;
 			doubleset			_emptyDoubles;
 			bool				_hasEmptyValues			= false;
+			size_t				_generation				= 0;
 };
 
 #endif // EMPTYVALUES_H
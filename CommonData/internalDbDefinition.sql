@@ -8,7 +8,8 @@ CREATE TABLE DataSets (
 	databaseJson	TEXT, 
 	emptyValuesJson TEXT, 
 	revision		INT DEFAULT 0, 
-	dataFileSynch	INT
+	dataFileSynch	INT,
+	rowsDeltaJson	TEXT NULL		-- See DataSet::rowsDeltaApply
 );
 
 CREATE TABLE Filters ( 
@@ -44,6 +45,7 @@ CREATE TABLE Columns
 	analysisID			INT		NULL, 
 	emptyValuesJson		TEXT	NULL,
 	revision			INT		DEFAULT 0, 
+	contentHash			INT		NULL,		-- See Column::contentHash, cleared whenever revision is incremented
 	
 	FOREIGN KEY(dataSet) REFERENCES DataSets(id)
 );
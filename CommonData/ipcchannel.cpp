@@ -111,6 +111,31 @@ IPCChannel::IPCChannel(std::string name, size_t channelNumber, bool isSlave)
 			_mutexOut	= mutexesOut.first;
 		});
 
+	if(!_isSlave)
+	{
+		findConstructUnreadFlags();
+		findConstructControl();
+	}
+	else
+		catchAndRepeat("Finding unread flags and control", [&]()
+		{
+			auto control = _memoryControl->find<std::atomic<uint64_t>>("control");
+
+			if(control.first == nullptr)	throw std::runtime_error("Couldn't find control for IPCChannel...");
+
+			_control = control.first;
+
+			auto unreadIn  = _memoryControl->find<bool>(_unreadInName.c_str());
+			auto unreadOut = _memoryControl->find<bool>(_unreadOutName.c_str());
+
+			if(unreadIn.first  == nullptr)	throw std::runtime_error("Couldn't find unread flag in for IPCChannel...");
+			if(unreadOut.first == nullptr)	throw std::runtime_error("Couldn't find unread flag out for IPCChannel...");
+
+			_unreadIn	= unreadIn.first;
+			_unreadOut	= unreadOut.first;
+			*_unreadOut	= false; //An engine that ran on this channel before might have left it set, but this one hasn't sent anything yet
+		});
+
 	_memoryIn	= _isSlave ? _memoryMasterToSlave : _memorySlaveToMaster;
 	_memoryOut	= _isSlave ? _memorySlaveToMaster : _memoryMasterToSlave;
 
@@ -208,6 +233,21 @@ void IPCChannel::findConstructMutexes()
 }
 
 
+void IPCChannel::findConstructUnreadFlags()
+{
+	_unreadIn  = _memoryControl->find_or_construct<bool>(_unreadInName.c_str())(false);
+	_unreadOut = _memoryControl->find_or_construct<bool>(_unreadOutName.c_str())(false);
+}
+
+
+void IPCChannel::findConstructControl()
+{
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "The control of IPCChannel lives in shared memory, which only works when the atomic doesn't need a lock");
+
+	_control = _memoryControl->find_or_construct<std::atomic<uint64_t>>("control")(0);
+}
+
+
 void IPCChannel::findConstructDataStrings()
 {
 	Log::log() << "Finding/constructing communication strings" << std::endl;
@@ -224,6 +264,8 @@ void IPCChannel::findConstructAllAgain()
 	Log::log() << "Finding/constructing all relevant shared memory objects again." << std::endl;
 	findConstructSizes();
 	findConstructMutexes();
+	findConstructUnreadFlags();
+	findConstructControl();
 	findConstructDataStrings();
 }
 
@@ -286,7 +328,7 @@ IPCChannel::~IPCChannel()
 
 void IPCChannel::generateNames()
 {
-	stringstream mutexInName, mutexOutName, dataInName, dataOutName, semaphoreInName, semaphoreOutName;
+	stringstream mutexInName, mutexOutName, dataInName, dataOutName, semaphoreInName, semaphoreOutName, unreadInName, unreadOutName;
 
 	std::string in  = _isSlave ? "-s" : "-m";
 	std::string out = _isSlave ? "-m" : "-s";
@@ -297,6 +339,8 @@ void IPCChannel::generateNames()
 	mutexOutName		<< _baseName << out << 'm' << _channelNumber;
 	semaphoreInName		<< _baseName << in  << 's' << _channelNumber;
 	semaphoreOutName	<< _baseName << out << 's' << _channelNumber;
+	unreadInName		<< _baseName << in  << 'u' << _channelNumber;
+	unreadOutName		<< _baseName << out << 'u' << _channelNumber;
 
 	_semaphoreOutName	= semaphoreOutName.str();
 	_semaphoreInName	= semaphoreInName.str();
@@ -304,6 +348,8 @@ void IPCChannel::generateNames()
 	_mutexInName		= mutexInName.str();
 	_dataOutName		= dataOutName.str();
 	_dataInName			= dataInName.str();
+	_unreadOutName		= unreadOutName.str();
+	_unreadInName		= unreadInName.str();
 }
 
 void IPCChannel::rebindMemoryInIfSizeChanged()
@@ -358,6 +404,7 @@ void IPCChannel::send(string &data, bool alreadyLockedMutex)
 		if(!alreadyLockedMutex)
 			_mutexOut->lock();
 		_dataOut->assign(data.begin(), data.end());
+		*_unreadOut = true;
 	}
 	catch (boost::interprocess::bad_alloc &e)	{ goto retryAfterDoublingMemory; }
 	catch (std::length_error &e)				{ goto retryAfterDoublingMemory; }
@@ -381,6 +428,8 @@ void IPCChannel::send(string &data, bool alreadyLockedMutex)
 	_semaphoreOut->post();
 #endif
 
+	if(!_isSlave)
+		controlCountMessage(); //After the post, so that an engine that sees the control change can also receive the message
 
 	_mutexOut->unlock();
 	return; // return here to avoid going to retryAfterDoublingMemory
@@ -405,6 +454,7 @@ bool IPCChannel::receive(string &data, int timeout)
 		{
 			rebindMemoryInIfSizeChanged();
 			data.assign(_dataIn->c_str(), _dataIn->size());
+			*_unreadIn = false;
 		}
 		catch(std::exception & e)
 		{
@@ -420,6 +470,34 @@ bool IPCChannel::receive(string &data, int timeout)
 	return false;
 }
 
+///There is only one Desktop writing the control of a channel, so there is no need to compare and exchange
+void IPCChannel::publishControl(uint8_t flags, int revision)
+{
+	const uint64_t current = _control->load(std::memory_order_relaxed);
+
+	_control->store((uint64_t(uint32_t(revision)) << 32) | (current & 0xFFFFFF00) | flags, std::memory_order_release);
+}
+
+void IPCChannel::controlCountMessage()
+{
+	const uint64_t	current		= _control->load(std::memory_order_relaxed),
+					messages	= ((current >> 8) + 1) & 0xFFFFFF;
+
+	_control->store((current & 0xFFFFFFFF000000FF) | (messages << 8), std::memory_order_release);
+}
+
+bool IPCChannel::lastSentReceived()
+{
+	if(!_mutexOut->try_lock())
+		return false; //The other side is reading it right now, or we are still writing it
+
+	bool received = !*_unreadOut;
+
+	_mutexOut->unlock();
+
+	return received;
+}
+
 
 bool IPCChannel::tryWait(int timeout)
 {
@@ -37,6 +37,7 @@
 #include <boost/interprocess/managed_shared_memory.hpp>
 #include <boost/container/string.hpp>
 #include <functional>
+#include <atomic>
 
 typedef boost::interprocess::allocator<char,	boost::interprocess::managed_shared_memory::segment_manager	> CharAllocator;
 typedef boost::container::basic_string<char,	std::char_traits<char>, CharAllocator						> String;
@@ -54,11 +55,22 @@ public:
 	IPCChannel(std::string name, size_t channelNumber, bool isSlave = false);
 	~IPCChannel();
 
+	static constexpr uint8_t	controlAbort	= 1,	///< Flags of publishControl
+								controlRun		= 2,
+								controlPause	= 4,
+								controlStop		= 8;
+
 	std::string lastSentMsg() const;
 
 	void send(std::string		&	data,	bool alreadyLockedMutex = false);
 	void send(std::string		&&	data,	bool alreadyLockedMutex = false);
 	bool receive(std::string	&	data,	int timeout = 0);
+	bool lastSentReceived();	///< Whether the other side already picked up what we sent last, a new send would otherwise overwrite it unread
+
+	void		publishControl(uint8_t flags, int revision);								///< Desktop side, right before sending the message these describe
+	uint64_t	control() const { return _control->load(std::memory_order_acquire); }		///< Changes with every message the Desktop sends, see _control
+	static bool	controlHas(uint64_t control, uint8_t flag)	{ return (control & flag) != 0; }
+	static int	controlRevision(uint64_t control)			{ return int(uint32_t(control >> 32)); }
 
 	size_t channelNumber() { return _channelNumber; }
 
@@ -75,6 +87,9 @@ private:
 	void findConstructSizes();
 	void findConstructDataStrings();
 	void findConstructMutexes();
+	void findConstructUnreadFlags();
+	void findConstructControl();
+	void controlCountMessage();
 
 	std::string										_baseName,
 													_nameControl,
@@ -91,6 +106,9 @@ private:
 												*	_mutexIn				= nullptr;
 	String										*	_dataOut				= nullptr,
 												*	_dataIn					= nullptr;
+	bool										*	_unreadOut				= nullptr,	///< Set by send and cleared by receive on the other side, guarded by the mutex of the data
+												*	_unreadIn				= nullptr;
+	std::atomic<uint64_t>						*	_control				= nullptr;	///< Only written by the Desktop: lowest byte the flags, next 24 bits count its messages, upper 32 bits the revision. So an engine learns anything new with a single load.
 	size_t										*	_sizeMtoS				= nullptr,
 												*	_sizeStoM				= nullptr,
 												*	_sizeIn					= nullptr,
@@ -101,6 +119,8 @@ private:
 													_mutexOutName,
 													_dataInName,
 													_dataOutName,
+													_unreadInName,
+													_unreadOutName,
 													_semaphoreInName,
 													_semaphoreOutName;
 #ifdef __APPLE__
@@ -0,0 +1,79 @@
+#include "journalreplay.h"
+#include "timers.h"
+#include "utils.h"
+#include "log.h"
+#include <fstream>
+#include <vector>
+#include <map>
+
+JournalReplay JournalReplay::replay(const std::string & journalFile)
+{
+	std::ifstream journal(Utils::osPath(journalFile), std::ios::binary);
+
+	return replay(journal);
+}
+
+///A line that doesn't parse can only be the last one, cut short by the crash, and everything before it still counts.
+///Analyses are in the order of the last order record, those added after it come last in order of their id.
+JournalReplay JournalReplay::replay(std::istream & journal)
+{
+	JASPTIMER_SCOPE(JournalReplay::replay);
+
+	JournalReplay					replayed;
+	std::map<size_t, Json::Value>	analyses;
+	std::vector<size_t>				order;
+	Json::Value						meta	= Json::nullValue;
+	std::string						line;
+	Json::Reader					reader;
+
+	while(std::getline(journal, line))
+	{
+		Json::Value record;
+
+		if(!reader.parse(line, record, false) || !record.isObject())
+		{
+			Log::log() << "JournalReplay::replay stopped at an incomplete record after " << replayed.records << " records." << std::endl;
+			break;
+		}
+
+		const std::string type = record["journal"].asString();
+
+		if(type == "workspace")
+		{
+			replayed.file		= record["file"].asString();
+			replayed.hasData	= record["data"].asBool();
+		}
+		else if(type == "analysis")		analyses[record["analysis"]["id"].asUInt64()] = record["analysis"];
+		else if(type == "removed")		analyses.erase(record["id"].asUInt64());
+		else if(type == "meta")			meta = record["meta"];
+		else if(type == "order")
+		{
+			order.clear();
+			for(const Json::Value & id : record["ids"])
+				order.push_back(id.asUInt64());
+		}
+		else if(type == "columns")
+			for(const Json::Value & column : record["columns"])
+				replayed.columnsEdited.insert(column.asString());
+
+		replayed.records++;
+	}
+
+	Json::Value analysesList = Json::arrayValue;
+
+	for(size_t id : order)
+		if(analyses.count(id))
+		{
+			analysesList.append(analyses[id]);
+			analyses.erase(id);
+		}
+
+	for(const auto & idAnalysis : analyses) //Added after the last order was written
+		analysesList.append(idAnalysis.second);
+
+	replayed.analysesData				= Json::objectValue;
+	replayed.analysesData["analyses"]	= analysesList;
+	replayed.analysesData["meta"]		= meta;
+
+	return replayed;
+}
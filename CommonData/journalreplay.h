@@ -0,0 +1,28 @@
+#ifndef JOURNALREPLAY_H
+#define JOURNALREPLAY_H
+
+#include <json/json.h>
+#include <istream>
+#include <string>
+#include <set>
+
+///
+/// What the records of an autosave journal add up to, see AutosaveJournal in Desktop which writes them.
+/// Each line is a compact json record: the workspace, a whole analysis, an analysis that was removed, the order of the analyses, the results meta or the columns edited.
+/// They are applied in order, so a later record for the same analysis replaces an earlier one and a removed analysis can come back again.
+/// This lives here instead of next to AutosaveJournal so that it can be tested without Qt.
+struct JournalReplay
+{
+	std::string				file;				///< The file that was open, if any
+	bool					hasData		= false;
+	Json::Value				analysesData;		///< As Analyses::asJson, ready for DataSetPackage::setAnalysesData
+	std::set<std::string>	columnsEdited;
+	size_t					records		= 0;	///< How many were applied
+
+	bool					worthRecovering() const { return hasData || analysesData["analyses"].size() > 0; }
+
+	static JournalReplay	replay(const std::string	& journalFile);
+	static JournalReplay	replay(std::istream			& journal);
+};
+
+#endif // JOURNALREPLAY_H
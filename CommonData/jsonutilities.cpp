@@ -135,3 +135,73 @@ stringset JsonUtilities::jsonStringArrayToSet(const Json::Value &jsonStrings)
 	
 	return stringset(vec.begin(), vec.end());
 }
+
+Json::Value JsonUtilities::structuralDiff(const Json::Value & from, const Json::Value & to)
+{
+	Json::Value path	= Json::arrayValue,
+				ops		= Json::arrayValue;
+
+	structuralDiff(from, to, path, ops);
+
+	return ops;
+}
+
+void JsonUtilities::structuralDiff(const Json::Value & from, const Json::Value & to, Json::Value & path, Json::Value & ops)
+{
+	auto addOp = [&](const std::string & op, const Json::Value & opPath) -> Json::Value &
+	{
+		Json::Value & added = ops.append(Json::objectValue);
+		added["op"]		= op;
+		added["path"]	= opPath;
+		return added;
+	};
+
+	if(from.type() != to.type() || !(from.isObject() || from.isArray()))
+	{
+		if(from.type() != to.type() || from != to)
+			addOp("set", path)["value"] = to;
+		return;
+	}
+
+	if(from.isArray())
+	{
+		const Json::ArrayIndex	common = std::min(from.size(), to.size());
+
+		for(Json::ArrayIndex i=0; i<common; i++)
+		{
+			path.append(i);
+			structuralDiff(from[i], to[i], path, ops);
+			path.resize(path.size() - 1);
+		}
+
+		if(to.size() < from.size())
+			addOp("truncate", path)["length"] = to.size();
+
+		for(Json::ArrayIndex i=common; i<to.size(); i++)
+		{
+			Json::Value elementPath = path;
+			elementPath.append(i);
+			addOp("set", elementPath)["value"] = to[i];
+		}
+
+		return;
+	}
+
+	for(const std::string & name : from.getMemberNames())
+		if(!to.isMember(name))
+		{
+			Json::Value memberPath = path;
+			memberPath.append(name);
+			addOp("remove", memberPath);
+		}
+
+	for(const std::string & name : to.getMemberNames())
+	{
+		path.append(name);
+
+		if(!from.isMember(name))	addOp("set", path)["value"] = to[name];
+		else						structuralDiff(from[name], to[name], path, ops);
+
+		path.resize(path.size() - 1);
+	}
+}
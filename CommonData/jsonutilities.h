@@ -29,6 +29,10 @@ public:
 	static stringvec				jsonStringArrayToVec(const Json::Value & jsonStrings);
 	static stringset				jsonStringArrayToSet(const Json::Value & jsonStrings);
 
+	///Returns an array of operations that turn `from` into `to`, only descending into the parts that actually differ.
+	///Each operation has a "path" (array of member names and indices) and is either {"op": "set", "value"}, {"op": "remove"} for a member or {"op": "truncate", "length"} for an array.
+	static Json::Value				structuralDiff(const Json::Value & from, const Json::Value & to);
+
 	template<typename T>
 	static Json::Value				vecToJsonArray(const std::vector<T> & vec)
 	{
@@ -64,6 +68,8 @@ public:
 
 private:
 	JsonUtilities() {}
+
+	static void						structuralDiff(const Json::Value & from, const Json::Value & to, Json::Value & path, Json::Value & ops);
 };
 
 #endif // JSONUTILITIES_H
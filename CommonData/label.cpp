@@ -36,6 +36,8 @@ Label::Label(Column * column, const std::string &label, int value, bool filterAl
 
 void Label::dbDelete()
 {
+	_column->contentHashInvalidate(); //Also when batched, the rows using this label show something else now
+	
 	if(_column->batchedLabelDepth())
 		return;
 	
@@ -78,6 +80,8 @@ void Label::dbLoad(int labelId)
 void Label::dbUpdate()
 {
 	JASPTIMER_SCOPE(Label::dbUpdate);
+	
+	_column->contentHashInvalidate(); //Also when batched, incRevision only takes care of that otherwise
 
 	if(_column->batchedLabelDepth())
 		return;
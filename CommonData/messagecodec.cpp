@@ -0,0 +1,281 @@
+#include "messagecodec.h"
+#include "timers.h"
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <limits>
+
+std::atomic<bool> MessageCodec::_binary(std::getenv("JASP_IPC_BINARY") != nullptr);
+
+static const unsigned char	cborSelfDescribe[]	= { 0xD9, 0xD9, 0xF7 }; //tag 55799, "this is CBOR"
+static const int			cborMaxDepth		= 1000;
+
+std::string MessageCodec::encode(const Json::Value & msg)
+{
+	return _binary ? encodeBinary(msg) : encodeJson(msg);
+}
+
+std::string MessageCodec::encodeJson(const Json::Value & msg)
+{
+	JASPTIMER_SCOPE(MessageCodec::encodeJson);
+
+	static thread_local std::unique_ptr<Json::StreamWriter> writer = []()
+	{
+		Json::StreamWriterBuilder builder;
+		builder["indentation"]	= "";
+		builder["emitUTF8"]		= true;
+		return std::unique_ptr<Json::StreamWriter>(builder.newStreamWriter());
+	}();
+
+	std::ostringstream out;
+	writer->write(msg, &out);
+
+	return out.str();
+}
+
+std::string MessageCodec::encodeBinary(const Json::Value & msg)
+{
+	JASPTIMER_SCOPE(MessageCodec::encodeBinary);
+
+	std::string out(reinterpret_cast<const char *>(cborSelfDescribe), sizeof(cborSelfDescribe));
+	writeCbor(msg, out);
+
+	return out;
+}
+
+bool MessageCodec::isBinary(const char * begin, const char * end)
+{
+	return size_t(end - begin) >= sizeof(cborSelfDescribe) && memcmp(begin, cborSelfDescribe, sizeof(cborSelfDescribe)) == 0;
+}
+
+bool MessageCodec::decode(const std::string & msg, Json::Value & out, std::string * error)
+{
+	return decode(msg.data(), msg.data() + msg.size(), out, error);
+}
+
+bool MessageCodec::decode(const char * begin, const char * end, Json::Value & out, std::string * error)
+{
+	JASPTIMER_SCOPE(MessageCodec::decode);
+
+	if(isBinary(begin, end))
+	{
+		const unsigned char	*	pos		= reinterpret_cast<const unsigned char *>(begin) + sizeof(cborSelfDescribe),
+							*	stop	= reinterpret_cast<const unsigned char *>(end);
+
+		if(readCbor(pos, stop, out, 0) && pos == stop)
+			return true;
+
+		if(error)
+			*error = "Malformed CBOR at byte " + std::to_string(pos - reinterpret_cast<const unsigned char *>(begin));
+
+		return false;
+	}
+
+	static thread_local std::unique_ptr<Json::CharReader> reader = []()
+	{
+		Json::CharReaderBuilder builder;
+		builder["collectComments"] = false;
+		return std::unique_ptr<Json::CharReader>(builder.newCharReader());
+	}();
+
+	std::string errors;
+	bool		parsed = reader->parse(begin, end, &out, &errors);
+
+	if(!parsed && error)
+		*error = errors;
+
+	return parsed;
+}
+
+void MessageCodec::writeCborHead(unsigned char major, uint64_t argument, std::string & out)
+{
+	major <<= 5;
+
+	if(argument < 24)
+	{
+		out.push_back(char(major | argument));
+		return;
+	}
+
+	int bytes;
+	if		(argument <= 0xFF)			{ out.push_back(char(major | 24)); bytes = 1; }
+	else if	(argument <= 0xFFFF)		{ out.push_back(char(major | 25)); bytes = 2; }
+	else if	(argument <= 0xFFFFFFFF)	{ out.push_back(char(major | 26)); bytes = 4; }
+	else								{ out.push_back(char(major | 27)); bytes = 8; }
+
+	for(int b = bytes - 1; b >= 0; b--)
+		out.push_back(char((argument >> (8 * b)) & 0xFF));
+}
+
+void MessageCodec::writeCbor(const Json::Value & value, std::string & out)
+{
+	switch(value.type())
+	{
+	case Json::nullValue:		out.push_back(char(0xF6));						return;
+	case Json::booleanValue:	out.push_back(char(value.asBool() ? 0xF5 : 0xF4));	return;
+	case Json::uintValue:		writeCborHead(0, value.asUInt64(), out);		return;
+
+	case Json::intValue:
+	{
+		Json::Int64 i = value.asInt64();
+
+		if(i >= 0)	writeCborHead(0, uint64_t(i),		out);
+		else		writeCborHead(1, uint64_t(-1 - i),	out);
+		return;
+	}
+
+	case Json::realValue:
+	{
+		double		d = value.asDouble();
+		uint64_t	bits;
+		memcpy(&bits, &d, sizeof(bits));
+
+		out.push_back(char(0xFB));
+		for(int b = 7; b >= 0; b--)
+			out.push_back(char((bits >> (8 * b)) & 0xFF));
+		return;
+	}
+
+	case Json::stringValue:
+	{
+		const char	*	str;
+		const char	*	strEnd;
+		value.getString(&str, &strEnd);
+
+		writeCborHead(3, uint64_t(strEnd - str), out);
+		out.append(str, strEnd);
+		return;
+	}
+
+	case Json::arrayValue:
+		writeCborHead(4, value.size(), out);
+
+		for(const Json::Value & element : value)
+			writeCbor(element, out);
+		return;
+
+	case Json::objectValue:
+		writeCborHead(5, value.size(), out);
+
+		for(auto member = value.begin(); member != value.end(); member++)
+		{
+			const char	*	name;
+			const char	*	nameEnd;
+			name = member.memberName(&nameEnd);
+
+			writeCborHead(3, uint64_t(nameEnd - name), out);
+			out.append(name, nameEnd);
+			writeCbor(*member, out);
+		}
+		return;
+	}
+}
+
+///Only reads what writeCbor produces plus tags, byte strings and single precision floats. Indefinite lengths are not supported.
+bool MessageCodec::readCbor(const unsigned char *& pos, const unsigned char * end, Json::Value & out, int depth)
+{
+	if(pos >= end || depth > cborMaxDepth)
+		return false;
+
+	unsigned char	initial		= *pos++,
+					major		= initial >> 5,
+					additional	= initial & 0x1F;
+	uint64_t		argument	= additional;
+
+	if(additional >= 24)
+	{
+		if(additional > 27)
+			return false;
+
+		size_t bytes = size_t(1) << (additional - 24);
+
+		if(size_t(end - pos) < bytes)
+			return false;
+
+		argument = 0;
+		for(size_t b = 0; b < bytes; b++)
+			argument = (argument << 8) | *pos++;
+	}
+
+	switch(major)
+	{
+	case 0: //Same as Json::Reader: Int64 whenever it fits, so that types compare equal after a roundtrip
+		if(argument > uint64_t(std::numeric_limits<Json::Int64>::max()))	out = Json::Value(Json::UInt64(argument));
+		else																out = Json::Value(Json::Int64(argument));
+		return true;
+
+	case 1:
+		if(argument > uint64_t(std::numeric_limits<Json::Int64>::max()))	out = -1.0 - double(argument);
+		else																out = Json::Value(Json::Int64(-1 - Json::Int64(argument)));
+		return true;
+
+	case 2:
+	case 3:
+		if(uint64_t(end - pos) < argument)
+			return false;
+
+		out = Json::Value(reinterpret_cast<const char *>(pos), reinterpret_cast<const char *>(pos + argument));
+		pos += argument;
+		return true;
+
+	case 4:
+		out = Json::Value(Json::arrayValue);
+
+		if(argument > uint64_t(end - pos)) //Every element takes at least one byte
+			return false;
+
+		out.resize(Json::ArrayIndex(argument));
+
+		for(Json::ArrayIndex i = 0; i < Json::ArrayIndex(argument); i++)
+			if(!readCbor(pos, end, out[i], depth + 1))
+				return false;
+		return true;
+
+	case 5:
+		out = Json::Value(Json::objectValue);
+
+		for(uint64_t i = 0; i < argument; i++)
+		{
+			Json::Value name;
+
+			if(pos >= end || (*pos >> 5) != 3 || !readCbor(pos, end, name, depth + 1))
+				return false;
+
+			if(!readCbor(pos, end, out[name.asString()], depth + 1))
+				return false;
+		}
+		return true;
+
+	case 6: //A tag, we do not need its meaning so just read what it wraps
+		return readCbor(pos, end, out, depth + 1);
+
+	case 7:
+		switch(additional)
+		{
+		case 20:	out = false;				return true;
+		case 21:	out = true;					return true;
+		case 22:
+		case 23:	out = Json::nullValue;		return true;
+		case 26:
+		{
+			uint32_t	bits = uint32_t(argument);
+			float		f;
+			memcpy(&f, &bits, sizeof(f));
+			out = double(f);
+			return true;
+		}
+		case 27:
+		{
+			double d;
+			memcpy(&d, &argument, sizeof(d));
+			out = d;
+			return true;
+		}
+		default:
+			return false;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,37 @@
+#ifndef MESSAGECODEC_H
+#define MESSAGECODEC_H
+
+#include <json/json.h>
+#include <string>
+#include <atomic>
+
+///
+/// Turns the Json::Value messages between Engine and Desktop into what goes through the IPCChannel, and back again.
+/// Json is written compactly instead of styled, and the jsoncpp writer and reader are built once per thread instead of for every message.
+/// Setting the environment variable JASP_IPC_BINARY (the engines inherit it from Desktop) makes encode() write CBOR (RFC 8949) instead.
+/// That is prefixed with the CBOR self-describe tag so that decode() can always tell which of the two it got, the receiving side never needs to be told.
+class MessageCodec
+{
+public:
+	static std::string	encode(			const Json::Value & msg);	///< Json or CBOR depending on binary()
+	static std::string	encodeJson(		const Json::Value & msg);
+	static std::string	encodeBinary(	const Json::Value & msg);
+
+	static bool			decode(			const std::string & msg,				Json::Value & out, std::string * error = nullptr);
+	static bool			decode(			const char * begin, const char * end,	Json::Value & out, std::string * error = nullptr);
+	static bool			isBinary(		const char * begin, const char * end);
+
+	static bool			binary()					{ return _binary;		}
+	static void			setBinary(bool binary)		{ _binary = binary;		}
+
+private:
+	MessageCodec() {}
+
+	static void			writeCborHead(	unsigned char major, uint64_t argument,					std::string & out);
+	static void			writeCbor(		const Json::Value & value,								std::string & out);
+	static bool			readCbor(		const unsigned char *& pos, const unsigned char * end,	Json::Value & out, int depth);
+
+	static std::atomic<bool>	_binary;
+};
+
+#endif // MESSAGECODEC_H
@@ -0,0 +1,158 @@
+#include "multireplacer.h"
+#include <algorithm>
+
+void MultiReplacer::set(const strstrmap & replacements)
+{
+	_nodes.assign(1, node());
+	_replaceWith.clear();
+
+	for(const auto & fromTo : replacements)
+	{
+		if(fromTo.first == "")
+			continue;
+
+		int state = 0;
+
+		for(unsigned char c : fromTo.first)
+		{
+			int found = child(state, c);
+
+			if(found == -1)
+			{
+				found = _nodes.size();
+				_nodes.push_back(node());
+				_nodes[found].depth = _nodes[state].depth + 1;
+
+				auto & next = _nodes[state].next;
+				next.insert(std::lower_bound(next.begin(), next.end(), std::make_pair(c, 0)), std::make_pair(c, found));
+			}
+
+			state = found;
+		}
+
+		_nodes[state].pattern = _replaceWith.size();
+		_replaceWith.push_back(fromTo.second);
+	}
+
+	for(int c=0; c<256; c++)
+		_rootNext[c] = std::max(0, child(0, c));
+
+	//Breadth first, so the fail of every shallower node is known by the time we need it
+	std::vector<int> queue;
+
+	for(const auto & edge : _nodes[0].next)
+		queue.push_back(edge.second);
+
+	for(size_t q=0; q<queue.size(); q++)
+	{
+		node & current		= _nodes[queue[q]];
+		current.output		= _nodes[current.fail].pattern != -1 ? current.fail : _nodes[current.fail].output;
+
+		for(const auto & edge : current.next)
+		{
+			_nodes[edge.second].fail = step(current.fail, edge.first); //The children of the root are left at 0, because the root is never in the queue
+			queue.push_back(edge.second);
+		}
+	}
+}
+
+int MultiReplacer::child(int state, unsigned char c) const
+{
+	const auto & next	= _nodes[state].next;
+	auto		 found	= std::lower_bound(next.begin(), next.end(), std::make_pair(c, 0));
+
+	return found != next.end() && found->first == c ? found->second : -1;
+}
+
+int MultiReplacer::step(int state, unsigned char c) const
+{
+	for(;;)
+	{
+		if(state == 0)
+			return _rootNext[c];
+
+		int next = child(state, c);
+
+		if(next != -1)
+			return next;
+
+		state = _nodes[state].fail;
+	}
+}
+
+bool MultiReplacer::contains(std::string_view text) const
+{
+	if(empty())
+		return false;
+
+	int state = 0;
+
+	for(char c : text)
+	{
+		state = step(state, c);
+
+		if(_nodes[state].pattern != -1 || _nodes[state].output != -1)
+			return true;
+	}
+
+	return false;
+}
+
+///Matches are only replaced once no match that starts earlier can turn up anymore, that is when the automaton no longer remembers anything from before their start.
+bool MultiReplacer::replaceAll(std::string & text) const
+{
+	if(empty())
+		return false;
+
+	struct match { size_t start, length; int pattern; };
+
+	std::vector<match>	candidates;
+	std::string			replaced;
+	size_t				copiedUpTo	= 0;
+	bool				replacedAny	= false;
+	int					state		= 0;
+
+	auto replaceFinished = [&](size_t before)
+	{
+		for(;;)
+		{
+			const match * best = nullptr;
+
+			for(const match & candidate : candidates)
+				if(candidate.start >= copiedUpTo && (!best || candidate.start < best->start || (candidate.start == best->start && candidate.length > best->length)))
+					best = &candidate;
+
+			if(!best || best->start >= before)
+				break;
+
+			replaced.append(text, copiedUpTo, best->start - copiedUpTo);
+			replaced.append(_replaceWith[best->pattern]);
+			copiedUpTo	= best->start + best->length;
+			replacedAny	= true;
+		}
+
+		candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](const match & candidate) { return candidate.start < copiedUpTo; }), candidates.end());
+	};
+
+	for(size_t i=0; i<text.size(); i++)
+	{
+		state = step(state, text[i]);
+
+		for(int found = _nodes[state].pattern != -1 ? state : _nodes[state].output; found != -1; found = _nodes[found].output)
+			if(i + 1 - _nodes[found].depth >= copiedUpTo)
+				candidates.push_back({ i + 1 - _nodes[found].depth, size_t(_nodes[found].depth), _nodes[found].pattern });
+
+		if(candidates.size())
+			replaceFinished(i + 1 - _nodes[state].depth);
+	}
+
+	replaceFinished(text.size() + 1);
+
+	if(!replacedAny)
+		return false;
+
+	replaced.append(text, copiedUpTo, std::string::npos);
+	text = std::move(replaced);
+
+	return true;
+}
@@ -0,0 +1,41 @@
+#ifndef MULTIREPLACER_H
+#define MULTIREPLACER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "utils.h"
+
+/// Replaces a whole set of strings in a text in a single pass, no matter how many there are to look for.
+/// It is an Aho-Corasick automaton built once from the map of what to replace with what, so use it when the same set is applied to a lot of text.
+/// For instance to decode all encoded column names in the results of an analysis, where looking for each name separately costs as many passes over the results as there are columns.
+/// Where matches overlap the one that starts first wins, and of those the longest.
+class MultiReplacer
+{
+public:
+							MultiReplacer(const strstrmap & replacements = {}) { set(replacements); }
+
+	void					set(const strstrmap & replacements);							///< Rebuilds the automaton
+	bool					empty()											const { return _replaceWith.size() == 0; }
+	bool					replaceAll(std::string & text)					const;			///< Returns whether something was replaced, text is not touched otherwise
+	bool					contains(std::string_view text)					const;
+
+private:
+	struct node
+	{
+		std::vector<std::pair<unsigned char, int>>	next;					///< Sorted on character
+		int											fail		= 0,		///< Longest proper suffix that is also in the trie
+													output		= -1,		///< Nearest node along fail that ends a pattern, to find all matches ending here
+													pattern		= -1,		///< Index in _replaceWith if a pattern ends here
+													depth		= 0;
+	};
+
+	int						child(int state, unsigned char c)				const;
+	int						step(int state, unsigned char c)				const;
+
+	std::vector<node>			_nodes;
+	stringvec					_replaceWith;
+	int							_rootNext[256];										///< The root has an edge for every character, the other nodes only for those that lead somewhere
+};
+
+#endif // MULTIREPLACER_H
@@ -185,6 +185,8 @@ void Analyses::clear()
 
 	_analysisMap.clear();
 	_orderedIds.clear();
+	_plotRenderCache.clear();
+	_plotsOutdated.clear();
 
 	_nextId = 0;
 	endResetModel();
@@ -271,6 +273,8 @@ void Analyses::removeAnalysis(Analysis *analysis)
 
 	beginRemoveRows(QModelIndex(), indexAnalysis, indexAnalysis);
 	analysis->remove();
+	_plotRenderCache.forget(id);
+	_plotsOutdated.erase(id);
 	_analysisMap.erase(id);
 	_orderedIds.erase(_orderedIds.begin() + indexAnalysis);
 	for (int requestId : toRemove)
@@ -353,9 +357,85 @@ void Analyses::refreshAllAnalyses()
 
 void Analyses::refreshAllPlots(std::set<Analysis*> exceptThese)
 {
+	JASPTIMER_SCOPE(Analyses::refreshAllPlots);
+
 	for(auto idAnalysis : _analysisMap)
 		if(exceptThese.count(idAnalysis.second) == 0)
-			idAnalysis.second->rewriteImages();
+		{
+			Analysis * analysis = idAnalysis.second;
+
+			//Keep what it shows now, in case the user switches back
+			_plotRenderCache.store(analysis);
+
+			if(_plotRenderCache.restore(analysis))
+				_plotsOutdated.erase(analysis->id());
+
+			else if(visibleInResults(analysis))
+			{
+				_plotsOutdated.erase(analysis->id());
+				analysis->rewriteImages();
+			}
+			else
+				_plotsOutdated.insert(analysis->id());
+		}
+
+	rewriteOutdatedPlots();
+}
+
+bool Analyses::visibleInResults(Analysis * analysis) const
+{
+	return !_visibilityKnown || _visibleInResults.count(analysis->id());
+}
+
+///The results page sends the ids of the analyses it shows (partially) whenever it scrolls or changes size
+void Analyses::analysesVisibleInResults(QString json)
+{
+	Json::Value ids;
+	Json::Reader().parse(fq(json), ids);
+
+	_visibleInResults.clear();
+	for(const Json::Value & id : ids)
+		_visibleInResults.insert(id.asUInt64());
+
+	_visibilityKnown = true;
+
+	rewriteOutdatedPlots();
+}
+
+///Visible analyses get their images rewritten straightaway, the rest one at a time per module so that each module engine always has something to do without visible ones getting stuck behind them
+void Analyses::rewriteOutdatedPlots()
+{
+	std::set<std::string> busyModules;
+
+	for(auto idAnalysis : _analysisMap)
+		if(idAnalysis.second->isRewriteImgs() || idAnalysis.second->isRunningImg())
+			busyModules.insert(idAnalysis.second->module());
+
+	for(size_t id : std::set<size_t>(_plotsOutdated))
+	{
+		Analysis * analysis = get(id);
+
+		if(!analysis || !analysis->isFinished() || analysis->isErrorState()) //It is either gone or will get new plots anyway
+		{
+			_plotsOutdated.erase(id);
+			continue;
+		}
+
+		if(visibleInResults(analysis) || !busyModules.count(analysis->module()))
+		{
+			_plotsOutdated.erase(id);
+			busyModules.insert(analysis->module());
+			analysis->rewriteImages();
+		}
+	}
+}
+
+void Analyses::plotsRendered(Analysis * analysis, bool newResults)
+{
+	_plotsOutdated.erase(analysis->id());
+	_plotRenderCache.rendered(analysis, newResults);
+
+	rewriteOutdatedPlots();
 }
 
 void Analyses::removeAnalysisById(size_t id)
@@ -409,6 +489,8 @@ void Analyses::loadAnalysesFromDatasetPackage(bool & errorFound, stringstream &
 
 			JASPTIMER_START(Analyses::loadAnalysesFromDatasetPackage f-o-r analysisData in analysesDataList);
 
+			Upgrader::upgrader()->preUpgradeAnalysesData(analysesDataList);
+
 			Log::log() << "Loading analyses from jasp-file, entering loop." << std::endl;
 			
 			//There is no point trying to show progress here because qml is not updated while this function runs...
@@ -442,6 +524,8 @@ void Analyses::loadAnalysesFromDatasetPackage(bool & errorFound, stringstream &
 				}
 			}
 
+			Upgrader::upgrader()->preUpgradedClear(); //Whatever wasn't picked up should not end up on an analysis that gets the same id later
+
 			JASPTIMER_STOP(Analyses::loadAnalysesFromDatasetPackage for analysisData : analysesDataList);
 		}
 
@@ -20,6 +20,7 @@
 #define ANALYSES_H
 
 #include "analysis.h"
+#include "plotrendercache.h"
 #include "appinfo.h"
 #include "data/datasetpackage.h"
 #include "modules/upgrader/upgrader.h"
@@ -104,6 +105,8 @@ public:
 	Analysis*				getAnalysisBeforeMoving(size_t index);
 	Analysis*				createAnalysis(const QString& module, const QString& analysis);
 
+	void					plotsRendered(Analysis * analysis, bool newResults);	///< Called when an engine made new plots for analysis, either by running it or by rewriting its images
+
 public slots:
 	void removeAnalysisById(size_t id);
 	void removeAnalysis(Analysis *analysis);
@@ -137,6 +140,7 @@ public slots:
 	void moveAnalysesResults(Analysis* fromAnalysis, int index);
 	void showRSyntaxInResults(bool show);
 	void dataModeChanged(bool dataMode);
+	void analysesVisibleInResults(QString json);
 
 signals:
 	void analysesUnselected();
@@ -178,6 +182,8 @@ private:
 	void bindAnalysisHandler(Analysis* analysis);
 	void storeAnalysis(Analysis* analysis, size_t id, bool notifyAll);	
 	void _makeBackwardCompatible(RibbonModel* ribbonModel, Version& version, Json::Value& analysisData);
+	bool visibleInResults(Analysis * analysis) const;
+	void rewriteOutdatedPlots();
 
 
 private:
@@ -197,6 +203,11 @@ private:
 	bool							_visible				= false;
 	bool							_moving					= false;
 
+	PlotRenderCache					_plotRenderCache;
+	std::set<size_t>				_plotsOutdated,							///< Analyses whose images should be rewritten but aren't visible in the results yet
+									_visibleInResults;
+	bool							_visibilityKnown		= false;		///< Until the results page tells us what it shows, everything counts as visible
+
 	static int								_scriptRequestID;
 	QMap<int, QPair<Analysis*, QString> >	_scriptIDMap;
 
@@ -25,6 +25,7 @@
 #include "utilities/qutils.h"
 #include "log.h"
 #include "utils.h"
+#include "jsonutilities.h"
 #include "utilities/settings.h"
 #include "gui/preferencesmodel.h"
 #include "utilities/reporter.h"
@@ -172,6 +173,7 @@ void Analysis::setTitle(const std::string& title)
 			_title = _titleDefault;
 
 		_results["title"] = _title;
+		resultsChangedInPlace();
 
 		emit titleChanged();
 	}
@@ -192,6 +194,9 @@ void Analysis::remove()
 
 void Analysis::setResults(const Json::Value & results, Status status, const Json::Value & progress)
 {
+	//The results page only needs to hear about what changed, which is usually a lot less than the whole thing
+	_resultsPatch	= JsonUtilities::structuralDiff(_results, results);
+	_resultsRevision++;
 	_results		= results;
 	_progress		= progress;
 	_resultsMeta	= _results.get(".meta", Json::arrayValue);
@@ -263,6 +268,8 @@ void Analysis::imageEdited(const Json::Value & results)
 
 		if (_imgResults.get("resized", false).asBool() && !_imgResults.get("error", true).asBool())
 			updatePlotSize(_imgOptions["name"].asString(), _imgResults.get("width", -1).asInt(), _imgResults.get("height", -1).asInt(), _results);
+
+		resultsChangedInPlace();
 	}
 	setStatus(Analysis::Complete);
 
@@ -311,6 +318,8 @@ void Analysis::imagesRewritten(const Json::Value & results)
 	emit resultsChangedSignal(this);
 	emit imageChanged();
 
+	Analyses::analyses()->plotsRendered(this, false);
+
 }
 
 Analysis::Status Analysis::parseStatus(std::string name)
@@ -386,7 +395,7 @@ std::string Analysis::statusToString(Status status)
 	}
 }
 
-Json::Value Analysis::asJSON(bool withRSource) const
+Json::Value Analysis::asJSON(bool withRSource, bool withResults) const
 {
 	Json::Value analysisAsJson = Json::objectValue;
 
@@ -397,7 +406,8 @@ Json::Value Analysis::asJSON(bool withRSource) const
 	analysisAsJson["rfile"]			= _rfile;
 	analysisAsJson["hasReport"]		= _hasReport;
 	analysisAsJson["progress"]		= _progress;
-	analysisAsJson["results"]		= _results;
+	if (withResults)
+		analysisAsJson["results"]	= _results;
 	analysisAsJson["status"]		= statusToString(_status);
 	analysisAsJson["options"]		= boundValues();
 	analysisAsJson["userdata"]		= userData();
@@ -406,7 +416,7 @@ Json::Value Analysis::asJSON(bool withRSource) const
 	if (withRSource)
 		analysisAsJson["rSources"]	= rSources();
 
-	Log::log() << "Analysis::asJSON():\n" << analysisAsJson.toStyledString() << std::endl;
+	JASPLOG(debug, results) << "Analysis::asJSON():\n" << Log::json(analysisAsJson) << std::endl;
 
 	return analysisAsJson;
 }
@@ -692,6 +702,15 @@ void Analysis::setEditOptionsOfPlot(const std::string & uniqueName, const Json::
 {
 	if(!_setEditOptionsOfPlot(_results, uniqueName, editOptions))
 		MessageForwarder::showWarning(tr("Could not find set edit options of plot %1 so plot editing will not remember anything (if it evens works)...").arg(tq(uniqueName)));
+	else
+		resultsChangedInPlace();
+}
+
+///For changes to _results that don't go through setResults, the results page will then get the whole thing again next time
+void Analysis::resultsChangedInPlace()
+{
+	_resultsPatch = Json::nullValue;
+	_resultsRevision++;
 }
 
 bool Analysis::_setEditOptionsOfPlot(Json::Value & results, const std::string & uniqueName, const Json::Value & editOptions)
@@ -117,13 +117,15 @@ public:
 			bool				beingTranslated()						{ return _beingTranslated; };
 			void				setBeingTranslated(bool value)			{ _beingTranslated = value; };
 	const	Json::Value		&	resultsMeta()		const	override	{ return _resultsMeta;						}
+	const	Json::Value		&	resultsPatch()		const				{ return _resultsPatch;						}
+			size_t				resultsRevision()	const				{ return _resultsRevision;					}
 			void				setTitle(const std::string& title)	override;
 			void				run()						override;
 			void				refresh()					override;
 			void				reloadForm()				override;
 			void				exportResults()				override;
 			void				remove();
-			Json::Value			asJSON(bool withRSources = false)	const;
+			Json::Value			asJSON(bool withRSources = false, bool withResults = true)	const;
 			void				checkDefaultTitleFromJASPFile(	const Json::Value & analysisData);
 			void				loadResultsUserdataAndRSourcesFromJASPFile(const Json::Value & analysisData, Status status);
 			Json::Value			createAnalysisRequestJson();
@@ -211,6 +213,7 @@ private:
 	void					fitOldUserDataEtc();
 	bool					updatePlotSize(const std::string & plotName, int width, int height, Json::Value & root);
 	void					checkForRSources();
+	void					resultsChangedInPlace();
 	void					clearRSources();
 	void					initAnalysis();
 	void					setAnalysisForm(AnalysisForm	* analysisForm);
@@ -226,7 +229,9 @@ protected:
 								_imgOptions			= Json::nullValue,
 								_progress			= Json::nullValue,
 								_oldUserData		= Json::nullValue,
-								_oldMetaData		= Json::nullValue;
+								_oldMetaData		= Json::nullValue,
+								_resultsPatch		= Json::nullValue;	///< JsonUtilities::structuralDiff from _resultsRevision - 1 to _resultsRevision, null when unknown
+	size_t						_resultsRevision	= 0;
 	std::string					_preUpgraderVersion	= "0";
 
 private:
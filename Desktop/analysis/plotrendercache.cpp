@@ -0,0 +1,217 @@
+#include "plotrendercache.h"
+#include "analysis.h"
+#include "tempfiles.h"
+#include "gui/preferencesmodel.h"
+#include "utilities/qutils.h"
+#include "timers.h"
+#include "log.h"
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <functional>
+#include <algorithm>
+#include <sstream>
+#include <memory>
+
+static const size_t maxRendersPerAnalysis = 4;
+
+std::string PlotRenderCache::currentSettings()
+{
+	PreferencesModel * prefs = PreferencesModel::prefs();
+
+	return	std::to_string(prefs->plotPPI())		+ "|" +
+			fq(prefs->plotBackground())			+ "|" +
+			fq(prefs->currentThemeName())		+ "|" +
+			fq(prefs->resultFont());
+}
+
+std::string PlotRenderCache::cacheFolder()
+{
+	return TempFiles::sessionDirName() + "/plotRenderCache";
+}
+
+///A plot is an object with its file in "data" and a "width" and "height"
+static bool isPlot(const Json::Value & value)
+{
+	return value.isObject() && value.isMember("data") && value["data"].isString() && value.isMember("width") && value.isMember("height");
+}
+
+Json::Value PlotRenderCache::withoutPlotFiles(const Json::Value & results)
+{
+	Json::Value stripped = results;
+
+	std::function<void(Json::Value &)> strip = [&](Json::Value & value)
+	{
+		if(isPlot(value))
+		{
+			value.removeMember("data");
+			value.removeMember("revision");
+		}
+
+		if(value.isObject() || value.isArray())
+			for(Json::Value & child : value)
+				strip(child);
+	};
+
+	strip(stripped);
+
+	return stripped;
+}
+
+std::string PlotRenderCache::stateHash(const Json::Value & results)
+{
+	static thread_local std::unique_ptr<Json::StreamWriter> writer = []()
+	{
+		Json::StreamWriterBuilder builder;
+		builder["indentation"] = "";
+		return std::unique_ptr<Json::StreamWriter>(builder.newStreamWriter());
+	}();
+
+	std::ostringstream out;
+	writer->write(withoutPlotFiles(results), &out);
+
+	return std::to_string(std::hash<std::string>()(out.str()));
+}
+
+void PlotRenderCache::collectPlotFiles(const Json::Value & results, std::vector<std::string> & files)
+{
+	if(isPlot(results) && results["data"].asString() != "")
+		files.push_back(results["data"].asString());
+
+	if(results.isObject() || results.isArray())
+		for(const Json::Value & child : results)
+			collectPlotFiles(child, files);
+}
+
+///Gives the plots a revision R never uses, otherwise the results page might show what it has cached for the revision they had back then
+void PlotRenderCache::renumberPlots(Json::Value & results, int revision)
+{
+	if(isPlot(results) && results.isMember("revision"))
+		results["revision"] = revision;
+
+	if(results.isObject() || results.isArray())
+		for(Json::Value & child : results)
+			renumberPlots(child, revision);
+}
+
+void PlotRenderCache::rendered(Analysis * analysis, bool newResults)
+{
+	if(newResults)
+		forget(analysis->id());
+
+	_renderedWith[analysis->id()] = currentSettings();
+}
+
+void PlotRenderCache::store(Analysis * analysis)
+{
+	JASPTIMER_SCOPE(PlotRenderCache::store);
+
+	if(!_renderedWith.count(analysis->id()) || !analysis->isFinished() || analysis->isErrorState())
+		return;
+
+	const std::string	key			= _renderedWith[analysis->id()] + "|" + stateHash(analysis->results());
+	auto			&	renders		= _renders[analysis->id()];
+
+	if(renders.count(key))
+		return;
+
+	std::vector<std::string> files;
+	collectPlotFiles(analysis->results(), files);
+
+	if(files.size() == 0)
+		return;
+
+	if(renders.size() >= maxRendersPerAnalysis)
+	{
+		auto oldest = std::min_element(renders.begin(), renders.end(), [](const auto & l, const auto & r) { return l.second.stored < r.second.stored; });
+		QDir(tq(oldest->second.folder)).removeRecursively();
+		renders.erase(oldest);
+	}
+
+	render & stored	= renders[key];
+	stored.results	= analysis->results();
+	stored.stored	= _stored++;
+	stored.folder	= cacheFolder() + "/" + std::to_string(analysis->id()) + "/" + std::to_string(stored.stored);
+
+	const QString sessionDir = tq(TempFiles::sessionDirName());
+
+	for(const std::string & file : files)
+	{
+		QString from	= sessionDir		+ "/" + tq(file),
+				to		= tq(stored.folder)	+ "/" + tq(file);
+
+		QDir().mkpath(QFileInfo(to).absolutePath());
+
+		if(!QFile::copy(from, to))
+		{
+			Log::log() << "PlotRenderCache could not copy " << fq(from) << " so the plots of analysis " << analysis->id() << " are not cached." << std::endl;
+			QDir(tq(stored.folder)).removeRecursively();
+			renders.erase(key);
+			return;
+		}
+	}
+}
+
+bool PlotRenderCache::restore(Analysis * analysis)
+{
+	JASPTIMER_SCOPE(PlotRenderCache::restore);
+
+	auto rendersIt = _renders.find(analysis->id());
+
+	if(rendersIt == _renders.end())
+		return false;
+
+	const std::string	key		= currentSettings() + "|" + stateHash(analysis->results());
+	auto				found	= rendersIt->second.find(key);
+
+	if(found == rendersIt->second.end())
+		return false;
+
+	std::vector<std::string> files;
+	collectPlotFiles(found->second.results, files);
+
+	const QString sessionDir = tq(TempFiles::sessionDirName());
+
+	for(const std::string & file : files)
+	{
+		QString from	= tq(found->second.folder)	+ "/" + tq(file),
+				to		= sessionDir				+ "/" + tq(file);
+
+		QDir().mkpath(QFileInfo(to).absolutePath());
+		QFile::remove(to);
+
+		if(!QFile::copy(from, to))
+		{
+			Log::log() << "PlotRenderCache could not restore " << fq(to) << " so analysis " << analysis->id() << " will rewrite its images after all." << std::endl;
+			return false;
+		}
+	}
+
+	Json::Value results = found->second.results;
+	renumberPlots(results, -(++_restored));
+
+	Log::log() << "Plots of analysis " << analysis->id() << " restored from the render cache." << std::endl;
+
+	_renderedWith[analysis->id()] = currentSettings();
+	analysis->imagesRewritten(results);
+
+	return true;
+}
+
+void PlotRenderCache::forget(size_t analysisId)
+{
+	if(_renders.count(analysisId))
+		QDir(tq(cacheFolder() + "/" + std::to_string(analysisId))).removeRecursively();
+
+	_renders		.erase(analysisId);
+	_renderedWith	.erase(analysisId);
+}
+
+void PlotRenderCache::clear()
+{
+	if(_renders.size())
+		QDir(tq(cacheFolder())).removeRecursively();
+
+	_renders		.clear();
+	_renderedWith	.clear();
+}
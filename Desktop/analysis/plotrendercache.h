@@ -0,0 +1,47 @@
+#ifndef PLOTRENDERCACHE_H
+#define PLOTRENDERCACHE_H
+
+#include <json/json.h>
+#include <string>
+#include <vector>
+#include <map>
+
+class Analysis;
+
+///
+/// Keeps the plots of an analysis as they were rendered for earlier settings, so that going back to those settings doesn't need an engine.
+/// Changing the PPI, image background or result font makes Analyses::refreshAllPlots ask every analysis to rewrite its images, which renders all of them again in R.
+/// Before that happens the current plot files are copied into the session folder under a key of the settings they were made with and a hash of the state of the analysis (its results without the plot files, so sizes and edits are part of it).
+/// If an analysis is then asked to rewrite for settings we have already seen for the same state, `restore` copies the files back and gives the results the engine gave back then.
+class PlotRenderCache
+{
+public:
+	static std::string	currentSettings();											///< ppi, background, theme and font as they are now
+
+	void				rendered(Analysis * analysis, bool newResults);				///< An engine just made the plots of analysis with the current settings, newResults means a run and not just a rewrite
+	void				store(Analysis * analysis);									///< Copies the plots of analysis as they are now, if we know what settings they were made with
+	bool				restore(Analysis * analysis);								///< Puts back the plots of analysis for the current settings if we have them
+	void				forget(size_t analysisId);
+	void				clear();
+
+private:
+	struct render
+	{
+		Json::Value		results;
+		std::string		folder;
+		size_t			stored;		///< To know which is the oldest
+	};
+
+	static std::string	stateHash(const Json::Value & results);
+	static Json::Value	withoutPlotFiles(const Json::Value & results);
+	static void			collectPlotFiles(const Json::Value & results, std::vector<std::string> & files);
+	static void			renumberPlots(Json::Value & results, int revision);
+	static std::string	cacheFolder();
+
+	std::map<size_t, std::string>							_renderedWith;		///< analysisId -> settings the plots it shows now were made with
+	std::map<size_t, std::map<std::string, render>>			_renders;			///< analysisId -> settings + state hash -> render
+	size_t													_stored		= 0;
+	int														_restored	= 0;
+};
+
+#endif // PLOTRENDERCACHE_H
@@ -36,7 +36,7 @@ Window
 		delegate:	Item
 		{
 
-			height:			150 * jaspTheme.uiScale
+			height:			175 * jaspTheme.uiScale
 			width:			ListView.view.width
 
 			Rectangle
@@ -51,7 +51,7 @@ Window
 
 				Text
 				{
-					text:				model.display + "\nState: " + model.engineState + "\nModule: " + model.module + (model.analysisStatus === "NA" ? "" : "\nAnalysis Status: " + model.analysisStatus)
+					text:				model.display + "\nState: " + model.engineState + "\nModule: " + model.module + (model.analysisStatus === "NA" ? "" : "\nAnalysis Status: " + model.analysisStatus) + "\nMemory: " + model.memory + (model.analysesHeld > 0 ? " holding " + model.analysesHeld + " analyses" : "")
 					font.pixelSize:		20 * jaspTheme.uiScale
 					font.bold:			true
 					anchors
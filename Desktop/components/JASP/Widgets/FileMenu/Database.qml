@@ -322,11 +322,57 @@ For a local or toy database this is probably overkill, but use your own judgemen
                     id:						runQuery
                     text:					qsTr("Execute")
                     onClicked:				fileMenuModel.database.runQuery();
-                    KeyNavigation.tab:		loadResults
+                    KeyNavigation.tab:		dbSyncKey.textInput
 					activeFocusOnTab:		true
                 }
             }
 
+            RowLayout
+            {
+                width:						parent.width
+
+                enabled:					fileMenuModel.database.connected
+
+                Text
+                {
+                    id:						dbSyncKeyLabel
+                    text:					qsTr("Row key column")
+                    width:					implicitWidth + jaspTheme.generalAnchorMargin
+                }
+
+                PrefsTextInput
+                {
+                    id:						dbSyncKey
+                    nextEl:					dbSyncModified.textInput
+                    text:					fileMenuModel.database.syncKey
+					onEditingFinished:		fileMenuModel.database.syncKey = text
+                    LQ.Layout.fillWidth:	true
+                }
+            }
+
+            RowLayout
+            {
+                width:						parent.width
+
+                enabled:					fileMenuModel.database.connected && fileMenuModel.database.syncKey !== ""
+
+                Text
+                {
+                    id:						dbSyncModifiedLabel
+                    text:					qsTr("Last modified column")
+                    width:					implicitWidth + jaspTheme.generalAnchorMargin
+                }
+
+                PrefsTextInput
+                {
+                    id:						dbSyncModified
+                    nextEl:					loadResults
+                    text:					fileMenuModel.database.syncModified
+					onEditingFinished:		fileMenuModel.database.syncModified = text
+                    LQ.Layout.fillWidth:	true
+                }
+            }
+
         }
 
         PrefsGroupRect
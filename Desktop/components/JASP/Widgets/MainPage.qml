@@ -399,6 +399,7 @@ Item
 			{
 				target:		resultsJsInterface
 				function onRunJavaScriptSignal(js)			{ resultsView.runJavaScript(js); }
+				function onAnalysisResultsPatched(patch)	{ resultsJsInterfaceInterface.analysisResultsPatched(patch); }
 				function onScrollAtAllChanged(scrollAtAll)	{ resultsView.runJavaScript("window.setScrollAtAll("+(scrollAtAll ? "true" : "false")+")"); }
 
 				function onExportToPDF(pdfPath)
@@ -458,6 +459,8 @@ Item
 
 				property bool reportingVisible: preferencesModel.reportingMode
 
+				signal analysisResultsPatched(string patch)
+
 				onReportingVisibleChanged: mainWindow.reloadResults()
 
 				// Yeah I know this "resultsJsInterfaceInterface" looks a bit stupid but this honestly seems like the best way to make the current resultsJsInterface functions available to javascript without rewriting (more of) the structure of Desktop right now.
@@ -484,6 +487,7 @@ Item
 				function duplicateAnalysis(id)						{ resultsJsInterface.duplicateAnalysis(id)						}
 				function showDependenciesInAnalysis(id, optName)	{ resultsJsInterface.showDependenciesInAnalysis(id, optName)	}
 				function showRSyntaxInResults(show)					{ resultsJsInterface.showRSyntaxInResults(show)					}
+				function analysisResultsPatchFailed(id)				{ resultsJsInterface.analysisResultsPatchFailed(id)				}
 
 				function showAnalysesMenu(options)
 				{
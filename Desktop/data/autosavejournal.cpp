@@ -0,0 +1,336 @@
+#include "autosavejournal.h"
+#include "datasetpackage.h"
+#include "databaseinterface.h"
+#include "analysis/analyses.h"
+#include "utilities/qutils.h"
+#include "tempfiles.h"
+#include "appinfo.h"
+#include "timers.h"
+#include "utils.h"
+#include "dirs.h"
+#include "log.h"
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+
+static const int		flushInterval		= 5000;				///< ms
+static const long		staleAfter			= 10;				///< seconds without heartbeat before a session is considered dead, TempFiles::heartbeat runs many times a second
+static const size_t		checkpointAbove		= 4 * 1024 * 1024;	///< Never checkpoint a journal smaller than this
+static const char	*	journalPostfix		= TempFiles::journalPostfix;
+
+AutosaveJournal::AutosaveJournal(QObject * parent)
+	: QObject(parent), _path(TempFiles::sessionDirName() + journalPostfix)
+{
+	Analyses		* analyses	= Analyses::analyses();
+	DataSetPackage	* pkg		= DataSetPackage::pkg();
+
+	connect(analyses,	&Analyses::analysisAdded,				this,	&AutosaveJournal::analysisAdded			);
+	connect(analyses,	&Analyses::analysisRemoved,				this,	&AutosaveJournal::analysisRemoved		);
+	connect(analyses,	&Analyses::analysisResultsChanged,		this,	&AutosaveJournal::analysisChanged		);
+	connect(analyses,	&Analyses::analysisTitleChanged,		this,	&AutosaveJournal::analysisChanged		);
+	connect(analyses,	&Analyses::analysisOverwriteUserdata,	this,	&AutosaveJournal::analysisChanged		);
+	connect(analyses,	&Analyses::analysisImageEdited,			this,	&AutosaveJournal::analysisChanged		);
+
+	connect(pkg,		&DataSetPackage::datasetChanged,		this,	[this](QStringList changed, QStringList missing, QMap<QString, QString> changeName, bool, bool)
+	{
+		columnsChanged(changed);
+		columnsChanged(missing);
+		columnsChanged(changeName.values());
+	});
+	connect(pkg,		&DataSetPackage::labelChanged,			this,	[this](QString columnName) { columnsChanged({columnName}); });
+	connect(pkg,		&DataSetPackage::columnDataTypeChanged,	this,	[this](QString columnName) { columnsChanged({columnName}); });
+
+	connect(&_timer,	&QTimer::timeout,						this,	&AutosaveJournal::flush					);
+
+	_timer.start(flushInterval);
+}
+
+AutosaveJournal::~AutosaveJournal()
+{
+	if(_writing.valid())
+		_writing.wait();
+}
+
+void AutosaveJournal::discard()
+{
+	_timer.stop();
+
+	if(_writing.valid())
+		_writing.wait();
+
+	std::error_code error;
+	std::filesystem::remove(Utils::osPath(_path), error);
+}
+
+void AutosaveJournal::analysisAdded(Analysis * analysis)
+{
+	const size_t id = analysis->id();
+
+	connect(analysis, &Analysis::optionsChanged, this, [this, id]() { _analysesChanged.insert(id); });
+
+	_analysesRemoved.erase(id);
+	_analysesChanged.insert(id);
+}
+
+void AutosaveJournal::analysisChanged(Analysis * analysis)
+{
+	_analysesChanged.insert(analysis->id());
+}
+
+void AutosaveJournal::analysisRemoved(Analysis * analysis)
+{
+	_analysesChanged.erase(analysis->id());
+	_analysesRemoved.insert(analysis->id());
+}
+
+void AutosaveJournal::columnsChanged(const QStringList & columns)
+{
+	for(const QString & column : columns)
+		_columnsChanged.insert(fq(column));
+}
+
+std::string AutosaveJournal::workspaceRecord() const
+{
+	DataSetPackage	* pkg		= DataSetPackage::pkg();
+	Json::Value		  record	= Json::objectValue;
+
+	record["journal"]	= "workspace";
+	record["file"]		= fq(pkg->currentFile());
+	record["data"]		= pkg->dataSet() && pkg->dataSet()->columnCount() > 0;
+
+	return Json::FastWriter().write(record);
+}
+
+std::string AutosaveJournal::analysisRecord(Analysis * analysis) const
+{
+	Json::Value record	= Json::objectValue;
+	record["journal"]	= "analysis";
+	record["analysis"]	= analysis->asJSON(true);
+
+	return Json::FastWriter().write(record);
+}
+
+///Everything is serialized here, on the GUI thread where the analyses live, but only the ones that changed. Writing it to disk happens on another thread.
+void AutosaveJournal::flush()
+{
+	if(_writing.valid())
+	{
+		if(_writing.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return; //Still busy with the previous flush, whatever changed since stays marked for the next one
+
+		std::string error = _writing.get();
+
+		if(error != "")
+		{
+			Log::log() << "AutosaveJournal could not write '" << _path << "': " << error << std::endl;
+			_checkpointNext = true; //Those records are missing now, so write everything again
+		}
+	}
+
+	Analyses			*	analyses	= Analyses::analyses();
+	std::vector<size_t>		order;
+	analyses->applyToAll([&](Analysis * analysis) { order.push_back(analysis->id()); });
+
+	const std::string		workspace	= workspaceRecord();
+	const Json::Value		meta		= analyses->resultsMeta();
+
+	if(!_checkpointNext && _analysesChanged.empty() && _analysesRemoved.empty() && _columnsChanged.empty() && order == _orderWritten && meta == _metaWritten && workspace == _workspaceWritten)
+		return;
+
+	JASPTIMER_SCOPE(AutosaveJournal::flush);
+
+	std::string records;
+
+	if(workspace != _workspaceWritten || _checkpointNext)
+		records += workspace;
+
+	if(_checkpointNext) //Everything as it is now, without the history of how it got there
+	{
+		analyses->applyToAll([&](Analysis * analysis) { records += analysisRecord(analysis); });
+
+		_analysesRemoved.clear();
+		_columnsChanged.clear(); //Which columns were edited is only for the log after recovering, the data is in internal.sqlite
+	}
+	else
+	{
+		for(size_t id : _analysesRemoved)
+		{
+			Json::Value record	= Json::objectValue;
+			record["journal"]	= "removed";
+			record["id"]		= Json::UInt64(id);
+			records += Json::FastWriter().write(record);
+		}
+
+		for(size_t id : _analysesChanged)
+			if(Analysis * analysis = analyses->get(id))
+				records += analysisRecord(analysis);
+	}
+
+	if(_columnsChanged.size())
+	{
+		Json::Value record	= Json::objectValue,
+					columns	= Json::arrayValue;
+
+		for(const std::string & column : _columnsChanged)
+			columns.append(column);
+
+		record["journal"]	= "columns";
+		record["columns"]	= columns;
+		records += Json::FastWriter().write(record);
+	}
+
+	if(order != _orderWritten || _checkpointNext)
+	{
+		Json::Value record	= Json::objectValue,
+					ids		= Json::arrayValue;
+
+		for(size_t id : order)
+			ids.append(Json::UInt64(id));
+
+		record["journal"]	= "order";
+		record["ids"]		= ids;
+		records += Json::FastWriter().write(record);
+	}
+
+	if(meta != _metaWritten || _checkpointNext)
+	{
+		Json::Value record	= Json::objectValue;
+		record["journal"]	= "meta";
+		record["meta"]		= meta;
+		records += Json::FastWriter().write(record);
+	}
+
+	const bool checkpoint	= _checkpointNext;
+
+	_bytesWritten			= (checkpoint ? 0 : _bytesWritten) + records.size();
+	_bytesCheckpointed		= checkpoint ? _bytesWritten : _bytesCheckpointed;
+	_checkpointNext			= _bytesWritten > std::max(checkpointAbove, 4 * _bytesCheckpointed);
+
+	_analysesChanged	.clear();
+	_analysesRemoved	.clear();
+	_columnsChanged		.clear();
+	_orderWritten		= order;
+	_metaWritten		= meta;
+	_workspaceWritten	= workspace;
+
+	write(std::move(records), checkpoint);
+}
+
+///Appends, or for a checkpoint writes a new journal next to it and moves that over the old one, so a crash halfway leaves either of them intact
+void AutosaveJournal::write(std::string records, bool replace)
+{
+	_writing = std::async(std::launch::async, [path = _path, records = std::move(records), replace]() -> std::string
+	{
+		const std::string target = replace ? path + ".tmp" : path;
+
+		std::ofstream journal(Utils::osPath(target), std::ios::binary | (replace ? std::ios::trunc : std::ios::app));
+		journal << records;
+		journal.close();
+
+		if(!journal)
+			return "writing '" + target + "' failed";
+
+		std::error_code error;
+
+		if(replace)
+			std::filesystem::rename(Utils::osPath(target), Utils::osPath(path), error);
+
+		return error ? error.message() : "";
+	});
+}
+
+std::string AutosaveJournal::sessionDirOf(const std::string & journalFile)
+{
+	return journalFile.substr(0, journalFile.size() - std::string(journalPostfix).size());
+}
+
+std::string AutosaveJournal::crashedJournal()
+{
+	std::error_code				error;
+	std::filesystem::path		tempPath	= Utils::osPath(Dirs::tempDir());
+	std::filesystem::path		ours		= Utils::osPath(TempFiles::sessionDirName() + journalPostfix);
+	std::string					newest;
+	long						newestTime	= 0;
+
+	for(std::filesystem::directory_iterator itr(tempPath, error); !error && itr != std::filesystem::directory_iterator(); itr.increment(error))
+	{
+		const std::string journalFile = Utils::osPath(itr->path());
+
+		if(itr->path().extension() != journalPostfix || itr->path().filename() == ours.filename())
+			continue;
+
+		std::filesystem::path statusFile = Utils::osPath(sessionDirOf(journalFile) + "/status");
+
+		//A session that is still running keeps touching its status file, see TempFiles::heartbeat
+		if(std::filesystem::exists(statusFile, error) && Utils::currentSeconds() - Utils::getFileModificationTime(Utils::osPath(statusFile)) < staleAfter)
+			continue;
+
+		long modified = Utils::getFileModificationTime(journalFile);
+
+		if(modified > newestTime)
+		{
+			newestTime	= modified;
+			newest		= journalFile;
+		}
+	}
+
+	return newest;
+}
+
+///Takes over the data and the resources of the crashed session and sets its analyses on DataSetPackage, like JASPImporter::loadDataSet does for a jasp-file.
+///The data is restored into the open database instead of copying the file over it, so neither Desktop nor the engines keep stale pages of what was there.
+AutosaveJournal::Replayed AutosaveJournal::recover(const std::string & journalFile)
+{
+	JASPTIMER_SCOPE(AutosaveJournal::recover);
+
+	Replayed				replayed	= replay(journalFile);
+	const std::string		crashedDir	= sessionDirOf(journalFile);
+	DataSetPackage		*	pkg			= DataSetPackage::pkg();
+	DatabaseInterface	*	db			= DatabaseInterface::singleton();
+	std::error_code			error;
+
+	Log::log() << "Recovering " << replayed.analysesData["analyses"].size() << " analyses" << (replayed.hasData ? " and the data" : "") << " of '" << crashedDir << "' from " << replayed.records << " journal records, " << replayed.columnsEdited.size() << " columns were edited." << std::endl;
+
+	const std::string crashedDb = crashedDir + "/" + db->dbFile(true);
+
+	if(replayed.hasData && !std::filesystem::exists(Utils::osPath(crashedDb), error))
+		throw std::runtime_error("The data of the crashed session is gone, JASP only keeps it for a day.");
+
+	if(replayed.hasData && !pkg->dataSet())
+		pkg->createDataSet();
+
+	pkg->beginLoadingData();
+
+	if(replayed.hasData)
+	{
+		try
+		{
+			db->restoreFrom(crashedDb); //sqlite applies the write-ahead log next to it, so the latest edits are in there as well
+		}
+		catch(std::runtime_error & e)
+		{
+			throw std::runtime_error(std::string("Could not restore the data of the crashed session: ") + e.what());
+		}
+
+		pkg->setJaspVersion(AppInfo::version); //It was written by this version of JASP, so no upgrades please
+		pkg->loadDataSet([](float){});
+	}
+
+	std::filesystem::copy(Utils::osPath(crashedDir + "/resources"), Utils::osPath(TempFiles::sessionDirName() + "/resources"), std::filesystem::copy_options::recursive | std::filesystem::copy_options::overwrite_existing, error);
+
+	if(error)
+		Log::log() << "Could not copy the resources of the crashed session, the analyses will have to run again: " << error.message() << std::endl;
+
+	pkg->setAnalysesData(replayed.analysesData);
+	pkg->endLoadingData();
+
+	return replayed;
+}
+
+void AutosaveJournal::discardCrashed(const std::string & journalFile)
+{
+	std::error_code error;
+
+	std::filesystem::remove_all(Utils::osPath(sessionDirOf(journalFile)),	error);
+	std::filesystem::remove(	Utils::osPath(journalFile),					error);
+}
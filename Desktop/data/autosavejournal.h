@@ -0,0 +1,67 @@
+#ifndef AUTOSAVEJOURNAL_H
+#define AUTOSAVEJOURNAL_H
+
+#include <QObject>
+#include <QTimer>
+#include <json/json.h>
+#include "journalreplay.h"
+#include <future>
+#include <string>
+#include <vector>
+#include <set>
+
+class Analysis;
+
+///
+/// Keeps a journal of what changed in the workspace, so that whatever was done since the last save can be recovered after JASP crashed.
+/// The data itself is not in it, every edit already ends up in internal.sqlite in the session folder and that stays behind after a crash.
+/// What only lives in memory are the analyses (options, results and userdata) and which file was opened, so those are appended to "<sessionfolder>.journal" next to it.
+/// TempFiles::deleteOrphans removes that journal together with its session folder.
+/// Every few seconds only the analyses that changed since the last time are written, one compact json record per line and on a separate thread.
+/// Once the journal grows well beyond what it would take to write the whole workspace it is checkpointed: replaced by a single record per analysis.
+/// A clean exit removes the journal, so one found for a session that is no longer alive means JASP crashed and `recover` can replay it, see JournalReplay.
+class AutosaveJournal : public QObject
+{
+	Q_OBJECT
+
+public:
+	typedef JournalReplay Replayed;
+
+	explicit					AutosaveJournal(QObject * parent);
+								~AutosaveJournal();
+
+	void						discard();												///< For a clean exit, there is nothing to recover then
+
+	static std::string			crashedJournal();										///< The newest journal of a session that is no longer alive, or "" if there is none
+	static Replayed				replay(const std::string & journalFile) { return JournalReplay::replay(journalFile); }
+	static Replayed				recover(const std::string & journalFile);				///< Loads the data and analyses of the crashed session into DataSetPackage, like an importer would
+	static void					discardCrashed(const std::string & journalFile);		///< Removes the journal and whatever is left of its session folder
+
+private slots:
+	void						analysisAdded(Analysis * analysis);
+	void						analysisChanged(Analysis * analysis);
+	void						analysisRemoved(Analysis * analysis);
+	void						columnsChanged(const QStringList & columns);
+	void						flush();
+
+private:
+	static std::string			sessionDirOf(const std::string & journalFile);
+	std::string					workspaceRecord()	const;
+	std::string					analysisRecord(Analysis * analysis)	const;
+	void						write(std::string records, bool replace);
+
+	std::string					_path;
+	QTimer						_timer;
+	std::future<std::string>	_writing;											///< What went wrong while writing, if anything
+	std::set<size_t>			_analysesChanged,
+								_analysesRemoved;
+	std::set<std::string>		_columnsChanged;
+	std::vector<size_t>			_orderWritten;
+	Json::Value					_metaWritten		= Json::nullValue;
+	std::string					_workspaceWritten;
+	size_t						_bytesWritten		= 0,
+								_bytesCheckpointed	= 0;							///< Size of the journal right after its last checkpoint
+	bool						_checkpointNext		= true;							///< Starts with one, a journal left by an earlier process with the same id would otherwise be appended to
+};
+
+#endif // AUTOSAVEJOURNAL_H
@@ -2,6 +2,7 @@
 #include "utilities/qutils.h"
 #include <QSqlDatabase>
 #include <QSqlError>
+#include <QSqlDriver>
 #include "log.h"
 
 Json::Value DatabaseConnectionInfo::toJson(bool forJaspFile) const
@@ -17,6 +18,8 @@ Json::Value DatabaseConnectionInfo::toJson(bool forJaspFile) const
 	out["database"]		= fq(_database);
 	out["hostname"]		= fq(_hostname);
 	out["query"]		= fq(_query);
+	out["syncKey"]		= fq(_syncKey);
+	out["syncModified"]	= fq(_syncModified);
 	out["port"]			= _port;
 	out["interval"]		= _interval;
 	out["rememberMe"]	= _rememberMe;
@@ -35,6 +38,8 @@ void DatabaseConnectionInfo::fromJson(const Json::Value & json)
 	_database		= tq(				json["database"]	.asString() )	;
 	_hostname		= tq(				json["hostname"]	.asString() )	;
 	_query			= tq(				json["query"]		.asString() )	;
+	_syncKey		= tq(				json["syncKey"]		.asString() )	;
+	_syncModified	= tq(				json["syncModified"].asString() )	;
 	_port			=					json["port"]		.asUInt()		;
 	_interval		=					json["interval"]	.asInt()		;
 	_rememberMe		=					json["rememberMe"]	.asBool()		;
@@ -73,15 +78,41 @@ QString DatabaseConnectionInfo::lastError() const
 	return QSqlDatabase::database().lastError().text();
 }
 
-QSqlQuery DatabaseConnectionInfo::runQuery() const
+///The users query without trailing semicolons, so it can be wrapped in a subquery
+static QString userQueryForSubquery(const QString & query)
+{
+	QString userQuery = query.trimmed();
+	
+	while(userQuery.endsWith(';'))
+		userQuery = userQuery.chopped(1).trimmed();
+	
+	return userQuery;
+}
+
+QSqlQuery DatabaseConnectionInfo::runQuery(const QVariant & syncWatermark) const
 {
 	if(!QSqlDatabase::database().isOpen())
 		throw std::runtime_error(fq(QObject::tr("JASP thinks it's connected to the database but the QSqlDatabase isn't opened...")));
 	
 	QSqlQuery query;
 	query.setForwardOnly(true);
-
-	if(!query.exec(_query))
+	
+	bool succeeded = false;
+	
+	if(!hasSyncKey() || !syncWatermark.isValid())
+		succeeded = query.exec(_query);
+	else
+	{
+		//Wrap the users query so the database only sends us the rows that were added or changed since the last time we looked
+		QString watermarkColumn	= QSqlDatabase::database().driver()->escapeIdentifier(syncWatermarkColumn(), QSqlDriver::FieldName);
+		
+		query.prepare(QString("SELECT * FROM (%1) jaspSync WHERE %2 > :syncWatermark").arg(userQueryForSubquery(_query)).arg(watermarkColumn));
+		query.bindValue(":syncWatermark", syncWatermark);
+		
+		succeeded = query.exec();
+	}
+
+	if(!succeeded)
 		throw std::runtime_error(fq(QObject::tr("Query failed with: '%1'").arg(query.lastError().text())));
 
 	if(!query.isSelect())
@@ -93,4 +124,18 @@ QSqlQuery DatabaseConnectionInfo::runQuery() const
 	return query;
 }
 
+qint64 DatabaseConnectionInfo::countRows() const
+{
+	if(!QSqlDatabase::database().isOpen())
+		throw std::runtime_error(fq(QObject::tr("JASP thinks it's connected to the database but the QSqlDatabase isn't opened...")));
+	
+	QSqlQuery query;
+	query.setForwardOnly(true);
+
+	if(!query.exec(QString("SELECT COUNT(*) FROM (%1) jaspSync").arg(userQueryForSubquery(_query))) || !query.next())
+		throw std::runtime_error(fq(QObject::tr("Counting the rows of the query failed with: '%1'").arg(query.lastError().text())));
+	
+	return query.value(0).toLongLong();
+}
+
 
@@ -20,7 +20,10 @@ public:
 	void		close()		const;
 	
 	QString		lastError() const;
-	QSqlQuery	runQuery()	const;
+	QSqlQuery	runQuery(const QVariant & syncWatermark = QVariant())	const; ///< If a syncKey is set and a valid watermark is given only rows with a syncWatermarkColumn bigger than the watermark are returned
+	qint64		countRows()		const;																	///< How many rows the query returns in total, without sending them
+	bool		hasSyncKey()	const { return !_syncKey.isEmpty(); }
+	QString		syncWatermarkColumn()	const { return _syncModified.isEmpty() ? _syncKey : _syncModified; }
 	
 	
 	DbType  _dbType			= DbType::NOTCHOSEN;
@@ -28,7 +31,9 @@ public:
 			_password		= "",
 			_database		= "",
 			_hostname		= "",
-			_query			= "";
+			_query			= "",
+			_syncKey		= "",	///< Optional name of a column in the query that uniquely identifies a row, like a primary key. Incremental syncing is only possible with one
+			_syncModified	= "";	///< Optional name of a column that increases whenever a row is added or changed, like a "last modified" timestamp. Without one the syncKey must be a monotonic id and only appended rows are picked up incrementally
 	int		_port			= 0,
 			_interval		= 0;
 	bool	_rememberMe		= false,
@@ -1398,6 +1398,33 @@ void DataSetPackage::createDataSet()
 	_dataSet->filter()->setRFilter(FilterModel::defaultRFilter());
 	
 	_dataSet->setModifiedCallback([&](){ setModified(true); }); //DataSet and co dont use Qt so instead we just use a callback
+	setLabelsOrderFlushScheduler();
+}
+
+///Labels added or moved one by one get their order written and their column a new revision once per turn of the eventloop, instead of once per label.
+///Only on our own thread though, the AsyncLoader is still filling labels when the eventloop comes round so it flushes right away.
+void DataSetPackage::setLabelsOrderFlushScheduler()
+{
+	_dataSet->setLabelsOrderFlushScheduler([&]()
+	{
+		if(QThread::currentThread() != thread())
+			return false;
+		
+		if(!_labelsOrderFlushScheduled)
+		{
+			_labelsOrderFlushScheduled = true;
+			
+			QTimer::singleShot(0, this, [&]()
+			{
+				_labelsOrderFlushScheduled = false;
+				
+				if(_dataSet)
+					_dataSet->labelsOrderFlush();
+			});
+		}
+		
+		return true;
+	});
 }
 
 void DataSetPackage::loadDataSet(std::function<void(float)> progressCallback)
@@ -1413,6 +1440,7 @@ void DataSetPackage::loadDataSet(std::function<void(float)> progressCallback)
 	
 	_dataSet = new DataSet(0);
 	_dataSet->dbLoad(1, progressCallback, do019Upgrade); //Right now there can only be a dataSet with ID==1 so lets keep it simple
+	setLabelsOrderFlushScheduler();
 	if (do019Upgrade)
 	{
 		// In 0.18.3 and before, there was a bug with the order of dataFilePath and description in the database.
@@ -1443,6 +1471,7 @@ void DataSetPackage::deleteDataSet()
 	delete _dataSet;
 	_dataSet = nullptr;
 	_undoStack->clear();
+	_databaseSyncWatermark = QVariant();
 }
 
 int DataSetPackage::getColIndex(QVariant colID)
@@ -1478,6 +1507,29 @@ bool DataSetPackage::initColumnWithStrings(QVariant colId, const std::string & n
 	return anyChanges || column->type() != prevType;
 }
 
+bool DataSetPackage::setColumnRowsWithStrings(const std::string & columnName, const std::vector<size_t> & rows, const stringvec & values)
+{
+	JASPTIMER_SCOPE(DataSetPackage::setColumnRowsWithStrings);
+	
+	Column	*	column		= _dataSet->column(columnName);
+	bool		anyChanges	= false;
+	
+	if(!column)
+		return false;
+	
+	column->beginBatchedLabelsDB();
+	
+	for(size_t i=0; i<rows.size(); i++)
+		anyChanges = column->setValue(rows[i], values[i], "", false) || anyChanges;
+	
+	column->endBatchedLabelsDB();
+	
+	if(anyChanges)
+		column->dbUpdateValues(false);
+	
+	return anyChanges;
+}
+
 void DataSetPackage::initializeComputedColumns()
 {
 	for(const Column * col : dataSet()->columns())
@@ -1496,14 +1548,30 @@ stringvec DataSetPackage::getColumnNames()
 	return names;
 }
 
-bool DataSetPackage::isColumnDifferentFromStringValues(const std::string & columnName, const std::string & title, const stringvec & strVals, const stringvec & strLabs, const stringset & strEmptyVals)
+bool DataSetPackage::isColumnDifferentFromContentHash(const std::string & columnName, const std::string & title, uint64_t contentHash, const stringset & strEmptyVals)
 {
 	Column * col = _dataSet->column(columnName);
 	
-	if(col)
-		return col->isColumnDifferentFromStringValues(title, strVals, strLabs, strEmptyVals);
+	if(!col)
+		return true;
+	
+	bool different = col->isColumnDifferentFromContentHash(title, contentHash, strEmptyVals);
+	col->contentHashPersist();
+	
+	return different;
+}
 
-	return true;
+uint64_t DataSetPackage::columnContentHash(const std::string & columnName)
+{
+	Column * col = _dataSet->column(columnName);
+	
+	if(!col)
+		return 0;
+	
+	uint64_t contentHash = col->contentHash();
+	col->contentHashPersist();
+	
+	return contentHash;
 }
 
 void DataSetPackage::renameColumn(const std::string & oldColumnName, const std::string & newColumnName)
@@ -2135,23 +2203,9 @@ bool DataSetPackage::insertRows(int row, int count, const QModelIndex & aparent)
 #else
 	beginInsertRows(indexForSubNode(_dataSet->dataNode()), row, row + count - 1);
 #endif
-	stringvec changed;
-
+	stringvec changed = getColumnNames();
 
-	dataSet()->beginBatchedToDB();
-
-	for(int c=0; c<dataColumnCount(); c++)
-	{
-		const std::string & name = getColumnName(c);
-		changed.push_back(name);
-
-		for(int r=row; r<row+count; r++)
-			dataSet()->column(c)->rowInsertEmptyVal(r);
-	}
-
-	dataSet()->setRowCount(dataSet()->rowCount() + count);
-	dataSet()->incRevision();
-	dataSet()->endBatchedToDB();
+	dataSet()->rowsInsert(row, count);
 #ifdef ROUGH_RESET
 	endResetModel();
 #else
@@ -2176,24 +2230,9 @@ bool DataSetPackage::removeRows(int row, int count, const QModelIndex & aparent)
 #else
 	beginRemoveRows(indexForSubNode(_dataSet->dataNode()), row, row + count - 1);
 #endif
-	stringvec changed;
-
-	dataSet()->beginBatchedToDB();
-	
-	for(Column * column : dataSet()->columns())
-	{
-		changed.push_back(column->name());
-		
-		if(row+count > column->rowCount())
-			Log::log() << "???" << std::endl;
-	
-		for(int r=row+count; r>row; r--)
-			column->rowDelete(r-1);
-	}
+	stringvec changed = getColumnNames();
 
-	dataSet()->setRowCount(dataSet()->rowCount() - count);
-	dataSet()->incRevision();
-	dataSet()->endBatchedToDB();
+	dataSet()->rowsDelete({{row, count}});
 
 	strstrmap		changeNameColumns;
 	stringvec		missingColumns;
@@ -151,6 +151,7 @@ public:
 				bool				dataFileCanHaveLabels()				const;
 				bool				isDatabase()						const	{ return _database != Json::nullValue;				}
 		const	Json::Value		&	databaseJson()						const	{ return _database;								}
+		const	QVariant		&	databaseSyncWatermark()				const	{ return _databaseSyncWatermark;				}
 		const	QString			&	analysesHTML()						const	{ return _analysesHTML;							}
 		const	Json::Value		&	analysesData()						const	{ return _analysesData;							}
 		const	std::string		&	warningMessage()					const	{ return _warningMessage;						}
@@ -173,6 +174,7 @@ public:
 				void				setWarningMessage(std::string message)				{ _warningMessage				= message;			}
 				void				setDataFilePath(std::string filePath, long timestamp = 0);
 				void				setDatabaseJson(const Json::Value & dbInfo);
+				void				setDatabaseSyncWatermark(const QVariant & mark)		{ _databaseSyncWatermark		= mark;				}
 				void				setInitialMD5(std::string initialMD5)				{ _initialMD5					= initialMD5;		}
 				void				setDataFileReadOnly(bool readOnly)					{ _dataFileReadOnly				= readOnly;			}
 				void				setAnalysesHTML(const QString & html)				{ _analysesHTML					= html;				}
@@ -187,6 +189,7 @@ public:
 				void				setDescription(const QString& description);
 				
 				bool						initColumnWithStrings(			QVariant			colId,		const std::string & newName, const stringvec	& values, const stringvec	& labels=stringvec(),	const std::string & title = "", columnType desiredType = columnType::unknown, const stringset & emptyValues = stringset());
+				bool						setColumnRowsWithStrings(		const std::string &	columnName,	const std::vector<size_t> & rows, const stringvec & values); ///< Only sets the values at the given rows, used for incremental synching
 				void						initializeComputedColumns();
 				
 				void						pasteSpreadsheet(size_t row, size_t column, const std::vector<std::vector<QString>> & values, const std::vector<std::vector<QString>> & labels, const intvec & colTypes, const QStringList & colNames, const std::vector<boolvec> & selected = {}); ///< If selected.size() >0 it is assumed to be the same size as labels/values. And it will make sure that it will only overwrite values where it is `true`
@@ -200,7 +203,8 @@ public:
 				void						columnsReorder(			const stringvec		& order);
 
 				stringvec					getColumnNames();
-				bool						isColumnDifferentFromStringValues(const std::string & columnName, const std::string & title, const stringvec & strVals, const stringvec & strLabs, const stringset & strEmptyVals);
+				bool						isColumnDifferentFromContentHash(const std::string & columnName, const std::string & title, uint64_t contentHash, const stringset & strEmptyVals);
+				uint64_t					columnContentHash(const std::string & columnName);
 				int							findIndexByName(const std::string & name)	const;
 
 				bool						getRowFilter(				int						row)		const;
@@ -334,6 +338,7 @@ public slots:
 				
 private:
 				bool				isThisTheSameThreadAsEngineSync();
+				void				setLabelsOrderFlushScheduler();
 				bool				setLabelAllowFilter(	const QModelIndex & index, bool newAllowValue);
 				bool				setLabelDescription(	const QModelIndex & index, const QString & newDescription);
 				bool				setLabelDisplay(		const QModelIndex & index, const QString & newLabel);
@@ -364,10 +369,12 @@ private:
 								_analysesHTMLReady			= false,
 								_filterShouldRunInit		= false,
 								_dataMode					= false,
-								_manualEdits				= false;
+								_manualEdits				= false,
+								_labelsOrderFlushScheduled	= false;	///< Only touched on the thread of DataSetPackage, see setLabelsOrderFlushScheduler
 
 	Json::Value					_analysesData,
 								_database					= Json::nullValue;
+	QVariant					_databaseSyncWatermark;		///< Highest value of the syncKey seen in the database, is not stored in the jasp file so the first sync after loading is always a full one
 	Version						_archiveVersion,
 								_jaspVersion;
 
@@ -31,6 +31,8 @@
 #include "utilities/qutils.h"
 #include <fstream>
 #include "appinfo.h"
+#include "utils.h"
+#include <filesystem>
 
 
 const Version JASPExporter::jaspArchiveVersion = Version("5.0.0");
@@ -89,7 +91,7 @@ void JASPExporter::saveResults(archive * a)
 	makeEntry(a, "index.html", fq(DataSetPackage::pkg()->analysesHTML()));
 }
 
-void JASPExporter::saveTempFile(archive *a, const std::string & filePath)
+void JASPExporter::saveTempFile(archive *a, const std::string & filePath, const std::string & entryName)
 {
 	// std::ios::ate seeks to the end of stream immediately after open
 	std::ifstream   readTempFile(TempFiles::sessionDirName() + "/" + filePath, std::ios::ate | std::ios::binary);
@@ -99,7 +101,7 @@ void JASPExporter::saveTempFile(archive *a, const std::string & filePath)
 	{
 		archive_entry * entry       = archive_entry_new();
 
-		archive_entry_set_pathname( entry,  filePath.c_str());
+		archive_entry_set_pathname( entry,  (entryName.empty() ? filePath : entryName).c_str());
 		archive_entry_set_size(		entry,	readTempFile.tellg()); // get size from curpos after ios::ate seek
 		archive_entry_set_filetype(	entry,	AE_IFREG);
 		archive_entry_set_birthtime(entry,  _now, 0);
@@ -163,5 +165,16 @@ void JASPExporter::saveAnalyses(archive *a)
 
 void JASPExporter::saveDatabase(archive * a)
 {
-	saveTempFile(a, DatabaseInterface::singleton()->dbFile(true));
+	if(DataSetPackage::pkg()->dataSet())
+		DataSetPackage::pkg()->dataSet()->labelsOrderFlush(); //The order of labels edited in this turn of the eventloop isn't written yet
+	
+	//internal.sqlite itself might miss whatever is still in the write-ahead log, and an engine could be holding that up, a snapshot has it all
+	const std::string	dbName		= DatabaseInterface::singleton()->dbFile(true),
+						snapshot	= dbName + ".snapshot";
+
+	DatabaseInterface::singleton()->snapshotTo(TempFiles::sessionDirName() + "/" + snapshot);
+	saveTempFile(a, snapshot, dbName);
+
+	std::error_code error;
+	std::filesystem::remove(Utils::osPath(TempFiles::sessionDirName() + "/" + snapshot), error);
 }
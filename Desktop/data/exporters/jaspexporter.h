@@ -39,7 +39,7 @@ private:
 	static void saveResults(		archive * a);
 	static void saveAnalyses(		archive * a);
 	static void saveDatabase(		archive * a);
-	static void saveTempFile(archive *a, const std::string &filePath);
+	static void saveTempFile(archive *a, const std::string &filePath, const std::string & entryName = ""); ///< entryName is filePath if empty
 	static void makeEntry(archive * a, const std::string & filename, const std::string & data);
 
 	static time_t _now;
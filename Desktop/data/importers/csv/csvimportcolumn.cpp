@@ -1,4 +1,5 @@
 #include "csvimportcolumn.h"
+#include "columnutils.h"
 #include "timers.h"
 
 CSVImportColumn::CSVImportColumn(ImportDataSet* importDataSet, std::string name) : ImportColumn(importDataSet, name)
@@ -23,6 +24,7 @@ size_t CSVImportColumn::size() const
 
 void CSVImportColumn::addValue(const std::string &value)
 {
+	_contentHash ^= ColumnUtils::contentHashRow(_data.size(), value, value);
 	_data.push_back(value);
 }
 
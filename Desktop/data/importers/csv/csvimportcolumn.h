@@ -16,10 +16,12 @@ public:
 	const	stringvec	&	allValuesAsStrings()					const	override { return  _data; }
 			void			addValue(const std::string &value);
 	const	stringvec	&	getValues()								const;
+			uint64_t		contentHash()							const	override { return _contentHash; }
 
 
 private:
-	stringvec _data;
+	stringvec	_data;
+	uint64_t	_contentHash = 0; ///< Built up while parsing, csv has no separate labels so the value is also the label
 
 };
 
@@ -5,8 +5,159 @@
 #include "utils.h"
 #include "timers.h"
 #include "utilities/qutils.h"
+#include "../datasetpackage.h"
+#include "log.h"
+#include <unordered_map>
 
 ImportDataSet * DatabaseImporter::loadFile(const std::string &locator, std::function<void(int)> progressCallback)
+{
+	_parseLocator(locator);
+	_connect();
+	
+	QSqlQuery		query	= _info.runQuery();
+	
+	_syncWatermark			= QVariant();
+	ImportDataSet * data	= _readQuery(query, progressCallback);
+
+	_info.close();
+	
+	if(!_synching) //When synching we only know whether it worked at the end of syncDataSet
+		DataSetPackage::pkg()->setDatabaseSyncWatermark(_syncWatermark);
+	
+	return data;
+}
+
+bool DatabaseImporter::syncDataSet(const std::string & locator, std::function<void(int)> progressCallback)
+{
+	JASPTIMER_SCOPE(DatabaseImporter::syncDataSet);
+	
+	_parseLocator(locator);
+	
+	const QVariant	watermark	= DataSetPackage::pkg()->databaseSyncWatermark();
+	bool			synched		= false;
+	
+	_synching = true;
+	
+	if(!_info.hasSyncKey() || !watermark.isValid() || !_syncIncrementally(watermark, progressCallback, synched))
+		synched = Importer::syncDataSet(locator, progressCallback);
+	
+	if(synched)
+		DataSetPackage::pkg()->setDatabaseSyncWatermark(_syncWatermark);
+	
+	return synched;
+}
+
+bool DatabaseImporter::_syncIncrementally(const QVariant & watermark, std::function<void(int)> progressCallback, bool & synched)
+{
+	_connect();
+	
+	QSqlQuery		query		= _info.runQuery(watermark);
+	
+	_syncWatermark				= watermark;
+	ImportDataSet * delta		= _readQuery(query, progressCallback);
+	const qint64	totalRows	= _info.countRows(); //Afterwards, so anything deleted or added in between still ends up as a mismatch below
+	
+	_info.close();
+	
+	DataSetPackage	*	pkg		= DataSetPackage::pkg();
+	const std::string	syncKey	= fq(_info._syncKey);
+	stringvec			dataColumns,
+						deltaColumns;
+	
+	for(const std::string & colName : pkg->getColumnNames())
+		if(!pkg->isColumnComputed(colName))
+			dataColumns.push_back(colName);
+	
+	for(ImportColumn * deltaColumn : *delta)
+		deltaColumns.push_back(deltaColumn->name());
+	
+	if(deltaColumns != dataColumns || !delta->getColumn(syncKey) || !pkg->dataSet()->column(syncKey))
+	{
+		Log::log() << "DatabaseImporter::_syncIncrementally found different columns or is missing syncKey '" << syncKey << "', doing a full sync instead." << std::endl;
+		delete delta;
+		return false;
+	}
+	
+	//Match the rows the database sent us to the rows we have by their key, the ones we don't know yet are appended:
+	const Column					*	keyColumn		= pkg->dataSet()->column(syncKey);
+	const stringvec						deltaKeys		= delta->getColumn(syncKey)->allValuesAsStrings(); //copy because allValuesAsStrings reuses its buffer
+	const size_t						oldRowCount		= pkg->dataRowCount();
+	size_t								newRowCount		= oldRowCount;
+	std::vector<size_t>					rows(deltaKeys.size());
+	std::unordered_map<std::string, size_t>	keyToRow;
+	bool								keysUnique		= true;
+	
+	for(size_t r=0; r<keyColumn->rowCount() && keysUnique; r++)
+		keysUnique = keyToRow.insert({keyColumn->getValue(r), r}).second;
+	
+	for(size_t i=0; i<deltaKeys.size() && keysUnique; i++)
+	{
+		auto rowIt	= keyToRow.find(deltaKeys[i]);
+		
+		if(rowIt == keyToRow.end())				rows[i]		= keyToRow[deltaKeys[i]] = newRowCount++;
+		else if(rowIt->second < oldRowCount)	rows[i]		= rowIt->second;
+		else									keysUnique	= false; //Same new key twice in the delta
+	}
+	
+	//Every row the database has is either one we had or one that is new, if it has fewer than that some were deleted and we can't tell which ones from the delta
+	if(!keysUnique || totalRows != qint64(newRowCount))
+	{
+		Log::log() << "DatabaseImporter::_syncIncrementally " << (!keysUnique ? "found syncKey '" + syncKey + "' is not unique" : "found rows were deleted from the database") << ", doing a full sync instead." << std::endl;
+		delete delta;
+		return false;
+	}
+	
+	//Only the columns that actually have different values in the rows the database sent us need to be touched:
+	std::map<std::string, stringvec> changedValues;
+	
+	for(ImportColumn * deltaColumn : *delta)
+	{
+		const Column	*	column		= pkg->dataSet()->column(deltaColumn->name());
+		const stringvec &	values		= deltaColumn->allValuesAsStrings();
+		bool				changed		= newRowCount != oldRowCount;
+		
+		for(size_t i=0; i<values.size() && !changed; i++)
+			changed = column->getValue(rows[i]) != values[i];
+		
+		if(changed)
+			changedValues[deltaColumn->name()] = values;
+	}
+	
+	delete delta;
+	
+	Log::log() << "DatabaseImporter::_syncIncrementally got " << rows.size() << " rows from the database, " << (newRowCount - oldRowCount) << " of which are new and " << changedValues.size() << " columns changed." << std::endl;
+	
+	if(changedValues.size() == 0)
+	{
+		synched = true;
+		return true;
+	}
+	
+	if(!emit pkg->checkDoSync())
+	{
+		synched = false;
+		return true;
+	}
+	
+	pkg->beginSynchingData();
+	
+	if(newRowCount != oldRowCount)
+		pkg->setDataSetRowCount(newRowCount);
+	
+	stringvec changedColumns;
+	
+	for(const auto & [colName, values] : changedValues)
+		if(pkg->setColumnRowsWithStrings(colName, rows, values))
+			changedColumns.push_back(colName);
+	
+	pkg->endSynchingData(changedColumns, {}, {}, newRowCount != oldRowCount, false);
+	pkg->setManualEdits(false);
+	
+	synched = true;
+	return true;
+}
+
+void DatabaseImporter::_parseLocator(const std::string & locator)
 {
 	// locator is the result of DatabaseConnectionInfo::toJson, so:
 	Json::Value json;
@@ -14,19 +165,26 @@ ImportDataSet * DatabaseImporter::loadFile(const std::string &locator, std::func
 		throw std::runtime_error("DatabaseImporter::loadFile received illegal locator!"); //shouldnt occur normally
 	
 	_info = DatabaseConnectionInfo(json);
+}
 
+void DatabaseImporter::_connect()
+{
 	if(!_info.connect())
 		throw std::runtime_error(fq(tr("Failed to connect to database %1 at %2 with user %3, last error was: '%4'")
 										.arg(_info._database)
 										.arg(_info._hostname + ":" + tq(std::to_string(_info._port)))
 										.arg(_info._username)
 										.arg(_info.lastError())));
+}
+
+ImportDataSet * DatabaseImporter::_readQuery(QSqlQuery & query, std::function<void(int)> progressCallback)
+{
+	float		progDiv		= 100.0f / float(query.size());
+	QSqlRecord  record		= query.record();
+	int			syncKeyIdx	= _info.hasSyncKey() ? record.indexOf(_info.syncWatermarkColumn()) : -1;
 	
-	
-	
-	QSqlQuery	query	= _info.runQuery();
-	float		progDiv	= 100.0f / float(query.size());
-	QSqlRecord  record	= query.record();
+	if(_info.hasSyncKey() && syncKeyIdx == -1)
+		Log::log() << "DatabaseImporter could not find column '" << fq(_info.syncWatermarkColumn()) << "' to sync from in the results of the query, so it can only do full syncs." << std::endl;
 	
 	ImportDataSet * data = new ImportDataSet(this);
 
@@ -44,13 +202,21 @@ ImportDataSet * DatabaseImporter::loadFile(const std::string &locator, std::func
 		}
 
 		if(query.isValid())
+		{
 			for(int i=0; i<record.count(); i++)
 				static_cast<DatabaseImportColumn*>(data->getColumn(i))->addValue(query.value(i));
+			
+			if(syncKeyIdx != -1)
+			{
+				const QVariant key = query.value(syncKeyIdx);
+				
+				if(!key.isNull() && (!_syncWatermark.isValid() || QVariant::compare(key, _syncWatermark) == QPartialOrdering::Greater))
+					_syncWatermark = key;
+			}
+		}
 	}
 	while(query.next());
 
-	_info.close();
-	
 	data->buildDictionary(); //Not necessary for reading from database but synching will break otherwise...
 	
 	return data;
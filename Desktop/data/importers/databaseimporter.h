@@ -14,9 +14,18 @@ public:
 	DatabaseImporter() : Importer() {}
 	
 	ImportDataSet* loadFile(const std::string &locator, std::function<void(int)> progressCallback) override;
+	bool syncDataSet(const std::string &locator, std::function<void(int)> progressCallback) override;
 	void initColumn(QVariant colId, ImportColumn * importColumn) override;
 	
 	DatabaseConnectionInfo _info;
+	
+private:
+	void			_parseLocator(const std::string & locator);
+	void			_connect();
+	ImportDataSet *	_readQuery(QSqlQuery & query, std::function<void(int)> progressCallback);
+	bool			_syncIncrementally(const QVariant & watermark, std::function<void(int)> progressCallback, bool & synched); ///< Returns false if only getting the new and changed rows isn't possible, because columns changed, keys aren't unique or rows were deleted, and everything needs to be synched
+	
+	QVariant		_syncWatermark; ///< Highest value of the syncWatermarkColumn read by _readQuery
 };
 
 #endif // DATABASEIMPORTER_H
@@ -1,4 +1,5 @@
 #include "importcolumn.h"
+#include "columnutils.h"
 #include "timers.h"
 #include "log.h"
 
@@ -37,3 +38,8 @@ void ImportColumn::setTitle(const std::string & title)
 {
 	_title = stringUtils::trimAndRemoveEscapes(title);
 }
+
+uint64_t ImportColumn::contentHash() const
+{
+	return ColumnUtils::contentHash(allValuesAsStrings(), allLabelsAsStrings());
+}
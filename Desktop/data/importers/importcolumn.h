@@ -23,6 +23,7 @@ public:
 	virtual const	stringvec		&	allLabelsAsStrings()					const	{ return allValuesAsStrings(); };
 	virtual const	stringset		&	allEmptyValuesAsStrings()				const	{ static stringset a; return a; }
 	virtual			columnType			getColumnType()							const	{ return columnType::unknown; }
+	virtual			uint64_t			contentHash()							const; ///< Should match Column::contentHash of a column with the same values and labels
 			const	std::string		&	title()									const;
 			const	std::string		&	name()									const;
 			void						setName(const std::string & name);
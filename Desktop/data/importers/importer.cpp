@@ -4,6 +4,7 @@
 #include <QVariant>
 #include "../datasetpackage.h"
 #include "timers.h"
+#include <unordered_map>
 
 Importer::Importer() 
 {
@@ -70,7 +71,7 @@ void Importer::initColumnWithStrings(QVariant colId, const std::string &newName,
 	DataSetPackage::pkg()->initColumnWithStrings(colId, newName, values, labels, title, desiredType, emptyValues); 																																							 
 }
 
-void Importer::syncDataSet(const std::string &locator, std::function<void(int)> progress)
+bool Importer::syncDataSet(const std::string &locator, std::function<void(int)> progress)
 {
 	_synching = true;
 	
@@ -102,7 +103,7 @@ void Importer::syncDataSet(const std::string &locator, std::function<void(int)>
 		{
 			missingColumns.erase(syncColumnName);
 
-			if(DataSetPackage::pkg()->isColumnDifferentFromStringValues(syncColumnName, syncColumn->title(), syncColumn->allValuesAsStrings(), syncColumn->allLabelsAsStrings(), syncColumn->allEmptyValuesAsStrings()))
+			if(DataSetPackage::pkg()->isColumnDifferentFromContentHash(syncColumnName, syncColumn->title(), syncColumn->contentHash(), syncColumn->allEmptyValuesAsStrings()))
 			{
 				Log::log() << "Something changed in column: " << syncColumnName << std::endl;
 				changedColumns.push_back(std::pair<int, std::string>(syncColNo, syncColumnName));
@@ -113,31 +114,49 @@ void Importer::syncDataSet(const std::string &locator, std::function<void(int)>
 	}
 
 	if (missingColumns.size() > 0 && newColumns.size() > 0)
+	{
+		//A renamed column has the same contents as a missing one, so look them up by hash instead of comparing all of them with each other
+		std::unordered_multimap<uint64_t, std::string> missingByHash;
+		
 		for (const std::string & nameMissing : missingColumns)
-			for (auto newColIt = newColumns.begin(); newColIt != newColumns.end(); ++newColIt)
+			missingByHash.insert({DataSetPackage::pkg()->columnContentHash(nameMissing), nameMissing});
+		
+		for (auto newColIt = newColumns.begin(); newColIt != newColumns.end();)
+		{
+			ImportColumn	* newColumn		= importDataSet->getColumn(newColIt->first);
+			auto			  candidates	= missingByHash.equal_range(newColumn->contentHash());
+			auto			  renamedIt		= candidates.second;
+			
+			for (auto candidate = candidates.first; candidate != candidates.second && renamedIt == candidates.second; ++candidate)
+				if(!DataSetPackage::pkg()->isColumnDifferentFromContentHash(candidate->second, newColumn->title(), candidate->first, newColumn->allEmptyValuesAsStrings()))
+					renamedIt = candidate;
+			
+			if(renamedIt == candidates.second)
+				++newColIt;
+			else
 			{
-				const std::string	& newColName	= newColIt->first;
-				ImportColumn		* newColumn		= importDataSet->getColumn(newColName);
-
-				if(!DataSetPackage::pkg()->isColumnDifferentFromStringValues(nameMissing, newColumn->title(), newColumn->allValuesAsStrings(), newColumn->allLabelsAsStrings(), newColumn->allEmptyValuesAsStrings()))
-				{
-					changeNameColumns[nameMissing] = newColName;
-					newColumns.erase(newColIt);
-					break;
-				}
+				changeNameColumns[renamedIt->second] = newColIt->first;
+				missingByHash.erase(renamedIt);
+				newColIt = newColumns.erase(newColIt);
 			}
+		}
+	}
 
 	for (auto & changeNameColumnIt : changeNameColumns)
 		missingColumns.erase(changeNameColumnIt.first);
 
+	bool synched = true;
+
 	if (newColumns.size() > 0 || changedColumns.size() > 0 || missingColumns.size() > 0 || changeNameColumns.size() > 0 || orgColumnNames != newOrder || rowCountChanged)
-			_syncPackage(importDataSet, newColumns, changedColumns, missingColumns, changeNameColumns, newOrder, rowCountChanged);
+			synched = _syncPackage(importDataSet, newColumns, changedColumns, missingColumns, changeNameColumns, newOrder, rowCountChanged);
 
 	DataSetPackage::pkg()->setManualEdits(false);
 	delete importDataSet;
+	
+	return synched;
 }
 
-void Importer::_syncPackage(
+bool Importer::_syncPackage(
 		ImportDataSet									*	syncDataSet,
 		const std::vector<std::pair<std::string, int>>	&	newColumns,
 		const std::vector<std::pair<int, std::string>>	&	changedColumns, // import col index and original (old) col name
@@ -148,7 +167,7 @@ void Importer::_syncPackage(
 
 {
 	if( ! emit DataSetPackage::pkg()->checkDoSync())
-		return;
+		return false;
 
 	DataSetPackage::pkg()->beginSynchingData();
 
@@ -202,4 +221,6 @@ void Importer::_syncPackage(
 	
 	if(newColumnOrder.size() > 0)
 		DataSetPackage::pkg()->columnsReorder(newColumnOrder);
+	
+	return true;
 }
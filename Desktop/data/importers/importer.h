@@ -18,7 +18,7 @@ public:
 	Importer();
 	virtual ~Importer();
     void loadDataSet(const std::string &locator, std::function<void (int)> progressCallback);
-    void syncDataSet(const std::string &locator, std::function<void (int)> progressCallback);
+    virtual bool syncDataSet(const std::string &locator, std::function<void (int)> progressCallback); ///< Returns false if the user decided not to sync
 	
 	virtual bool importerDeliversLabels() const { return true; } //They all do except csv, so for synchronization to work we want labels to be ignored for csv when synching, this to allow people to enter better labels and not lose them on every sync
 
@@ -33,7 +33,7 @@ protected:
 	bool	_synching = false;
 
 private:
-	void _syncPackage(
+	bool _syncPackage(
 			ImportDataSet									*	syncDataSet,
 			const std::vector<std::pair<std::string, int>>	&	newColumns,
 			const std::vector<std::pair<int, std::string>>	&	changedColumns,
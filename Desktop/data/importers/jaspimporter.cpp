@@ -29,6 +29,8 @@
 #include <json/json.h>
 #include "archivereader.h"
 #include "tempfiles.h"
+#include "utils.h"
+#include <filesystem>
 #include "../exporters/jaspexporter.h"
 
 #include "resultstesting/compareresults.h"
@@ -81,8 +83,15 @@ void JASPImporter::loadDataArchive(const std::string &path, std::function<void(i
 {
 	JASPTIMER_SCOPE(JASPImporter::loadDataArchive_1_00);
 
-    //Store sqlite into tempfiles:
-    ArchiveReader(path, DatabaseInterface::singleton()->dbFile(true)).writeEntryToTempFiles([&](float p){ progressCallback(33.333 * p); });
+	//Writing over internal.sqlite while Desktop and the engines have it open would leave them with stale pages, so it is extracted next to it and restored into the open database instead
+	const std::string	dbName	= DatabaseInterface::singleton()->dbFile(true),
+						loading	= dbName + ".loading";
+
+	ArchiveReader(path, dbName).writeEntryToTempFiles([&](float p){ progressCallback(33.333 * p); }, loading);
+	DatabaseInterface::singleton()->restoreFrom(TempFiles::sessionDirName() + "/" + loading);
+
+	std::error_code error;
+	std::filesystem::remove(Utils::osPath(TempFiles::sessionDirName() + "/" + loading), error);
 	
 	DataSetPackage::pkg()->loadDataSet([&](float p){ progressCallback(33.333 + 33.333 * p); });
 
@@ -4,6 +4,8 @@
 #include "utilities/qutils.h"
 #include "utils.h"
 #include "log.h"
+#include "messagecodec.h"
+#include "tracing.h"
 
 EngineRepresentation::EngineRepresentation(size_t channelNumber, QProcess * slaveProcess, QObject * parent)
 	: QObject(parent), _channelNumber(channelNumber)
@@ -60,8 +62,10 @@ void EngineRepresentation::cleanUpAfterClose(bool forgetAnalyses)
 	_slaveCrashed		= false;
 	_settingsChanged	= true;
 	_abortAndRestart	= false;
-	_lastCompColName	= "???";
+	_lastCompColNames	.clear();
+	_memoryBytes		= 0;
 
+	_analysesHeld.clear(); //Whatever R had in memory is gone with the process
 
 	if(_dynModName != "")
 		emit unregisterForModule(this, _dynModName);
@@ -81,6 +85,25 @@ void EngineRepresentation::sendString(std::string str)
 	channel()->send(str);
 }
 
+///Published next to the message so that an analysis running in the engine sees what it is about without reading it
+static uint8_t controlFlagsFor(const Json::Value & json)
+{
+	switch(engineStateFromString(json.get("typeRequest", "").asString()))
+	{
+	case engineState::analysis:			return performTypeFromString(json.get("perform", "run").asString()) == performType::run ? IPCChannel::controlRun : IPCChannel::controlAbort;
+	case engineState::pauseRequested:	return IPCChannel::controlPause;
+	case engineState::stopRequested:	return IPCChannel::controlStop;
+	default:							return 0;
+	}
+}
+
+void EngineRepresentation::sendJson(const Json::Value & json)
+{
+	JASPLOG(debug, ipc) << "sending to jaspEngine: " << Log::json(json) << std::endl;
+	channel()->publishControl(controlFlagsFor(json), json.get("revision", 0).asInt());
+	channel()->send(MessageCodec::encode(json));
+}
+
 
 
 void EngineRepresentation::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
@@ -115,7 +138,8 @@ void EngineRepresentation::handleEngineCrash()
 		break;
 
 	case engineState::computeColumn:
-		emit computeColumnFailed(tq(_lastCompColName), tr("The engine crashed while trying to compute this column..."));
+		for(const std::string & columnName : _lastCompColNames)
+			emit computeColumnFailed(tq(columnName), tr("The engine crashed while trying to compute this column..."));
 		break;
 
 	case engineState::rCode:
@@ -240,7 +264,9 @@ void EngineRepresentation::processReplies()
 #ifdef PRINT_ENGINE_MESSAGES
 		{
 			const int _maxDataChars = 300;//I do not want to keep scrolling forever all the time...
-			if(data != "")	Log::log() << "message received from engine #" << channelNumber() << ": " << (data.size() < _maxDataChars ? data : data.substr(0, _maxDataChars)) + "..." << std::endl;
+			if(MessageCodec::isBinary(data.data(), data.data() + data.size()))
+							Log::log() << "message received from engine #" << channelNumber() << ": " << data.size() << " bytes of CBOR" << std::endl;
+			else if(data != "")	Log::log() << "message received from engine #" << channelNumber() << ": " << (data.size() < _maxDataChars ? data : data.substr(0, _maxDataChars)) + "..." << std::endl;
 			else			Log::log() << "Engine #" << channelNumber() << " cleared its send-buffer." << std::endl;
 		}
 #endif
@@ -255,10 +281,7 @@ void EngineRepresentation::processReplies()
 
 		try
 		{
-			Json::Reader reader;
-			jsonIsOK = reader.parse(data, json);
-
-			jsonParseError = reader.getFormattedErrorMessages();
+			jsonIsOK = MessageCodec::decode(data, json, &jsonParseError);
 
 			jsonMakesSense = jsonIsOK && (json.get("typeRequest", Json::nullValue).isString() || _engineState == engineState::analysis);
 		}
@@ -273,6 +296,12 @@ void EngineRepresentation::processReplies()
 			throw std::runtime_error("Malformed reply from engine!");
 		}
 
+		if(json.isMember("traceSpans"))
+		{
+			Tracing::addRemoteSpans(json["traceSpans"]);
+			json.removeMember("traceSpans");
+		}
+
 		if(!jsonMakesSense)
 		{
 			Log::log() << "Json doesnt make sense?" << std::endl;
@@ -335,7 +364,7 @@ void EngineRepresentation::runScriptOnProcess(RFilterStore * filterStore)
 
 	Log::log() << "sending filter with requestID " << filterStore->requestId << " to engine" << std::endl;
 
-	sendString(json.toStyledString());
+	sendJson(json);
 }
 
 void EngineRepresentation::processFilterReply(Json::Value & json)
@@ -385,7 +414,7 @@ void EngineRepresentation::runScriptOnProcess(RScriptStore * scriptStore)
 
 	_lastRequestId			= scriptStore->requestId;
 
-	sendString(json.toStyledString());
+	sendJson(json);
 }
 
 
@@ -409,21 +438,32 @@ void EngineRepresentation::processRCodeReply(Json::Value & json)
 }
 
 
-void EngineRepresentation::runScriptOnProcess(RComputeColumnStore * computeColumnStore)
+///All computed columns waiting for an engine go in a single request, so invalidating a bunch of them doesn't cost a roundtrip each
+void EngineRepresentation::runScriptOnProcess(const std::vector<RComputeColumnStore*> & computeColumnStores)
 {
-	Json::Value json = Json::Value(Json::objectValue);
+	Json::Value json			= Json::Value(Json::objectValue),
+				computeColumns	= Json::Value(Json::arrayValue);
 
 	setState(engineState::computeColumn);
 
-	json["typeRequest"]		= engineStateToString(_engineState);
-	json["columnName"]		= computeColumnStore->_columnName.toStdString();
-	json["computeCode"]		= computeColumnStore->script.toStdString();
-	json["forceType"]		= computeColumnStore->_forceType;
-	json["columnType"]		= columnTypeToString(computeColumnStore->_columnType);
+	_lastCompColNames.clear();
 
-	_lastCompColName		= json["columnName"].asString();
+	for(RComputeColumnStore * computeColumnStore : computeColumnStores)
+	{
+		Json::Value computeColumn		= Json::Value(Json::objectValue);
+		computeColumn["columnName"]		= computeColumnStore->_columnName.toStdString();
+		computeColumn["computeCode"]	= computeColumnStore->script.toStdString();
+		computeColumn["forceType"]		= computeColumnStore->_forceType;
+		computeColumn["columnType"]		= columnTypeToString(computeColumnStore->_columnType);
+
+		_lastCompColNames.push_back(computeColumn["columnName"].asString());
+		computeColumns.append(computeColumn);
+	}
+
+	json["typeRequest"]		= engineStateToString(_engineState);
+	json["computeColumns"]	= computeColumns;
 
-	sendString(json.toStyledString());
+	sendJson(json);
 }
 
 
@@ -433,14 +473,18 @@ void EngineRepresentation::processComputeColumnReply(Json::Value & json)
 
 	setState(engineState::idle);
 
+	_lastCompColNames.clear();
 
-	std::string result		= json.get("result", "some string that is not 'TRUE' or 'FALSE'").asString();
-	std::string error		= json.get("error", "").asString();
-	std::string columnName	= json.get("columnName", "").asString();
+	for(const Json::Value & computeColumn : json.get("computeColumns", Json::arrayValue))
+	{
+		std::string result		= computeColumn.get("result", "some string that is not 'TRUE' or 'FALSE'").asString();
+		std::string error		= computeColumn.get("error", "").asString();
+		std::string columnName	= computeColumn.get("columnName", "").asString();
 
-	if(result == "TRUE")		emit computeColumnSucceeded(QString::fromStdString(columnName), QString::fromStdString(error), true);
-	else if(result == "FALSE")	emit computeColumnSucceeded(QString::fromStdString(columnName), QString::fromStdString(error), false);
-	else						emit computeColumnFailed(	QString::fromStdString(columnName), QString::fromStdString(error == "" ? "Unknown Error" : error));
+		if(result == "TRUE")		emit computeColumnSucceeded(QString::fromStdString(columnName), QString::fromStdString(error), true);
+		else if(result == "FALSE")	emit computeColumnSucceeded(QString::fromStdString(columnName), QString::fromStdString(error), false);
+		else						emit computeColumnFailed(	QString::fromStdString(columnName), QString::fromStdString(error == "" ? "Unknown Error" : error));
+	}
 }
 
 void EngineRepresentation::runAnalysisOnProcess(Analysis *analysis)
@@ -453,11 +497,7 @@ void EngineRepresentation::runAnalysisOnProcess(Analysis *analysis)
 
 	Json::Value json(analysis->createAnalysisRequestJson());
 
-#ifdef PRINT_ENGINE_MESSAGES
-	Log::log() << "sending: " << json.toStyledString() << std::endl;
-#endif
-
-	channel()->send(json.toStyledString());
+	sendJson(json);
 
 }
 
@@ -467,6 +507,8 @@ void EngineRepresentation::analysisRemoved(Analysis * analysis)
 	if(_analysisAborted == analysis)
 		_analysisAborted = nullptr;
 
+	_analysesHeld.erase(analysis->id());
+
 	if(_engineState != engineState::analysis || _analysisInProgress != analysis)
 		return;
 
@@ -479,9 +521,7 @@ void EngineRepresentation::analysisRemoved(Analysis * analysis)
 
 void EngineRepresentation::processAnalysisReply(Json::Value & json)
 {
-#ifdef PRINT_ENGINE_MESSAGES
-	Log::log() << "Analysis reply: " << json.toStyledString() << std::endl;
-#endif
+	JASPLOG(debug, ipc) << "Analysis reply: " << Log::json(json) << std::endl;
 
 	if(_engineState == engineState::paused || _engineState == engineState::resuming || _engineState == engineState::idle)
 	{
@@ -549,6 +589,9 @@ void EngineRepresentation::processAnalysisReply(Json::Value & json)
 
 	Log::log() << "Resultstatus of analysis was " << analysisResultStatusToString(status) << " and it will now be processed." << std::endl;
 
+	if(json.isMember("engineMemory"))
+		_memoryBytes = json["engineMemory"].asUInt64();
+
 	switch(status)
 	{
 	case analysisResultStatus::imageSaved:
@@ -587,6 +630,15 @@ void EngineRepresentation::processAnalysisReply(Json::Value & json)
 	case analysisResultStatus::fatalError:
 	case analysisResultStatus::complete:
 		analysis->setResults(results, status);
+
+		if(status == analysisResultStatus::complete)
+		{
+			Analyses::analyses()->plotsRendered(analysis, true);
+			_analysesHeld.insert(analysis->id());
+		}
+		else
+			_analysesHeld.erase(analysis->id());
+
 		clearAnalysisInProgress();
 		checkForComputedColumns(results);
 		emit checkDataSetForUpdates(); //Maybe the analysis wrote some stuff?
@@ -595,7 +647,12 @@ void EngineRepresentation::processAnalysisReply(Json::Value & json)
 
 	case analysisResultStatus::running:
 		if(!(analysis->isRunningImg()))
+		{
+			if(!json.isMember("results")) //Engine::outboxFlush leaves them out when only the progress changed
+				results = analysis->results();
+
 			analysis->setResults(results, status, progress);
+		}
 		break;
 
 	default:
@@ -723,7 +780,7 @@ void EngineRepresentation::sendStopEngine()
 
 	Log::log() << "informing engine #" << channelNumber() << " that it ought to stop" << std::endl;
 
-	sendString(json.toStyledString());
+	sendJson(json);
 }
 
 void EngineRepresentation::restartEngine(QProcess * jaspEngineProcess)
@@ -757,9 +814,8 @@ int EngineRepresentation::idleFor() const
 	return _idleStartSecs >= 0 ? Utils::currentSeconds() - _idleStartSecs : 0;
 }
 
-bool EngineRepresentation::isBored() const 
-{ 
-	
+bool EngineRepresentation::isBored() const
+{
 	return _idleStartSecs != -1 && (_idleStartSecs + ENGINE_BORED_SHUTDOWN < Utils::currentSeconds());
 }
 
@@ -797,7 +853,7 @@ void EngineRepresentation::sendPauseEngine()
 
 	Log::log() << "informing engine #" << channelNumber() << " that it ought to pause for a bit" << std::endl;
 
-	sendString(json.toStyledString());
+	sendJson(json);
 }
 
 void EngineRepresentation::resumeEngine(bool setResuming)
@@ -816,7 +872,7 @@ void EngineRepresentation::resumeEngine(bool setResuming)
 
 	Log::log() << "informing engine #" << channelNumber() << " that it may resume." << std::endl;
 
-	sendString(json.toStyledString());
+	sendJson(json);
 }
 
 void EngineRepresentation::processEnginePausedReply()
@@ -867,7 +923,7 @@ void EngineRepresentation::runModuleInstallRequestOnProcess(Json::Value request)
 
 	_requestModName	= request["moduleName"].asString();
 
-	sendString(request.toStyledString());
+	sendJson(request);
 }
 
 void EngineRepresentation::runModuleLoadRequestOnProcess(Json::Value request)
@@ -878,7 +934,7 @@ void EngineRepresentation::runModuleLoadRequestOnProcess(Json::Value request)
 
 	_requestModName	= request["moduleName"].asString();
 
-	sendString(request.toStyledString());
+	sendJson(request);
 }
 
 void EngineRepresentation::processModuleRequestReply(Json::Value & json)
@@ -932,7 +988,7 @@ void EngineRepresentation::sendLogCfg()
 	Json::Value msg		= Log::createLogCfgMsg();
 	msg["typeRequest"]	= engineStateToString(_engineState);
 
-	sendString(msg.toStyledString());
+	sendJson(msg);
 }
 
 void EngineRepresentation::processLogCfgReply()
@@ -1033,7 +1089,7 @@ void EngineRepresentation::sendSettings()
 	Json::Value msg			= Json::objectValue;
 	msg["typeRequest"]		= engineStateToString(_engineState);
 	addSettingsToJson(msg);
-	sendString(msg.toStyledString());
+	sendJson(msg);
 
 	_settingsChanged = false;
 }
@@ -1049,7 +1105,7 @@ void EngineRepresentation::sendReloadData()
 	Json::Value msg			= Json::objectValue;
 	msg["typeRequest"]		= engineStateToString(_engineState);
 
-	sendString(msg.toStyledString());
+	sendJson(msg);
 }
 
 void EngineRepresentation::addSettingsToJson(Json::Value & msg)
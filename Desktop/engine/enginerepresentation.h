@@ -45,7 +45,7 @@ public:
 	void			runScriptOnProcess(RFilterStore * filterStore);
 	void			runScriptOnProcess(RScriptStore * scriptStore);
 	void			runScriptOnCommanderProcess(const QString & rCmdCode);
-	void			runScriptOnProcess(RComputeColumnStore * computeColumnStore);
+	void			runScriptOnProcess(const std::vector<RComputeColumnStore*> & computeColumnStores);
 	void			runAnalysisOnProcess(Analysis *analysis);
 	void			runModuleInstallRequestOnProcess(Json::Value request);
 	void			runModuleLoadRequestOnProcess(Json::Value request);
@@ -97,6 +97,11 @@ public:
 	///How many seconds has this engine been idle?
 	int				idleFor() const;
 
+	///How many bytes the engine process had in memory after the last analysis it finished, 0 if it didn't finish one yet
+	size_t			memory()				const { return _memoryBytes;			}
+	///For how many live analyses this engine finished a run since it started. Only shown next to memory() and used by EngineSync to stop idle engines holding none first, nothing routes an analysis back to the engine holding it
+	size_t			analysesHeld()			const { return _analysesHeld.size();	}
+
 	bool			jaspEngineStillRunning() { return  _slaveProcess != nullptr && !killed() && !stopped(); }
 
 	void			processReplies();
@@ -131,6 +136,7 @@ protected:
 	void			processSettingsReply();
 
 	void			sendString(std::string str);
+	void			sendJson(const Json::Value & json);
 
 public slots:
 	void			analysisRemoved(Analysis * analysis);
@@ -223,9 +229,11 @@ private:
 					_pauseUnloadData	= false,
 					_reloadData			= false,	///<when the idle is engine and this true, it should reload the data
 					_moduleLoaded		= false;	///<If _dynModName is set but this is false the engine should still load the module.
-	std::string		_lastCompColName	= "???",
-					_dynModName			= "",		///<If filled: refers to the particular dynamic module this engine was meant for.
+	stringvec		_lastCompColNames;				///<The computed columns sent in the last computeColumn request, all of them fail if the engine crashes
+	std::string		_dynModName			= "",		///<If filled: refers to the particular dynamic module this engine was meant for.
 					_requestModName		= "";		///<To keep track of which engine is handling a request for a module
+	std::set<size_t>	_analysesHeld;					///<ids of the analyses this engine last completed, R keeps their state around until the engine restarts
+	size_t			_memoryBytes		= 0;		///<as reported by the engine with its last results
 
 	QMetaObject::Connection	_slaveFinishedConnection,
 							_analysisInProgressStatusConnection;
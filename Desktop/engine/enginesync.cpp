@@ -158,6 +158,8 @@ QVariant EngineSync::data(const QModelIndex &index, int role) const
 	case enginesListRoles::idle:			return engine->idle();
 	case enginesListRoles::idleSoon:		return engine->idleSoon();
 	case enginesListRoles::analysisStatus:	return engine->analysisStatus();
+	case enginesListRoles::memory:			return engine->memory() ? QString::number(engine->memory() / (1024 * 1024)) + " MB" : QString("?");
+	case enginesListRoles::analysesHeld:	return int(engine->analysesHeld());
 	case enginesListRoles::runsWhat:		return QString("Runs ") +(engine->runsAnalysis() ? "Analyses " : "") + (engine->runsRCmd() ? "RCmder " : "") + (engine->runsUtility() ? "Utilities " : "") ;
 	}
 
@@ -373,7 +375,7 @@ void EngineSync::shutdownBoredEngines()
 			( _engines.size() - boredEngines.size()  > 1 || engine->module() != "") //because it might be better to have an empty engine later in case the user adds something from a different module
 		)
 		{
-		   Log::log() << "Engine #" << engine->channelNumber()  << " had nothing to do for so long it has decided to shutdown." << std::endl;
+		   Log::log() << "Engine #" << engine->channelNumber()  << " had nothing to do for so long it has decided to shutdown" << (engine->analysesHeld() ? ", letting go of the state of " + std::to_string(engine->analysesHeld()) + " analyses." : ".") << std::endl;
 		   engine->shutEngineDown();
 		   boredEngines.push_back(engine);
 		}
@@ -682,38 +684,28 @@ stringset EngineSync::processRCodeQueue()
 
 bool EngineSync::processComputedColumnQueue()
 {
-	bool needEngine = false;
+	if(_waitingCompCols.size() == 0)
+		return false;
+
+	bool needEngine = true;
 	try
 	{
-		std::queue<RComputeColumnStore*>	newWaiting;
-		
-		while(_waitingCompCols.size() > 0)
-		{
-			RComputeColumnStore * waiting = _waitingCompCols.front();
-								
-			needEngine = true;
-			bool foundOne = false;
-			
-			for(auto * engine : _engines)
-				if(engine->idle()  && engine->runsUtility())
-				{
-					engine->runScriptOnProcess(waiting);
-				
-					delete waiting;
-					_waitingCompCols.pop();
-					foundOne = true;
-					needEngine = false;
-					break;
-				}
-		
-			if(!foundOne)
+		for(auto * engine : _engines)
+			if(engine->idle()  && engine->runsUtility())
 			{
-				newWaiting.push(waiting);
-				_waitingCompCols.pop();
+				std::vector<RComputeColumnStore*> waiting;
+
+				for(; _waitingCompCols.size() > 0; _waitingCompCols.pop())
+					waiting.push_back(_waitingCompCols.front());
+
+				engine->runScriptOnProcess(waiting);
+
+				for(RComputeColumnStore * sent : waiting)
+					delete sent;
+
+				needEngine = false;
+				break;
 			}
-		}
-		
-		_waitingCompCols = newWaiting;
 	}
 	catch(...)
 	{
@@ -912,18 +904,24 @@ void EngineSync::startExtraEngines(size_t num)
 		Log::log() << "Too many engines running already, perhaps it is time to kill up to " << num << " idle one" << (num == 1 ? "" : "s") << "." << std::endl;
 		
 
-		std::vector<std::pair<int, EngineRepresentation *>> idleEngines;
+		std::vector<EngineRepresentation *> idleEngines;
 
 		for(auto * e : _engines)
 			if(e->idle() && e->idleFor() > 0)
-				idleEngines.push_back(std::make_pair(e->idleFor(), e));
+				idleEngines.push_back(e);
 
-		std::sort(idleEngines.begin(), idleEngines.end(), [](auto & l, auto & r) { return l.first > r.first; }); //longest idle first please
+		//Engines that hold no analyses are cheapest to lose, after that the longest idle and then the one using the most memory
+		std::sort(idleEngines.begin(), idleEngines.end(), [](EngineRepresentation * l, EngineRepresentation * r)
+		{
+			if((l->analysesHeld() == 0) != (r->analysesHeld() == 0))	return l->analysesHeld() == 0;
+			if(l->idleFor() != r->idleFor())							return l->idleFor() > r->idleFor();
+																		return l->memory() > r->memory();
+		});
 
 		for(size_t i=0; i<idleEngines.size() && num > 0; i++)
 		{
-			auto * engine = idleEngines[i].second;
-			Log::log() << "Found an idle one, destroying it (" << engine->channelNumber() << "), it was idle for " << idleEngines[i].first << "s." << std::endl;
+			auto * engine = idleEngines[i];
+			Log::log() << "Found an idle one, destroying it (" << engine->channelNumber() << "), it was idle for " << engine->idleFor() << "s and held " << engine->analysesHeld() << " analyses in " << (engine->memory() / (1024 * 1024)) << "MB." << std::endl;
 
 			stopAndDestroyEngine(engine);
 			//createNewEngine(); //Dont do it here, but wait for the next loop, and we will makes ure there is a small builtin delay to avoid boost failing hard on windows
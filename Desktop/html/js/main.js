@@ -13,7 +13,10 @@ $(document).ready(function () {
 		$("#note").css("background-image", "url('img/snow.gif')");
 
 	if (typeof qt !== "undefined")
-		var ch = new QWebChannel(qt.webChannelTransport, function (channel) { jasp = channel.objects.jasp; });
+		var ch = new QWebChannel(qt.webChannelTransport, function (channel) {
+			jasp = channel.objects.jasp;
+			jasp.analysisResultsPatched.connect(function (patch) { window.analysisResultsPatched(JSON.parse(patch)); });
+		});
 
 	var ua = navigator.userAgent.toLowerCase();
 
@@ -36,6 +39,7 @@ $(document).ready(function () {
 	var analyses			= new JASPWidgets.Analyses({ className: "jasp-report" });
 
 	analysesGlobal 			= analyses
+	var resultsOnPage		= {}; // analysis id -> { revision, results } so that patches from jasp can be applied to it
 
 	window.setZoom			= function (zoom)			{ document.body.style.zoom = "" + Math.floor(zoom * 100) + "%";	}
 	window.reRenderAnalyses = function ()				{ analyses.reRender();											}
@@ -47,6 +51,42 @@ $(document).ready(function () {
 		analyses.setBottomSpacerHeight();
 	});
 
+	//Tells jasp which analyses are on screen, so that it can rewrite their plots first and the others later
+	var visibleAnalysesTimer	= null;
+	var visibleAnalysesSent		= "";
+
+	window.reportVisibleAnalyses = function ()
+	{
+		if (visibleAnalysesTimer !== null)
+			return;
+
+		visibleAnalysesTimer = setTimeout(function ()
+		{
+			visibleAnalysesTimer = null;
+
+			if (jasp === null)
+				return;
+
+			var visible = [];
+
+			for (var i = 0; i < analyses.analyses.length; i++) {
+				var rect = analyses.analyses[i].el.getBoundingClientRect();
+
+				if (rect.bottom > 0 && rect.top < window.innerHeight)
+					visible.push(analyses.analyses[i].model.get("id"));
+			}
+
+			var ids = JSON.stringify(visible);
+
+			if (ids !== visibleAnalysesSent) {
+				visibleAnalysesSent = ids;
+				jasp.analysesVisibleChanged(ids);
+			}
+		}, 200);
+	}
+
+	$( window ).on("scroll resize", window.reportVisibleAnalyses);
+
 	window.refreshEditedImage = function(id, imageEditResults) {
 		var analysis = analyses.getAnalysis(id);
 		if (analysis === undefined) return;
@@ -426,8 +466,66 @@ $(document).ready(function () {
 
 	}
 
+	// Applies the operations of JsonUtilities::structuralDiff, copying only the containers along the changed paths so unchanged parts are shared with the old results
+	var applyResultsPatch = function (results, ops) {
+
+		var root	= { value: results };
+		var copied	= new Set();
+
+		var copyOf = function (container) {
+			if (copied.has(container))
+				return container;
+
+			var copy = Array.isArray(container) ? container.slice() : Object.assign({}, container);
+			copied.add(copy);
+			return copy;
+		}
+
+		for (var i = 0; i < ops.length; i++) {
+			var op		= ops[i];
+			var path	= ["value"].concat(op.path);
+			var parent	= root;
+
+			for (var p = 0; p < path.length - 1; p++) {
+				parent[path[p]]	= copyOf(parent[path[p]]);
+				parent			= parent[path[p]];
+			}
+
+			var last = path[path.length - 1];
+
+			if		(op.op === "set")		parent[last] = op.value;
+			else if (op.op === "remove")	delete parent[last];
+			else if (op.op === "truncate") {
+				parent[last] = parent[last].slice(0, op.length);
+				copied.add(parent[last]);
+			}
+		}
+
+		return root.value;
+	}
+
+	window.analysisResultsPatched = function (patch) {
+
+		var onPage = resultsOnPage[patch.id];
+
+		if (onPage === undefined || onPage.revision !== patch.resultsBase) {
+			jasp.analysisResultsPatchFailed(patch.id);
+			return;
+		}
+
+		patch.results = applyResultsPatch(onPage.results, patch.resultsPatch);
+
+		delete patch.resultsPatch;
+		delete patch.resultsBase;
+
+		window.analysisChanged(patch);
+	}
+
 	window.analysisChanged = function (analysis) {
 
+		if (analysis.resultsRevision !== undefined)
+			resultsOnPage[analysis.id] = { revision: analysis.resultsRevision, results: analysis.results };
+
 		if (showInstructions)
 			$instructions.fadeIn(400, "easeOutCubic")
 
@@ -478,6 +576,7 @@ $(document).ready(function () {
 			}
 
 			analyses.addAnalysis(jaspWidget);
+			window.reportVisibleAnalyses();
 
 			jaspWidget.on("optionschanged",				function (id, options)	{ jasp.analysisChangedDownstream(id, JSON.stringify(options))	});
 			jaspWidget.on("saveimage",					function (id, options)	{ jasp.analysisSaveImage(id, JSON.stringify(options))			});
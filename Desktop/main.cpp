@@ -29,6 +29,8 @@
 #include <QMessageBox>
 #include "utilities/plotschemehandler.h"
 #include "utilities/imgschemehandler.h"
+#include "resultstesting/compareresults.h"
+#include "resultstesting/unittestrunner.h"
 #include <json/json.h>
 
 #ifdef linux
@@ -39,6 +41,11 @@ const std::string	jaspExtension		= ".jasp",
 					unitTestArg			= "--unitTest",
 					saveArg				= "--save",
 					timeOutArg			= "--timeOut=",
+					jobsArg				= "--jobs=",
+					timingsArg			= "--timings=",
+					timingReportArg		= "--timingReport=",
+					baselineArg			= "--baseline=",
+					slowerByArg			= "--slowerBy=",
 					junctionArg			= "--junctions",
 					removeJunctionsArg	= "--removeJunctions";
 
@@ -120,7 +127,7 @@ bool runJaspEngineJunctionFixer(int argc, char *argv[], bool removeJunctions = f
 #endif
 
 
-void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitTest, bool & dirTest, int & timeOut, bool & save, bool & logToFile, bool & hideJASP, bool & safeGraphics, Json::Value & dbJson, QString & reportingDir)
+void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitTest, bool & dirTest, int & timeOut, bool & save, bool & logToFile, bool & hideJASP, bool & safeGraphics, Json::Value & dbJson, QString & reportingDir, int & jobs, int & slowerBy, QString & timingsPath, QString & timingReport, QString & baseline)
 {
 	filePath		= "";
 	unitTest		= false;
@@ -132,11 +139,34 @@ void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitT
 	reportingDir	= "";
 	timeOut			= 10;
 	dbJson			= Json::nullValue;
+	jobs			= 1;
+	slowerBy		= 25;
+	timingsPath		= "";
+	timingReport	= "";
+	baseline		= "";
 
 	bool letsExplainSomeThings = false;
 
 	std::vector<std::string> args(argv + 1, argv + argc); // make the arguments a little less annoying to work with
 
+	auto startsWithArg = [&](int arg, const std::string & prefix)
+	{
+		return args[arg].size() > prefix.size() && args[arg].substr(0, prefix.size()) == prefix;
+	};
+
+	auto intArg = [&](int arg, const std::string & prefix, int & target)
+	{
+		std::string number			= args[arg].substr(prefix.size());
+		size_t		convertedChars	= 0;
+		int			converted		= 0;
+		try								{ converted = std::stoi(number, &convertedChars); }
+		catch(std::invalid_argument &)	{}
+		catch(std::out_of_range &)		{}
+
+		if(convertedChars > 0)
+			target = converted;
+	};
+
 	for(int arg = 0; arg < args.size(); arg++)
 	{
 		if(args[arg] == saveArg)								save					= true;
@@ -220,18 +250,12 @@ void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitT
 					reportingDir = testMe.absolutePath();
 			}
 		}
-		else if(args[arg].size() > timeOutArg.size() && args[arg].substr(0, timeOutArg.size()) == timeOutArg)
-		{
-			std::string time			= timeOutArg.substr(timeOutArg.size());
-			size_t		convertedChars	= 0;
-			int			convertedTime	= 0;
-			try								{ convertedTime = std::stoi(time, &convertedChars); }
-			catch(std::invalid_argument &)	{}
-			catch(std::out_of_range &)		{}
-
-			if(convertedChars > 0)
-				timeOut = convertedTime;
-		}
+		else if(startsWithArg(arg, timeOutArg))					intArg(arg, timeOutArg,		timeOut);
+		else if(startsWithArg(arg, jobsArg))					intArg(arg, jobsArg,		jobs);
+		else if(startsWithArg(arg, slowerByArg))				intArg(arg, slowerByArg,	slowerBy);
+		else if(startsWithArg(arg, timingsArg))					timingsPath		= QSTRING_FILE_ARG(args[arg].substr(timingsArg.size()).c_str());
+		else if(startsWithArg(arg, timingReportArg))			timingReport	= QSTRING_FILE_ARG(args[arg].substr(timingReportArg.size()).c_str());
+		else if(startsWithArg(arg, baselineArg))				baseline		= QSTRING_FILE_ARG(args[arg].substr(baselineArg.size()).c_str());
 		else
 		{
 			const std::string	remoteDebuggingPort = "--remote-debugging-port=",
@@ -305,11 +329,14 @@ void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitT
 
 	if(letsExplainSomeThings)
 	{
-		std::cerr	<< "JASP can be started without arguments, or the following: { --help | -h | filename | --unitTest filename | --unitTestRecursive folder | --save | --timeOut=10 | --logToFile | --hide } \n"
+		std::cerr	<< "JASP can be started without arguments, or the following: { --help | -h | filename | --unitTest filename | --unitTestRecursive folder | --save | --timeOut=10 | --jobs=1 | --timingReport=file | --baseline=file | --slowerBy=25 | --logToFile | --hide } \n"
 					<< "If a filename is supplied JASP will try to load it. \nIf --unitTest is specified JASP will refresh all analyses in \"filename\" (which must be a JASP file) and see if the output remains the same and will then exit with an errorcode indicating succes or failure.\n"
 					<< "If --unitTestRecursive is specified JASP will go through specified \"folder\" and perform a --unitTest on each JASP file. After it has done this it will exit with an errorcode indication succes or failure.\n"
 					<< "For both testing arguments there is the optional --save argument, which specifies that JASP should save the file after refreshing it.\n"
 					<< "For both testing arguments there is the optional --timeout argument, which specifies how many minutes JASP will wait for the analyses-refresh to take. Default is 10 minutes.\n"
+					<< "For --unitTestRecursive there is the optional --jobs argument, which specifies how many files are tested at the same time (each in its own JASP without a window). Default is 1.\n"
+					<< "For --unitTestRecursive there is the optional --timingReport argument, which specifies a json file to write the result and time taken of each file and analysis to.\n"
+					<< "For --unitTestRecursive there is the optional --baseline argument, which specifies an earlier timingReport. Files or analyses that are more than --slowerBy percent (default 25) slower than in there are counted as failures.\n"
 					<< "If --logToFile is specified then JASP will try it's utmost to write logging to a file, this might come in handy if you want to figure out why JASP does not start in case of a bug.\n"
 					<< "If --hide is specified then JASP will not be shown during recursive testing or reporting.\n"
 					<< "If --safeGraphics is specified then JASP will be started with software rendering enabled, this will be saved to your settings.\n"
@@ -324,80 +351,6 @@ void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitT
 	}
 }
 
-#define SEPARATE_PROCESS
-
-void recursiveFileOpener(QFileInfo file, int & failures, int & total, int & timeOut, int argc, char *argv[], bool save, bool hideJASP)
-{
-	const QString jaspExtension(".jasp");
-
-	//std::cout << "recursiveFileOpener in " << file.absoluteFilePath().toStdString() << std::endl;
-
-	if(file.isDir())
-	{
-		//std::cout << "it is a directory and " << (file.exists() ? "exists" : "does not exist") << std::endl;
-
-		QDir dir(file.absoluteFilePath());
-
-		//std::cout << "QDir dir: " << dir.path().toStdString() << " has " << files.size() << " subfiles!" << std::endl;
-
-		for(QFileInfo & subFile : dir.entryInfoList(QDir::Filter::NoDotAndDotDot | QDir::Files | QDir::Dirs))
-			recursiveFileOpener(subFile, failures, total, timeOut, argc, argv, save, hideJASP);
-
-	}
-	else if(file.isFile())
-	{
-		//std::cout << "it is a file" << std::endl;
-
-		if(file.absoluteFilePath().indexOf(jaspExtension) == file.absoluteFilePath().size() - jaspExtension.size())
-		{
-			//std::cout << "it has the .jasp extension so we will start JASP" << std::endl;
-#ifndef SEPARATE_PROCESS
-			std::cout << "Found a JASP file (" << file.absoluteFilePath().toStdString() << ") going to start JASP" << std::endl;
-#endif
-
-			int result = 1;
-
-			try{
-#ifdef SEPARATE_PROCESS
-				QProcess subJasp;
-				subJasp.setProgram(argv[0]);
-				QStringList arguments({"--unitTest", file.absoluteFilePath()});
-
-				if(save)
-					arguments << "--save";
-
-				arguments << QString::fromStdString("--timeOut="+std::to_string(timeOut));
-
-				if(hideJASP)
-					arguments << "-platform" << "minimal";
-
-				std::cout << "Starting subJASP with args: " << arguments.join(' ').toStdString() << std::endl;
-				subJasp.setArguments(arguments);
-				subJasp.start();
-
-				subJasp.waitForFinished((timeOut * 60000) + 10000);
-
-				std::cerr << subJasp.readAllStandardError().toStdString() << std::endl;
-
-				result = subJasp.exitCode();
-#else
-				//This seems to crash for some reason
-				result = Application(argc, argv, file.absoluteFilePath(), true, timeOut).exec();
-#endif
-			}
-			catch(...) { result = -1; }
-
-
-			std::cout << "JASP file " << file.absoluteFilePath().toStdString() << (result == 0 ? " succeeded!" : " failed!") << std::endl;
-
-			if(result != 0)
-				failures++;
-
-			total++;
-		}
-	}
-}
-
 int main(int argc, char *argv[])
 {
 	std::string filePath;
@@ -408,14 +361,21 @@ int main(int argc, char *argv[])
 				logToFile,
 				hideJASP,
 				safeGraphics;
-	int			timeOut;
+	int			timeOut,
+				jobs,
+				slowerBy;
 	Json::Value	dbJson;
+	QString		timingsPath,
+				timingReport,
+				baseline;
 
 	QCoreApplication::setOrganizationName("JASP");
 	QCoreApplication::setOrganizationDomain("jasp-stats.org");
 	QCoreApplication::setApplicationName("JASP");
 
-	parseArguments(argc, argv, filePath, unitTest, dirTest, timeOut, save, logToFile, hideJASP, safeGraphics, dbJson, reportingDir);
+	parseArguments(argc, argv, filePath, unitTest, dirTest, timeOut, save, logToFile, hideJASP, safeGraphics, dbJson, reportingDir, jobs, slowerBy, timingsPath, timingReport, baseline);
+
+	resultXmlCompare::compareResults::theOne()->setTimingsPath(timingsPath);
 
 	if(safeGraphics)		Settings::setValue(Settings::SAFE_GRAPHICS_MODE, true);
 	else					safeGraphics = Settings::value(Settings::SAFE_GRAPHICS_MODE).toBool();
@@ -549,25 +509,17 @@ int main(int argc, char *argv[])
 		}
 	else
 	{
-		int		failures	= 0,
-				total		= 0;
+		resultXmlCompare::unitTestRunner runner(argv[0], jobs, timeOut, save, hideJASP);
 
-		recursiveFileOpener(QFileInfo(filePathQ), failures, total, timeOut, argc, argv, save, hideJASP);
+		if(baseline != "" && !runner.setBaseline(baseline, slowerBy))
+			exit(1);
 
-		if(total == 0)
-		{
-			std::cerr << "Couldn't find any jasp-files in specified directory " << filePath << ", it is be treated as a failure to notify you of this!" << std::endl;
-			exit(2);
-		}
+		int exitCode = runner.run(filePathQ);
 
-		if(failures > 0)
-		{
-			std::cerr << "Finished running test, " << failures << " out of " << total << " jasp files FAILED!" << std::endl;
-			exit(1);
-		}
+		if(timingReport != "" && exitCode != 2)
+			runner.writeReport(timingReport);
 
-		std::cout << "All " << total << " jasp files succeeded in refreshing and displaying the same data afterwards!" << std::endl;
-		exit(0);
+		exit(exitCode);
 	}
 
 }
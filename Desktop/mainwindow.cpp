@@ -141,6 +141,7 @@ MainWindow::MainWindow(QApplication * application) : QObject(application), _appl
 	_labelFilterGenerator	= new labelFilterGenerator(_columnModel,		this);
 	_columnsModel			= new ColumnsModel(_dataSetModelVarInfo);			// We do not want filtered-out columns/levels to be selectable in other guis, see: https://github.com/jasp-stats/INTERNAL-jasp/issues/2322
 	_workspaceModel			= new WorkspaceModel(this);
+	_autosaveJournal		= new AutosaveJournal(this);
 	_computedColumnsModel	= new ComputedColumnModel();
 	_filterModel			= new FilterModel(_labelFilterGenerator);
 	_ribbonModel			= new RibbonModel();
@@ -244,6 +245,8 @@ MainWindow::~MainWindow()
 {
 	Log::log() << "MainWindow::~MainWindow()" << std::endl;
 
+	_autosaveJournal->discard(); //We are closing properly, so there won't be anything to recover
+
 	_analyses->destroyAllForms();
 
 	_singleton = nullptr;
@@ -272,6 +275,9 @@ MainWindow::~MainWindow()
 		//delete _engineSync; it will be deleted by Qt!
 	}
 	catch(...)	{}
+
+	if(Tracing::exportPath() != "" && !Tracing::exportChromeTrace(Tracing::exportPath()))
+		Log::log() << "Could not write trace to '" << Tracing::exportPath() << "'" << std::endl;
 }
 
 QString MainWindow::windowTitle() const
@@ -481,6 +487,7 @@ void MainWindow::makeConnections()
 	connect(_resultsJsInterface,	&ResultsJsInterface::allUserDataChanged,			_analyses,				&Analyses::allUserDataChanged								);
 	connect(_resultsJsInterface,	&ResultsJsInterface::resultsPageLoadedSignal,		_languageModel,			&LanguageModel::resultsPageLoaded							);
 	connect(_resultsJsInterface,	&ResultsJsInterface::showRSyntaxInResults,			_analyses,				&Analyses::showRSyntaxInResults								);
+	connect(_resultsJsInterface,	&ResultsJsInterface::analysesVisibleChanged,		_analyses,				&Analyses::analysesVisibleInResults							);
 
 	connect(_analyses,				&Analyses::countChanged,							this,					&MainWindow::analysesCountChangedHandler					);
 	connect(_analyses,				&Analyses::analysisResultsChanged,					this,					&MainWindow::analysisResultsChangedHandler					);
@@ -1071,7 +1078,10 @@ void MainWindow::analysisResultsChangedHandler(Analysis *analysis)
 	setPackageModified();
 
 	if(resultXmlCompare::compareResults::theOne()->testMode())
+	{
+		resultXmlCompare::compareResults::theOne()->analysisProgressed(analysis);
 		analysesForComparingDoneAlready();
+	}
 	
 	if(_reporter && _analyses->allFinished())
 		_reporter->analysesFinished();
@@ -1489,6 +1499,58 @@ void MainWindow::handleDeferredFileLoad()
 	
 	if(!_openOnLoadDbJson.isNull())
 		QTimer::singleShot(0, this, &MainWindow::_openDbJson);
+
+	if(_openOnLoadFilename == "" && _openOnLoadDbJson.isNull() && !_reporter && !resultXmlCompare::compareResults::theOne()->testMode())
+		QTimer::singleShot(0, this, &MainWindow::recoverAutosave);
+}
+
+///Offers to bring back what a JASP that crashed was working on, from the journal AutosaveJournal kept for it
+void MainWindow::recoverAutosave()
+{
+	std::string journal = AutosaveJournal::crashedJournal();
+
+	if(journal == "" || _package->isLoaded() || _analyses->count() > 0)
+		return;
+
+	if(!AutosaveJournal::replay(journal).worthRecovering())
+	{
+		AutosaveJournal::discardCrashed(journal);
+		return;
+	}
+
+	if(!MessageForwarder::showYesNo(tr("Recover workspace"), tr("JASP did not close properly last time. Do you want to recover the data and analyses you were working on?"), tr("Recover"), tr("Discard")))
+	{
+		AutosaveJournal::discardCrashed(journal);
+		return;
+	}
+
+	setWelcomePageVisible(false);
+	showProgress();
+
+	try
+	{
+		AutosaveJournal::Replayed recovered = AutosaveJournal::recover(journal);
+
+		populateUIfromDataSet();
+
+		QString file = tq(recovered.file);
+		if(file.endsWith(".jasp", Qt::CaseInsensitive) && QFileInfo::exists(file))
+			_package->setCurrentFile(file);
+
+		_package->setModified(true); //Whatever was recovered is not in any file yet
+	}
+	catch(std::runtime_error & e)
+	{
+		Log::log() << "Recovering from '" << journal << "' failed: " << e.what() << std::endl;
+
+		_package->reset();
+		hideProgress();
+		setWelcomePageVisible(true);
+
+		MessageForwarder::showWarning(tr("Unable to recover the workspace because:\n%1").arg(tq(e.what())));
+	}
+
+	AutosaveJournal::discardCrashed(journal);
 }
 
 void MainWindow::_openFile()
@@ -1894,6 +1956,9 @@ void MainWindow::testLoadedJaspFile(int timeOut, bool save)
 	if(save)
 		resultXmlCompare::compareResults::theOne()->enableSaving();
 
+	//Analyses become Running when they are sent to an engine, which doesn't always come with results, but that is when their timing should start
+	connect(_analyses, &Analyses::analysisStatusChanged, this, [](Analysis * analysis) { resultXmlCompare::compareResults::theOne()->analysisProgressed(analysis); });
+
 	QTimer::singleShot(60000 * timeOut, this, &MainWindow::unitTestTimeOut);
 }
 
@@ -1943,6 +2008,9 @@ void MainWindow::finishComparingResults()
 
 		resultXmlCompare::compareResults::theOne()->compare();
 
+		if(!resultXmlCompare::compareResults::theOne()->writeTimings())
+			Log::log() << "Could not write the timings of this unit test!" << std::endl;
+
 		if(resultXmlCompare::compareResults::theOne()->shouldSave())
 		{
 			if(resultXmlCompare::compareResults::theOne()->checkForAnalysisError())
@@ -55,6 +55,7 @@
 #include "utilities/codepageswindows.h"
 #include "widgets/filemenu/filemenu.h"
 #include "data/workspacemodel.h"
+#include "data/autosavejournal.h"
 
 #include "utilities/languagemodel.h"
 #include <vector>
@@ -287,6 +288,7 @@ private:
 	void makeAppleMenu();
 	void qmlLoaded();
 	void handleDeferredFileLoad();
+	void recoverAutosave();
 	void checkForUpdates();
 
 private:
@@ -326,6 +328,7 @@ private:
 	Reporter					*	_reporter				= nullptr;
 	CodePagesWindows			*	_windowsWorkaroundCPs	= nullptr;
 	WorkspaceModel				*	_workspaceModel			= nullptr;
+	AutosaveJournal				*	_autosaveJournal		= nullptr;
 
 	QSettings						_settings;
 
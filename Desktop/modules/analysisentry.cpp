@@ -99,6 +99,46 @@ Json::Value AnalysisEntry::asJsonForJaspFile()	const
 	return dynamicModule()->asJsonForJaspFile(function());
 }
 
+///Stores the members as they are, instead of the way Description.qml specifies them, so that fromJsonForCache gives back exactly the same entry
+Json::Value AnalysisEntry::asJsonForCache() const
+{
+	Json::Value cached(Json::objectValue);
+
+	cached["title"]			= _title;
+	cached["function"]		= _function;
+	cached["qml"]			= _qml;
+	cached["menu"]			= _menu;
+	cached["icon"]			= _icon;
+	cached["isSeparator"]	= _isSeparator;
+	cached["isGroupTitle"]	= _isGroupTitle;
+	cached["isAnalysis"]	= _isAnalysis;
+	cached["isEnabled"]		= _isEnabled;
+	cached["requiresData"]	= _requiresData;
+	cached["hasWrapper"]	= _hasWrapper;
+
+	return cached;
+}
+
+AnalysisEntry * AnalysisEntry::fromJsonForCache(const Json::Value & cached, DynamicModule * dynamicModule)
+{
+	AnalysisEntry * entry = new AnalysisEntry();
+
+	entry->_title			= cached.get("title",			"???").asString();
+	entry->_function		= cached.get("function",		"???").asString();
+	entry->_qml				= cached.get("qml",				"???").asString();
+	entry->_menu			= cached.get("menu",			"???").asString();
+	entry->_icon			= cached.get("icon",			"").asString();
+	entry->_isSeparator		= cached.get("isSeparator",		true).asBool();
+	entry->_isGroupTitle	= cached.get("isGroupTitle",	false).asBool();
+	entry->_isAnalysis		= cached.get("isAnalysis",		false).asBool();
+	entry->_isEnabled		= cached.get("isEnabled",		true).asBool();
+	entry->_requiresData	= cached.get("requiresData",	true).asBool();
+	entry->_hasWrapper		= cached.get("hasWrapper",		false).asBool();
+	entry->_dynamicModule	= dynamicModule;
+
+	return entry;
+}
+
 std::string AnalysisEntry::codedReference() const
 {
 	return dynamicModule()->name() + "~" + function();
@@ -63,6 +63,7 @@ public:
 	std::string		getFullRCall()			const;
 	Json::Value		getDefaultResults()		const;
 	Json::Value		asJsonForJaspFile()		const;
+	Json::Value		asJsonForCache()		const;
 
 	std::string		codedReference()		const;
 	std::string		buttonMenuString()		const;
@@ -72,7 +73,8 @@ public:
 	void			setMenu(const std::string& menu)	{ _menu = menu;			}
 	void			setEnabled(bool enabled)			{ _isEnabled = enabled;	}
 
-	static bool		requiresDataEntries(const AnalysisEntries & entries);
+	static bool				requiresDataEntries(const AnalysisEntries & entries);
+	static AnalysisEntry *	fromJsonForCache(const Json::Value & cached, DynamicModule * dynamicModule);	///< Inverse of asJsonForCache
 
 private:
 	std::string				_title			= "???"		,
@@ -37,6 +37,7 @@
 #include "utilities/extractarchive.h"
 #include "utilities/qmlutils.h"
 #include "mainwindow.h"
+#include "gui/preferencesmodel.h"
 
 namespace Modules
 {
@@ -76,6 +77,17 @@ QFileInfo DynamicModule::developmentModuleFolder()
 	return QFileInfo(AppDirs::userModulesDir() + QString::fromStdString(defaultDevelopmentModuleName()) + "/");
 }
 
+///Mirrors how the constructor taking an installed module directory determines moduleRLibrary() and name()
+QString DynamicModule::packageFolderFromModuleDirectory(std::string moduleDirectory)
+{
+	if(moduleDirectory.size() > 0 && moduleDirectory[moduleDirectory.size() - 1] != '/')
+		moduleDirectory += '/';
+
+	QFileInfo moduleFolder(tq(moduleDirectory));
+
+	return moduleFolder.absolutePath() + "/" + tq(stringUtils::stripNonAlphaNum(moduleFolder.absoluteDir().dirName().toStdString())) + "/";
+}
+
 void DynamicModule::developmentModuleFolderCreate()
 {
 	if(developmentModuleFolder().dir().exists()) return;
@@ -113,70 +125,49 @@ void DynamicModule::initialize()
 
 	setInitialized(true);
 
-	auto checkForExistence = [&](std::string name, bool isFile = false)
-	{
-		QString modPath = _moduleFolder.absolutePath() + "/" + nameQ() + "/" + QString::fromStdString(name);
-		QFileInfo checkInfo(modPath);
-
-		std::string errorMsg = "";
+	//Everything on disk was likely already scanned in parallel with the other modules by DynamicModules, if not it happens now
+	DynamicModules		*	dynMods		= DynamicModules::dynMods();
 
-		if(!checkInfo.exists())	errorMsg = name + " is missing from " + modPath.toStdString();
+	if(isDevMod())
+		dynMods->forgetModuleDescription(packageFolder()); //The development module changes all the time and must always be loaded fresh
 
-		if(errorMsg == "" && !isFile	&& !checkInfo.isDir())	errorMsg = name + " is not, as expected, a directory";
-		if(errorMsg == "" &&  isFile	&& !checkInfo.isFile())	errorMsg = name + " is not, as expected, a file";
-		if(errorMsg != "")
-		{
-			throw std::runtime_error(errorMsg);
-		}
+	ModuleFolderScan		scanned		= dynMods->takeModuleFolderScan(packageFolder());
 
-		return checkInfo;
-	};
+	if(scanned.problem != "")
+		throw std::runtime_error(scanned.problem);
 
-	checkForExistence("icons");
-	checkForExistence("qml");
-	//checkForExistence("R"); The module is now a package so there is no point in checking for R code because what kind of R package has *no* r-code?
+	_upgradesPath = scanned.upgradesPath;
 
-	//Ok everything seems to be in order, let's load!
-	QString qmlTxt = "";
-	
-	QUrl url;
-	try
+	if(scanned.cacheHit())
+		loadInfoFromDescriptionCache(scanned.cached);
+	else
 	{
-		QFileInfo descriptionInfo = checkForExistence(getQmlDescriptionFilename(), true);
-		
-		url = QUrl::fromLocalFile(descriptionInfo.absoluteFilePath());
+		loadDescriptionQml(scanned.descriptionQml, scanned.descriptionUrl);
 
-		QFile descriptionFile(descriptionInfo.absoluteFilePath());
-		descriptionFile.open(QFile::ReadOnly);
+		if(_upgradesPath != "")
+			loadUpgradesFromFile(_upgradesPath);
 
-		qmlTxt = descriptionFile.readAll();
-
-		if(qmlTxt == "")
-			throw std::runtime_error(getQmlDescriptionFilename() + " is empty!");
+		loadRequiredModulesFromDESCRIPTIONTxt(scanned.DESCRIPTION);
 	}
-	catch(std::runtime_error & qmlNotFound)
-	{
-		throw std::runtime_error("Couldn't find " + getQmlDescriptionFilename());
-	}
-	
-	loadDescriptionQml(qmlTxt, url);
 
+	_descriptionCacheable = !isDevMod();
+	storeInDescriptionCache();
+}
+
+void DynamicModule::loadUpgradesFromFile(const QString & upgradesPath)
+{
 	try
 	{
-		QFileInfo upgradesInfo = checkForExistence(getQmlUpgradesFilename(), true);
-		
-		url = QUrl::fromLocalFile(upgradesInfo.absoluteFilePath());
-
-		QFile upgradesFile(upgradesInfo.absoluteFilePath());
+		QFile upgradesFile(upgradesPath);
 	
 		upgradesFile.open(QFile::ReadOnly);
 
-		qmlTxt = upgradesFile.readAll();
+		QString qmlTxt = upgradesFile.readAll();
 
 		if(qmlTxt == "")
 			throw std::runtime_error(getQmlUpgradesFilename() + " is empty!");
 		
-		loadUpgradesQML(qmlTxt, url);
+		loadUpgradesQML(qmlTxt, QUrl::fromLocalFile(upgradesPath));
 	
 	}
 	catch(ModuleException & upgradeLoadError)
@@ -192,10 +183,8 @@ void DynamicModule::initialize()
 		; //Doesn't matter if this file couldn't be found or whatever
 		Log::log() << "Loading " << getQmlUpgradesFilename() << " had the following std:runtime_error: '" << qmlNotFound.what() << "' this will be ignored." << std::endl;
 	}
-	
-	QFile DESCRIPTION(checkForExistence("DESCRIPTION", true).absoluteFilePath());
-	DESCRIPTION.open(QFile::ReadOnly);
-	loadRequiredModulesFromDESCRIPTIONTxt(DESCRIPTION.readAll());
+
+	_upgradeFunctions = _upgrades ? _upgrades->functions() : stringset();
 }
 
 void DynamicModule::loadDescriptionFromFolder( const std::string & folderPath, bool onlyIfNotLoadedYet)
@@ -312,6 +301,10 @@ void DynamicModule::loadUpgradesQML(const QString & upgradesTxt, const QUrl & ur
 
 bool DynamicModule::hasUpgradesToApply(const std::string & function, const Version & version)
 {
+	//When the description came from the cache Upgrades.qml is only instantiated once something might actually need upgrading
+	if(!_upgrades && _upgradesPath != "" && (_upgradeFunctions.count(function) > 0 || _upgradeFunctions.count("*") > 0))
+		loadUpgradesFromFile(_upgradesPath);
+
 	return _upgrades != nullptr && _upgrades->hasUpgradesToApply(function, version);
 }
 
@@ -319,6 +312,9 @@ void DynamicModule::applyUpgrade(const std::string	& function,	const Version & v
 {
 	if(!analysesJson.isMember("dynamicModule"))
 		analysesJson["dynamicModule"] = asJsonForJaspFile(function);
+
+	if(!hasUpgradesToApply(function, version))
+		return;
 	
 	_upgrades->applyUpgrade(function, version, analysesJson, msgs, stepsTaken);
 }
@@ -351,6 +347,8 @@ void DynamicModule::loadInfoFromDescriptionItem(Description * description)
 
 	_menuEntries = description->menuEntries();
 
+	storeInDescriptionCache();
+
 	emit descriptionReloaded(this);
 
 	if(oldTitle != _title)
@@ -359,6 +357,101 @@ void DynamicModule::loadInfoFromDescriptionItem(Description * description)
 	emit readyChanged(installed());
 }
 
+void DynamicModule::loadInfoFromDescriptionCache(const Json::Value & cached)
+{
+	const std::string oldTitle		= _title;
+
+	_title							= cached["title"].asString();
+	_icon							= cached["icon"].asString();
+	_author							= cached["author"].asString();
+	_license						= cached["license"].asString();
+	_website						= cached["website"].asString();
+	_maintainer						= cached["maintainer"].asString();
+	_descriptionTxt					= cached["description"].asString();
+	_version						= cached["version"].asString();
+	_hasWrappers					= cached["hasWrappers"].asBool();
+
+	for(auto * menuEntry : _menuEntries)
+		delete menuEntry;
+	_menuEntries.clear();
+
+	for(const Json::Value & menuEntry : cached["menu"])
+		_menuEntries.push_back(AnalysisEntry::fromJsonForCache(menuEntry, this));
+
+	stringset importsR;
+	for(const Json::Value & importR : cached["importsR"])
+		importsR.insert(importR.asString());
+	setImportsR(importsR);
+
+	_upgradeFunctions.clear();
+	for(const Json::Value & upgradeFunction : cached["upgradeFunctions"])
+		_upgradeFunctions.insert(upgradeFunction.asString());
+
+	//Without a Description item nothing gets retranslated or shows the debug entries, so make one when that is needed
+	connect(LanguageModel::lang(),		&LanguageModel::currentLanguageChanged,		this, &DynamicModule::instantiateDescriptionIfCached, Qt::UniqueConnection);
+	connect(PreferencesModel::prefs(),	&PreferencesModel::developerModeChanged,	this, &DynamicModule::instantiateDescriptionIfCached, Qt::UniqueConnection);
+
+	emit descriptionReloaded(this);
+
+	if(oldTitle != _title)
+		emit titleChanged();
+
+	emit readyChanged(installed());
+}
+
+void DynamicModule::storeInDescriptionCache()
+{
+	if(!_descriptionCacheable)
+		return;
+
+	Json::Value cached(Json::objectValue);
+
+	cached["title"]				= _title;
+	cached["icon"]				= _icon;
+	cached["author"]			= _author;
+	cached["license"]			= _license;
+	cached["website"]			= _website;
+	cached["maintainer"]		= _maintainer;
+	cached["description"]		= _descriptionTxt;
+	cached["version"]			= _version;
+	cached["hasWrappers"]		= _hasWrappers;
+	cached["menu"]				= Json::arrayValue;
+	cached["importsR"]			= Json::arrayValue;
+	cached["upgradeFunctions"]	= Json::arrayValue;
+
+	for(const AnalysisEntry * menuEntry : _menuEntries)
+		cached["menu"].append(menuEntry->asJsonForCache());
+
+	for(const std::string & importR : _importsR)
+		cached["importsR"].append(importR);
+
+	for(const std::string & upgradeFunction : _upgradeFunctions)
+		cached["upgradeFunctions"].append(upgradeFunction);
+
+	DynamicModules::dynMods()->cacheModuleDescription(packageFolder(), cached);
+}
+
+void DynamicModule::instantiateDescriptionIfCached()
+{
+	if(_description)
+		return;
+
+	QString descriptionPath = packageFolder() + tq(getQmlDescriptionFilename());
+	QFile	descriptionFile(descriptionPath);
+
+	if(!descriptionFile.open(QFile::ReadOnly))
+		return;
+
+	try
+	{
+		loadDescriptionQml(descriptionFile.readAll(), QUrl::fromLocalFile(descriptionPath));
+	}
+	catch(std::runtime_error & e)
+	{
+		Log::log() << "Instantiating the cached description of module " << _name << " failed with: " << e.what() << std::endl;
+	}
+}
+
 
 
 void DynamicModule::setReadyForUse()
@@ -95,6 +95,7 @@ public:
 	static void			developmentModuleFolderCreate();
 	static bool			isDescriptionFile(const std::string & filename);
 	static bool			isDescriptionFile(const QString		& filename);
+	static QString		packageFolderFromModuleDirectory(std::string moduleDirectory);
 
 	const std::string &	name()				const { return _name;									}
 	QString				nameQ()				const { return QString::fromStdString(name());			}
@@ -117,6 +118,7 @@ public:
 	bool				readyForUse()		const { return _status == moduleStatus::readyForUse;	}
 	bool				installNeeded()		const { return _status == moduleStatus::installNeeded;	}
 	QString				moduleRLibrary()	const { return  _moduleFolder.absolutePath();			}
+	QString				packageFolder()		const { return moduleRLibrary() + "/" + nameQ() + "/";	} ///< Where Description.qml, DESCRIPTION and the rest of the installed module package are
 	const stringset &	importsR()			const { return _importsR;						}
 	QStringList			importsRQ()			const { return tql(_importsR);					}
 	stringset			requiredModules()	const;
@@ -169,6 +171,7 @@ public:
 	void initialize();
 	void loadDescriptionQml(const QString		& descriptionTxt,	const QUrl		& url);
 	void loadUpgradesQML(	const QString		& upgradesTxt,		const QUrl		& url);
+	void loadUpgradesFromFile(const QString		& upgradesPath);
 	bool hasUpgradesToApply(const std::string	& function,			const Version	& version);
 	void applyUpgrade(		const std::string	& function,			const Version	& version, Json::Value & analysesJson, UpgradeMsgs & msgs, StepsTaken & stepsTaken);
 
@@ -195,10 +198,13 @@ public:
 
 	std::string toString();
 	void loadInfoFromDescriptionItem(Description * description);
+	void loadInfoFromDescriptionCache(const Json::Value & cached);
+	void storeInDescriptionCache();
 	void preprocessMarkdownHelp(QString & md) const;
 
 public slots:
 	void reloadDescription();
+	void instantiateDescriptionIfCached();
 	void setInstalling(			bool		installing);
 	void setInitialized(		bool		initialized);
 	void setBundled(			bool		isBundled);
@@ -247,7 +253,10 @@ private:
 						_isCommon			= false,
 						_hasWrappers		= false;
 	AnalysisEntries		_menuEntries;
-	stringset			_importsR;
+	stringset			_importsR,
+						_upgradeFunctions;
+	QString				_upgradesPath;
+	bool				_descriptionCacheable	= false;
 	Description		*	_description		= nullptr;
 	Upgrades		*	_upgrades			= nullptr;
 
@@ -52,10 +52,17 @@ DynamicModules::DynamicModules(QObject *parent) : QObject(parent)
 
 	if(!std::filesystem::exists(_modulesInstallDirectory))
 		std::filesystem::create_directories(_modulesInstallDirectory);
+
+	//Translations of the descriptions come in shortly after initializing, so wait a bit to write them all at once
+	_descriptionCacheSaveTimer.setSingleShot(true);
+	_descriptionCacheSaveTimer.setInterval(2000);
+	_descriptionCacheSaveTimer.callOnTimeout([&](){ _descriptionCache.save(); });
 }
 
 DynamicModules::~DynamicModules()
 {
+	_descriptionCache.save();
+
 	_modules.clear(); //We do not need to delete them as they get DynamicModules as parent.
 
 	_singleton = nullptr;
@@ -63,7 +70,19 @@ DynamicModules::~DynamicModules()
 
 void DynamicModules::initializeInstalledModules()
 {
-	std::error_code error;
+	std::error_code				error;
+	std::vector<std::string>	moduleDirectories;
+
+	for (std::filesystem::directory_iterator itr(_modulesInstallDirectory, error); !error && itr != std::filesystem::directory_iterator(); itr++)
+	{
+		std::string name = itr->path().filename().generic_string();
+
+		if(name != defaultDevelopmentModuleName() && name.size() > 0 && name[0] != '.' && QFileInfo(tq(itr->path().generic_string())).isDir())
+			moduleDirectories.push_back(itr->path().generic_string());
+	}
+
+	prescanModuleDirectories(moduleDirectories);
+
 	for (std::filesystem::directory_iterator itr(_modulesInstallDirectory, error); !error && itr != std::filesystem::directory_iterator(); itr++)
 	{
 		std::string path			= itr->path().generic_string(),
@@ -92,6 +111,22 @@ void DynamicModules::initializeInstalledModules()
 	}
 }
 
+void DynamicModules::forgetModuleDescription(const QString & packageFolder)
+{
+	_descriptionCache.forget(packageFolder);
+
+	if(_descriptionCache.dirty())
+		_descriptionCacheSaveTimer.start();
+}
+
+void DynamicModules::cacheModuleDescription(const QString & packageFolder, const Json::Value & cached)
+{
+	_descriptionCache.store(packageFolder, cached);
+
+	if(_descriptionCache.dirty())
+		_descriptionCacheSaveTimer.start();
+}
+
 bool DynamicModules::initializeModuleFromDir(std::string moduleDir, bool bundled, bool isCommon)
 {
 	if(moduleDir.size() == 0)
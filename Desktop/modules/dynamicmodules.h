@@ -27,6 +27,8 @@
 #include "version.h"
 #include "dynamicmodule.h"
 #include <QFileSystemWatcher>
+#include <QTimer>
+#include "moduledescriptioncache.h"
 #include "upgrader/upgradeDefinitions.h"
 
 namespace Modules
@@ -50,6 +52,10 @@ public:
 	static DynamicModules * dynMods()	{ return _singleton; }
 
 	void					initializeInstalledModules();
+	void					prescanModuleDirectories(	const	std::vector<std::string> & moduleDirectories)	{ _descriptionCache.prescan(moduleDirectories);		}
+	ModuleFolderScan		takeModuleFolderScan(		const	QString & packageFolder)						{ return _descriptionCache.takeScan(packageFolder);	}
+	void					forgetModuleDescription(	const	QString & packageFolder);
+	void					cacheModuleDescription(		const	QString & packageFolder, const Json::Value & cached);
 	void					registerQMLTypes();
 
 	bool					unpackAndInstallModule(		const	std::string & moduleZipFilename);
@@ -168,6 +174,8 @@ private:
 														*	_devModRWatcher				= nullptr,
 														*	_devModHelpWatcher			= nullptr;
 	Modules::DynamicModule								*	_devModule					= nullptr;
+	ModuleDescriptionCache									_descriptionCache;
+	QTimer													_descriptionCacheSaveTimer;
 };
 
 }
@@ -0,0 +1,224 @@
+#include "moduledescriptioncache.h"
+#include "dynamicmodule.h"
+#include "appinfo.h"
+#include "log.h"
+#include "utilities/qutils.h"
+#include "utilities/appdirs.h"
+#include "utilities/languagemodel.h"
+#include "gui/preferencesmodel.h"
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <future>
+#include <thread>
+#include <atomic>
+
+namespace Modules
+{
+
+ModuleDescriptionCache::ModuleDescriptionCache()
+{
+	QFile cacheFile(cacheFilePath());
+
+	if(!cacheFile.open(QFile::ReadOnly))
+		return;
+
+	Json::Value cacheJson;
+
+	if(Json::Reader().parse(cacheFile.readAll().toStdString(), cacheJson) && cacheJson.isObject() && cacheJson.get("cacheVersion", 0).asInt() == 1 && cacheJson["entries"].isObject())
+		_entries = cacheJson["entries"];
+	else
+		Log::log() << "Module description cache at '" << cacheFilePath() << "' could not be read, it will be rebuilt." << std::endl;
+}
+
+QString ModuleDescriptionCache::cacheFilePath()
+{
+	return AppDirs::appData(false) + "/moduleDescriptionCache.json";
+}
+
+///Everything besides the files themselves that changes what ends up in a description: translations and which debug entries are shown
+std::string ModuleDescriptionCache::context()
+{
+	return	AppInfo::version.asString()
+			+ "|" + (LanguageModel::lang()		? fq(LanguageModel::lang()->currentLanguageCode())							: "")
+			+ "|" + (PreferencesModel::prefs()	? (PreferencesModel::prefs()->developerMode() ? "dev" : "user")	: "");
+}
+
+std::string ModuleDescriptionCache::keyFor(const QString & packageFolder) const
+{
+	return keyFor(packageFolder, context());
+}
+
+std::string ModuleDescriptionCache::keyFor(const QString & packageFolder, const std::string & context) const
+{
+	std::string key = context;
+
+	for(const std::string & file : { DynamicModule::getQmlDescriptionFilename(), DynamicModule::getQmlUpgradesFilename(), std::string("DESCRIPTION") })
+	{
+		QFileInfo fileInfo(packageFolder + tq(file));
+
+		key += "|" + (!fileInfo.isFile() ? "-" : std::to_string(fileInfo.size()) + ":" + std::to_string(fileInfo.lastModified().toMSecsSinceEpoch()));
+	}
+
+	return key;
+}
+
+///Only reads from disk and _entries, which makes it safe to call from several threads at the same time
+ModuleFolderScan ModuleDescriptionCache::scan(const QString & packageFolder, const std::string & context) const
+{
+	ModuleFolderScan scanned;
+
+	auto checkForExistence = [&](const std::string & name, bool isFile)
+	{
+		QFileInfo checkInfo(packageFolder + tq(name));
+
+		if(!checkInfo.exists())					scanned.problem = name + " is missing from " + fq(checkInfo.absoluteFilePath());
+		else if(!isFile && !checkInfo.isDir())	scanned.problem = name + " is not, as expected, a directory";
+		else if( isFile && !checkInfo.isFile())	scanned.problem = name + " is not, as expected, a file";
+
+		return scanned.problem == "";
+	};
+
+	if(!checkForExistence("icons", false) || !checkForExistence("qml", false) || !checkForExistence("DESCRIPTION", true))
+		return scanned;
+
+	if(!checkForExistence(DynamicModule::getQmlDescriptionFilename(), true))
+	{
+		scanned.problem = "Couldn't find " + DynamicModule::getQmlDescriptionFilename();
+		return scanned;
+	}
+
+	QFileInfo upgradesInfo(packageFolder + tq(DynamicModule::getQmlUpgradesFilename()));
+
+	if(upgradesInfo.isFile())
+		scanned.upgradesPath = upgradesInfo.absoluteFilePath();
+
+	scanned.key = keyFor(packageFolder, context);
+
+	const Json::Value & entry = _entries[fq(packageFolder)];
+
+	if(entry.isObject() && entry["key"].asString() == scanned.key)
+	{
+		scanned.cached = entry;
+		return scanned;
+	}
+
+	QFileInfo	descriptionInfo(packageFolder + tq(DynamicModule::getQmlDescriptionFilename()));
+	QFile		descriptionFile(descriptionInfo.absoluteFilePath()),
+				DESCRIPTIONFile(packageFolder + "DESCRIPTION");
+
+	scanned.descriptionUrl	= QUrl::fromLocalFile(descriptionInfo.absoluteFilePath());
+
+	if(descriptionFile.open(QFile::ReadOnly))	scanned.descriptionQml	= descriptionFile.readAll();
+	if(DESCRIPTIONFile.open(QFile::ReadOnly))	scanned.DESCRIPTION		= DESCRIPTIONFile.readAll();
+
+	if(scanned.descriptionQml == "")
+		scanned.problem = "Couldn't find " + DynamicModule::getQmlDescriptionFilename();
+
+	return scanned;
+}
+
+void ModuleDescriptionCache::prescan(const std::vector<std::string> & moduleDirectories)
+{
+	const std::string		ctx = context();
+	std::vector<QString>	packageFolders;
+
+	for(const std::string & moduleDirectory : moduleDirectories)
+		packageFolders.push_back(DynamicModule::packageFolderFromModuleDirectory(moduleDirectory));
+
+	std::vector<ModuleFolderScan>	scans(packageFolders.size());
+	std::atomic<size_t>				next(0);
+
+	auto worker = [&]()
+	{
+		for(size_t i = next++; i < packageFolders.size(); i = next++)
+			scans[i] = scan(packageFolders[i], ctx);
+	};
+
+	size_t							threads = std::min<size_t>(packageFolders.size(), std::max(1u, std::thread::hardware_concurrency()));
+	std::vector<std::future<void>>	workers;
+
+	for(size_t t = 1; t < threads; t++)
+		workers.push_back(std::async(std::launch::async, worker));
+
+	worker();
+
+	for(std::future<void> & finished : workers)
+		finished.get();
+
+	size_t hits = 0;
+	for(size_t i = 0; i < packageFolders.size(); i++)
+	{
+		hits += scans[i].cacheHit();
+		_prescanned[packageFolders[i]] = std::move(scans[i]);
+	}
+
+	Log::log() << "Prescanned " << packageFolders.size() << " module folders, " << hits << " of them could use their cached description." << std::endl;
+}
+
+ModuleFolderScan ModuleDescriptionCache::takeScan(const QString & packageFolder)
+{
+	auto prescanned = _prescanned.find(packageFolder);
+
+	if(prescanned == _prescanned.end())
+		return scan(packageFolder, context());
+
+	ModuleFolderScan scanned = std::move(prescanned->second);
+	_prescanned.erase(prescanned);
+
+	return scanned;
+}
+
+void ModuleDescriptionCache::store(const QString & packageFolder, Json::Value entry)
+{
+	entry["key"] = keyFor(packageFolder);
+
+	Json::Value & stored = _entries[fq(packageFolder)];
+
+	if(stored == entry)
+		return;
+
+	stored = entry;
+	_dirty = true;
+}
+
+void ModuleDescriptionCache::forget(const QString & packageFolder)
+{
+	_prescanned.erase(packageFolder);
+
+	if(_entries.isMember(fq(packageFolder)))
+	{
+		_entries.removeMember(fq(packageFolder));
+		_dirty = true;
+	}
+}
+
+bool ModuleDescriptionCache::save()
+{
+	if(!_dirty)
+		return true;
+
+	//Folders from uninstalled modules or older versions of JASP shouldn't keep the file growing
+	for(const std::string & packageFolder : _entries.getMemberNames())
+		if(!QDir(tq(packageFolder)).exists())
+			_entries.removeMember(packageFolder);
+
+	Json::Value cacheJson(Json::objectValue);
+	cacheJson["cacheVersion"]	= 1;
+	cacheJson["entries"]		= _entries;
+
+	QFile cacheFile(cacheFilePath());
+
+	if(!cacheFile.open(QFile::WriteOnly | QFile::Truncate))
+	{
+		Log::log() << "Could not write module description cache to '" << cacheFilePath() << "'" << std::endl;
+		return false;
+	}
+
+	cacheFile.write(Json::FastWriter().write(cacheJson).c_str());
+	_dirty = false;
+
+	return true;
+}
+
+}
@@ -0,0 +1,60 @@
+#ifndef MODULEDESCRIPTIONCACHE_H
+#define MODULEDESCRIPTIONCACHE_H
+
+#include <map>
+#include <QUrl>
+#include <QString>
+#include <json/json.h>
+
+namespace Modules
+{
+
+///
+/// Everything DynamicModule::initialize() needs to know about a module folder on disk.
+/// Gathering this does not touch QML, so it can be done for several folders at once from worker threads.
+struct ModuleFolderScan
+{
+	std::string		key,				///< Describes the current state of the files we cache from, if the cached entry has a different key it is stale
+					problem;			///< Filled when the folder isn't a proper module, initialize() throws it
+	Json::Value		cached;				///< The cached description if it is still valid, null otherwise
+	QString			descriptionQml,		///< Only read when there was no valid cached entry
+					DESCRIPTION,		///< Idem
+					upgradesPath;		///< Empty if the module has no Upgrades.qml
+	QUrl			descriptionUrl;
+
+	bool			cacheHit() const { return cached.isObject(); }
+};
+
+///
+/// Remembers what was extracted from Description.qml, Upgrades.qml and DESCRIPTION of each installed or bundled module between runs.
+/// An entry is keyed on the modification times and sizes of those files and on the version of JASP, the language and developer mode.
+/// As long as that key matches the module can be initialized without instantiating any QML, which is by far the slowest part of starting up.
+class ModuleDescriptionCache
+{
+public:
+						ModuleDescriptionCache();
+
+	static QString		cacheFilePath();
+
+	void				prescan(	const std::vector<std::string>	& moduleDirectories);	///< Scans the folders in parallel so that initialize can take the results later
+	ModuleFolderScan	takeScan(	const QString					& packageFolder);		///< Returns the prescanned result for this folder if there is one, otherwise scans it now
+	std::string			keyFor(		const QString					& packageFolder) const;
+
+	void				store(		const QString					& packageFolder, Json::Value entry);
+	void				forget(		const QString					& packageFolder);
+	bool				save();
+	bool				dirty() const { return _dirty; }
+
+private:
+	static std::string	context();
+	ModuleFolderScan	scan(		const QString					& packageFolder, const std::string & context) const;
+	std::string			keyFor(		const QString					& packageFolder, const std::string & context) const;
+
+	Json::Value									_entries	= Json::objectValue;
+	std::map<QString, ModuleFolderScan>			_prescanned;
+	bool										_dirty		= false;
+};
+
+}
+
+#endif // MODULEDESCRIPTIONCACHE_H
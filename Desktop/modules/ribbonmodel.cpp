@@ -47,6 +47,15 @@ void RibbonModel::loadModules(std::vector<std::string> commonModulesToLoad, std:
 
 	addSpecialRibbonButtonsEarly();
 
+	//Reading the bundled module folders is independent per module, so get that done in parallel before initializing them one by one
+	std::vector<std::string> bundledModuleDirectories;
+	for(const std::vector<std::string> * modulesToLoad : { &commonModulesToLoad, &extraModulesToLoad })
+		for(const std::string & moduleName : *modulesToLoad)
+			if(!moduleName.empty() && !DynamicModules::dynMods()->moduleIsInstalledByUser(moduleName) && DynamicModules::bundledModuleInFilesystem(moduleName))
+				bundledModuleDirectories.push_back(DynamicModules::bundledModuleLibraryPath(moduleName));
+
+	DynamicModules::dynMods()->prescanModuleDirectories(bundledModuleDirectories);
+
 	auto loadModulesFromBundledOrUserData = [&](bool common)
 	{
 		for(const std::string & moduleName : (common ? commonModulesToLoad : extraModulesToLoad))
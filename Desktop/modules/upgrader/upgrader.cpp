@@ -4,7 +4,11 @@
 #include "../dynamicmodule.h"
 #include <QFile>
 #include "utilities/messageforwarder.h"
+#include "timers.h"
 #include <QTimer>
+#include <atomic>
+#include <future>
+#include <thread>
 
 namespace Modules
 {
@@ -39,6 +43,8 @@ void Upgrader::processUpgradeJson(const std::string & module, const Json::Value
 		if(_allSteps.count(module) > 0)
 			removeStepsOfModule(module);
 
+		_chainsClear();
+
 		if(!upgrades.isArray())
 			throw upgradeLoadError(upgrades, "Cannot load upgrades for module '" + module + "' because it is not an array of upgrade steps... This is what it looks like:");
 
@@ -69,6 +75,8 @@ void Upgrader::removeStepsOfModule(const std::string & module)
 		return;
 	}
 
+	_chainsClear();
+
 	Steps & steps = _allSteps[module];
 
 	for(const UpgradeStep * step : steps)
@@ -88,14 +96,95 @@ void Upgrader::removeStepsOfModule(const std::string & module)
 	_allSteps.erase(module);
 }
 
+void Upgrader::_chainsClear()
+{
+	_chains[0].clear();
+	_chains[1].clear();
+}
+
+///Runs the steps from upgrades.json for all analyses of a jasp-file at once, spread over a couple of threads because they only touch the json of their own analysis.
+///upgradeAnalysisData then only has the upgrades from Upgrades.qml left to do, those need the qml engine and thus the GUI thread.
+void Upgrader::preUpgradeAnalysesData(Json::Value & analysesList)
+{
+	JASPTIMER_SCOPE(Upgrader::preUpgradeAnalysesData);
+
+	_preUpgraded.clear();
+
+	std::vector<std::pair<Json::Value *, const Chain *>> toUpgrade;
+
+	for(Json::Value & analysis : analysesList)
+		if(analysis.isObject())
+			try
+			{
+				const Chain & chain = _chainFrom(_analysisAt(analysis), analysis.isMember("module"));
+
+				if(chain.size())
+					toUpgrade.push_back({&analysis, &chain});
+			}
+			catch(std::exception & e) {} //A version that cannot be read for instance, upgradeAnalysisData runs into it again and reports it for the analysis in question
+
+	if(toUpgrade.size() == 0)
+		return;
+
+	std::vector<PreUpgraded>	upgraded(toUpgrade.size());
+	std::atomic<size_t>			next(0);
+
+	auto worker = [&]()
+	{
+		for(size_t i = next++; i < toUpgrade.size(); i = next++)
+		{
+			Json::Value & analysis			= *toUpgrade[i].first;
+			analysis["preUpgradeVersion"]	= analysis["version"];
+
+			try							{ _applyChain(analysis, *toUpgrade[i].second, upgraded[i].msgs, upgraded[i].stepsTaken, false); }
+			catch(std::exception &)		{ upgraded[i].error = std::current_exception(); } //Not only upgradeError, anything else would otherwise come out of finished.get() and fail all analyses instead of just this one
+		}
+	};
+
+	size_t							threads = std::min<size_t>(toUpgrade.size(), std::max(1u, std::thread::hardware_concurrency()));
+	std::vector<std::future<void>>	workers;
+
+	for(size_t t = 1; t < threads; t++)
+		workers.push_back(std::async(std::launch::async, worker));
+
+	worker();
+
+	for(std::future<void> & finished : workers)
+		finished.get();
+
+	for(size_t i = 0; i < toUpgrade.size(); i++)
+		_preUpgraded[(*toUpgrade[i].first)["id"].asUInt()] = std::move(upgraded[i]);
+
+	Log::log() << "Applied the steps from upgrades.json to " << toUpgrade.size() << " of " << analysesList.size() << " analyses with " << threads << " threads." << std::endl;
+}
+
 bool Upgrader::upgradeAnalysisData(Json::Value & analysis, UpgradeMsgs & msgs) const
 {
-	StepsTaken	stepsTaken;
+	StepsTaken			stepsTaken;
+	std::exception_ptr	preUpgradeError;
+	auto				preUpgraded = _preUpgraded.find(analysis["id"].asUInt());
 
-	analysis["preUpgradeVersion"] = analysis["version"];
+	if(preUpgraded == _preUpgraded.end())
+		analysis["preUpgradeVersion"] = analysis["version"];
+	else
+	{
+		msgs			= std::move(preUpgraded->second.msgs);
+		stepsTaken		= std::move(preUpgraded->second.stepsTaken);
+		preUpgradeError	= preUpgraded->second.error;
+		_preUpgraded.erase(preUpgraded);
+
+		for(const std::string & optionLog : msgs[logId])
+			Log::log() << optionLog << std::endl;
+		msgs[logId].clear();
+
+		Log::log() << "Steps from upgrades.json were already applied by preUpgradeAnalysesData, continuing from there." << std::endl;
+	}
 
 	try
 	{
+		if(preUpgradeError)
+			std::rethrow_exception(preUpgradeError);
+
 		_upgradeOptionsFromJaspFile(analysis, msgs, stepsTaken);
 
 #ifdef JASP_DEBUG
@@ -115,83 +204,140 @@ bool Upgrader::upgradeAnalysisData(Json::Value & analysis, UpgradeMsgs & msgs) c
 	return stepsTaken.size() > 0;
 }
 
-void Upgrader::_upgradeOptionsFromJaspFile(Json::Value & analysis, UpgradeMsgs & msgs, StepsTaken & stepsTaken) const
+StepTaken Upgrader::_analysisAt(const Json::Value & analysis)
 {
 	std::string		module		= (analysis.isMember("dynamicModule") ? analysis["dynamicModule"]["moduleName"]		: analysis.get("module", "Common")	).asString(),
 					function	= (analysis.isMember("dynamicModule") ? analysis["dynamicModule"]["analysisEntry"]	: analysis["name"]					).asString(); //name in a jasp file analyses.json refers to the function... analysis["name"] really should be the same as in ...["analysisEntry"] btw. Left the ternary here cause it looks nicer
 	Version			version		= (analysis.isMember("dynamicModule") ? analysis["dynamicModule"]["moduleVersion"]	: analysis["version"]				).asString();
-	Json::Value &	options		= analysis["options"];
 
 	//Ok apparently some old JASP files have version-numbers like "1.0" in 0.8.2, which is not good.. So let's check if module was filled and version is that, in that case we treat it as 0
 	if(!analysis.isMember("module") && version == Version(1))
 		version = Version(0, 8, 2);
 
-	Log::log() << "Checking if there are upgrade options for module '" << module << "' with function '" << function << "' and version '" << version.asString() << "'!" << std::endl;
+	return { module, function, version };
+}
 
-	if(_searcher.count(module) > 0)
-	{
-		const StepsPerVersion & perVersion = _searcher.at(module);
-	
-		Version closestVersion = version;
-		if(		perVersion.count(version)				== 0	||	//There is nothing registered for this version
-				perVersion.at(version).count(function)	== 0	||	//Or there is nothing registered for this version + function
-				perVersion.at(version).count("*")		== 0	)	//Or there is nothing registered for this version and module (function == "*" which means all functions)
-			for(auto & versionSteps : perVersion)
-				if(versionSteps.first > version && (versionSteps.second.count(function) > 0 || versionSteps.second.count("*") > 0))
-				{
-					closestVersion = versionSteps.first;
-					break;
-				}
-	
-		if(perVersion.count(closestVersion) > 0 && (perVersion.at(closestVersion).count(function) > 0 || perVersion.at(closestVersion).count("*") > 0)) //apply step!
-		{
-			Log::log() << "Closest (from) version found was: '" << closestVersion.asString() << "'" << std::endl;
-	
-			const UpgradeStep * step = perVersion.at(closestVersion).count(function) > 0 ? perVersion.at(closestVersion).at(function) : perVersion.at(closestVersion).at("*");
-	
-			const std::string toFunction = step->toFunction() == "*" ? function : step->toFunction();
-			//Do some loop detection
-			StepTaken	fromStep(		{module,			function,	closestVersion}),
-						aboutToStep(	{step->toModule(),	toFunction,	step->toVersion()});
-	
-			stepsTaken.insert(fromStep); //We want to remember where we come from
-	
-			if(stepsTaken.count(aboutToStep) > 0)
-				throw upgradeError("Aborting upgrade because a loop was detected!\n\nIf " + step->toString() + " is taken, eventually it is reached again.\n\nThis should definitely not happen, perhaps the module author of '" + module + "' can be of assistance");
-	
-			step->applyChanges(options, msgs);
-			stepsTaken.insert(aboutToStep); //And remember where we are going
-			
-			
-			if(analysis.isMember("module"))
-			{
-				analysis["module"]	= step->toModule();
-				analysis["version"] = step->toVersion().asString();
-				analysis["name"]	= toFunction;
-			}
-			else //It must have already been in a "dynamicModule" sub entry
+const UpgradeStep * Upgrader::_stepFrom(const StepTaken & at, Version & closestVersion) const
+{
+	if(_searcher.count(at.module) == 0)
+		return nullptr;
+
+	const StepsPerVersion	&	perVersion	= _searcher.at(at.module);
+	const std::string		&	function	= at.name;
+	const Version			&	version		= at.version;
+
+	closestVersion = version;
+	if(		perVersion.count(version)				== 0	||	//There is nothing registered for this version
+			perVersion.at(version).count(function)	== 0	||	//Or there is nothing registered for this version + function
+			perVersion.at(version).count("*")		== 0	)	//Or there is nothing registered for this version and module (function == "*" which means all functions)
+		for(auto & versionSteps : perVersion)
+			if(versionSteps.first > version && (versionSteps.second.count(function) > 0 || versionSteps.second.count("*") > 0))
 			{
-				analysis["dynamicModule"]["moduleName"]		= step->toModule();
-				analysis["dynamicModule"]["moduleVersion"]	= step->toVersion().asString();
-				analysis["dynamicModule"]["analysisEntry"]	= toFunction;
-				
+				closestVersion = versionSteps.first;
+				break;
 			}
-				
-			for(const std::string & optionLog : msgs[logId])
-				Log::log() << optionLog << std::endl;
-			msgs[logId].clear();
-	
-			Log::log() << "Options were upgraded to module '" << step->toModule() << "' with function '" << step->toFunction() << "' and version '" << step->toVersion().asString() << "'!" << std::endl;
-	
-			_upgradeOptionsFromJaspFile(analysis, msgs, stepsTaken); //See if we can upgrade some more
-			
-			return;
+
+	if(perVersion.count(closestVersion) == 0 || (perVersion.at(closestVersion).count(function) == 0 && perVersion.at(closestVersion).count("*") == 0))
+		return nullptr;
+
+	return perVersion.at(closestVersion).count(function) > 0 ? perVersion.at(closestVersion).at(function) : perVersion.at(closestVersion).at("*");
+}
+
+///Where the steps lead only depends on where they start, so this is only worked out once for every module, function and version we come across
+const Upgrader::Chain & Upgrader::_chainFrom(const StepTaken & start, bool hasModule) const
+{
+	ChainPerStart & chains = _chains[hasModule];
+
+	auto found = chains.find(start);
+	if(found != chains.end())
+		return found->second;
+
+	Chain		chain;
+	StepsTaken	taken;
+	StepTaken	at = start;
+	Version		closestVersion;
+
+	while(const UpgradeStep * step = _stepFrom(at, closestVersion))
+	{
+		const std::string toFunction = step->toFunction() == "*" ? at.name : step->toFunction();
+
+		chain.push_back({ step, { at.module, at.name, closestVersion }, { step->toModule(), toFunction, step->toVersion() } });
+
+		taken.insert(chain.back().from);
+
+		if(taken.count(chain.back().to) > 0)
+			break; //It loops, _applyChain will complain about that when it gets here
+
+		taken.insert(chain.back().to);
+
+		at = chain.back().to;
+
+		if(!hasModule && at.version == Version(1)) //As in _analysisAt
+			at.version = Version(0, 8, 2);
+	}
+
+	return chains[start] = std::move(chain);
+}
+
+void Upgrader::_applyChain(Json::Value & analysis, const Chain & chain, UpgradeMsgs & msgs, StepsTaken & stepsTaken, bool log) const
+{
+	Json::Value & options = analysis["options"];
+
+	for(const ChainLink & link : chain)
+	{
+		if(log)
+			Log::log() << "Closest (from) version found was: '" << link.from.version.asString() << "'" << std::endl;
+
+		stepsTaken.insert(link.from); //We want to remember where we come from
+
+		if(stepsTaken.count(link.to) > 0)
+			throw upgradeError("Aborting upgrade because a loop was detected!\n\nIf " + link.step->toString() + " is taken, eventually it is reached again.\n\nThis should definitely not happen, perhaps the module author of '" + link.from.module + "' can be of assistance");
+
+		link.step->applyChanges(options, msgs);
+		stepsTaken.insert(link.to); //And remember where we are going
+
+		if(analysis.isMember("module"))
+		{
+			analysis["module"]	= link.to.module;
+			analysis["version"] = link.to.version.asString();
+			analysis["name"]	= link.to.name;
 		}
+		else //It must have already been in a "dynamicModule" sub entry
+		{
+			analysis["dynamicModule"]["moduleName"]		= link.to.module;
+			analysis["dynamicModule"]["moduleVersion"]	= link.to.version.asString();
+			analysis["dynamicModule"]["analysisEntry"]	= link.to.name;
+		}
+
+		if(!log)
+			continue; //Those are logged once we are back on the GUI thread
+
+		for(const std::string & optionLog : msgs[logId])
+			Log::log() << optionLog << std::endl;
+		msgs[logId].clear();
+
+		Log::log() << "Options were upgraded to module '" << link.step->toModule() << "' with function '" << link.step->toFunction() << "' and version '" << link.step->toVersion().asString() << "'!" << std::endl;
 	}
-	
-	if(DynamicModules::dynMods()->moduleHasUpgradesToApply(module, function, version))
+}
+
+void Upgrader::_upgradeOptionsFromJaspFile(Json::Value & analysis, UpgradeMsgs & msgs, StepsTaken & stepsTaken) const
+{
+	const StepTaken at = _analysisAt(analysis);
+
+	Log::log() << "Checking if there are upgrade options for module '" << at.module << "' with function '" << at.name << "' and version '" << at.version.asString() << "'!" << std::endl;
+
+	const Chain & chain = _chainFrom(at, analysis.isMember("module"));
+
+	if(chain.size())
+	{
+		_applyChain(analysis, chain, msgs, stepsTaken, true);
+		_upgradeOptionsFromJaspFile(analysis, msgs, stepsTaken); //See if Upgrades.qml has some more
+		return;
+	}
+
+	if(DynamicModules::dynMods()->moduleHasUpgradesToApply(at.module, at.name, at.version))
 	{
-		DynamicModules::dynMods()->applyUpgrade(module, function, version, analysis, msgs, stepsTaken); //This eventually also checks if there was a loop or not.
+		DynamicModules::dynMods()->applyUpgrade(at.module, at.name, at.version, analysis, msgs, stepsTaken); //This eventually also checks if there was a loop or not.
 		_upgradeOptionsFromJaspFile(analysis, msgs, stepsTaken);
 	}
 	else
@@ -2,6 +2,7 @@
 #define UPGRADER_H
 
 #include <set>
+#include <exception>
 #include <QObject>
 #include "upgradestep.h"
 
@@ -25,6 +26,26 @@ class Upgrader : public QObject
 	typedef std::map<Version, StepPerName>				StepsPerVersion;
 	typedef std::map<std::string, StepsPerVersion>		StepSearch;
 
+	///A step from upgrades.json as it is taken from a certain module, function and version
+	struct ChainLink
+	{
+		const UpgradeStep	*	step;
+		StepTaken				from,
+								to;
+	};
+
+	///All steps from upgrades.json that are taken one after the other from a certain module, function and version, which doesn't depend on the options of an analysis at all
+	typedef std::vector<ChainLink>						Chain;
+	typedef std::map<StepTaken, Chain>					ChainPerStart;
+
+	///What preUpgradeAnalysesData did for an analysis, for upgradeAnalysisData to continue from
+	struct PreUpgraded
+	{
+		UpgradeMsgs				msgs;
+		StepsTaken				stepsTaken;
+		std::exception_ptr		error;		///< Rethrown by upgradeAnalysisData, so it ends up where it would have without preUpgradeAnalysesData
+	};
+
 
 
 public:
@@ -36,14 +57,24 @@ public:
 	void removeStepsOfModule(const std::string & module);
 	void loadOldSchoolUpgrades();
 
+	void preUpgradeAnalysesData(Json::Value & analysesList);
+	void preUpgradedClear() { _preUpgraded.clear(); }
 	bool upgradeAnalysisData(Json::Value & analysisData, UpgradeMsgs & msgs) const;
 
 private:
 	static Upgrader * _singleton;
 	void _upgradeOptionsFromJaspFile(Json::Value & analysesJson, UpgradeMsgs & msgs, StepsTaken & stepsTaken) const;
 
-	StepsPerMod		_allSteps; //vectors of steps organized by name of originating module
-	StepSearch		_searcher; //a map organized by from-module with maps organized as a step per version.
+	static StepTaken	_analysisAt(const Json::Value & analysis);
+	const UpgradeStep *	_stepFrom(const StepTaken & at, Version & closestVersion)	const;
+	const Chain		&	_chainFrom(const StepTaken & at, bool hasModule)			const;
+	void				_applyChain(Json::Value & analysis, const Chain & chain, UpgradeMsgs & msgs, StepsTaken & stepsTaken, bool log) const;
+	void				_chainsClear();
+
+	StepsPerMod						_allSteps; //vectors of steps organized by name of originating module
+	StepSearch						_searcher; //a map organized by from-module with maps organized as a step per version.
+	mutable ChainPerStart			_chains[2];		///< Per whether the analysis has "module" (and thus no "dynamicModule"), because that decides how a version 1 is read
+	mutable std::map<size_t, PreUpgraded>	_preUpgraded;	///< Per analysis id, filled by preUpgradeAnalysesData and emptied by upgradeAnalysisData
 
 };
 
@@ -45,6 +45,17 @@ void Upgrades::applyUpgrade(const std::string & function, const Version & versio
 		_steps[closest][function]->applyUpgrade(function, version, analysesJson, msgs, stepsTaken);
 }
 
+std::set<std::string> Upgrades::functions() const
+{
+	std::set<std::string> functions;
+
+	for(const auto & versionSteps : _steps)
+		for(const auto & functionStep : versionSteps.second)
+			functions.insert(functionStep.first);
+
+	return functions;
+}
+
 void Upgrades::setModule(QString module)
 {
 	if (_module == module)
@@ -30,6 +30,7 @@ public:
 	bool	findClosestVersion(	const std::string & function,		Version & version);
 	bool	hasUpgradesToApply(	const std::string & function, const Version	& version)  { Version v(version); return findClosestVersion(function, v); }
 	void	applyUpgrade(		const std::string & function, const Version	& version, Json::Value & analysesJson, UpgradeMsgs & msgs, StepsTaken & stepsTaken);
+	std::set<std::string>	functions() const; ///< All functions that have an upgrade registered, "*" included
 
 	
 	
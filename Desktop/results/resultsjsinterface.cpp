@@ -38,6 +38,7 @@
 #include "gui/preferencesmodel.h"
 #include <QThread>
 #include "log.h"
+#include "analysis/analyses.h"
 
 ResultsJsInterface * ResultsJsInterface::_singleton = nullptr;
 
@@ -79,6 +80,8 @@ void ResultsJsInterface::setResultsLoaded(bool resultsLoaded)
 	_resultsLoaded = resultsLoaded;
 	emit resultsLoadedChanged(_resultsLoaded);
 
+	_resultsRevisionOnPage.clear(); //A (re)loaded page starts empty
+
 	if (resultsLoaded)
 	{
 		QString version = AboutModel::version();
@@ -294,7 +297,41 @@ void ResultsJsInterface::exportSelected(const QString &filename)
 
 void ResultsJsInterface::analysisChanged(Analysis *analysis)
 {
-	runJavaScript("window.analysisChanged(JSON.parse('" + escapeJavascriptString(tq(analysis->asJSON().toStyledString())) + "'));");
+	int		id			= analysis->id();
+	size_t	revision	= analysis->resultsRevision();
+	auto	onPage		= _resultsRevisionOnPage.find(id);
+
+	//Only when the page has the results this patch starts from (or already has these results) can we get away with sending just the changes
+	if(_resultsLoaded && onPage != _resultsRevisionOnPage.end() && (onPage->second == revision || (onPage->second + 1 == revision && !analysis->resultsPatch().isNull())))
+	{
+		Json::Value patch			= analysis->asJSON(false, false);
+		patch["resultsBase"]		= Json::UInt64(onPage->second);
+		patch["resultsRevision"]	= Json::UInt64(revision);
+		patch["resultsPatch"]		= onPage->second == revision ? Json::Value(Json::arrayValue) : analysis->resultsPatch();
+
+		onPage->second = revision;
+
+		emit analysisResultsPatched(tq(Json::FastWriter().write(patch)));
+		return;
+	}
+
+	Json::Value full		= analysis->asJSON();
+	full["resultsRevision"]	= Json::UInt64(revision);
+
+	_resultsRevisionOnPage[id] = revision;
+
+	runJavaScript("window.analysisChanged(JSON.parse('" + escapeJavascriptString(tq(full.toStyledString())) + "'));");
+}
+
+///Called from the page when it couldn't apply a patch, for instance because it was reloaded in the meantime
+void ResultsJsInterface::analysisResultsPatchFailed(int id)
+{
+	_resultsRevisionOnPage.erase(id);
+
+	Analysis * analysis = Analyses::analyses()->get(id);
+
+	if(analysis)
+		analysisChanged(analysis);
 }
 
 void ResultsJsInterface::setResultsMeta(const QString & str)
@@ -319,11 +356,13 @@ void ResultsJsInterface::unselect()
 
 void ResultsJsInterface::removeAnalysis(Analysis *analysis)
 {
+	_resultsRevisionOnPage.erase(analysis->id());
 	runJavaScript("window.removeAnalysisTrigger(" + QString::number(analysis->id()) + ")");
 }
 
 void ResultsJsInterface::removeAnalyses()
 {
+	_resultsRevisionOnPage.clear();
 	runJavaScript("window.removeAllAnalyses()");
 }
 
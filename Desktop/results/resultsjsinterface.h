@@ -67,6 +67,7 @@ public:
 	Q_INVOKABLE void purgeClipboard();
 	Q_INVOKABLE void analysisEditImage(int id, QString options);
 	Q_INVOKABLE void runJavaScript(const QString & js);
+	Q_INVOKABLE void analysisResultsPatchFailed(int id);
 
 	//Callable from javascript through resultsJsInterfaceInterface...
 signals:
@@ -90,6 +91,7 @@ signals:
 				void prepForExport();
 	Q_INVOKABLE void exportPrepFinished();
 	Q_INVOKABLE void showRSyntaxInResults(	bool show);
+	Q_INVOKABLE void analysesVisibleChanged(QString ids);
 
 
 public slots:
@@ -119,6 +121,7 @@ signals:
 	void resultsPageUrlChanged(	QUrl	resultsPageUrl);
 	void runJavaScriptSignal(			QString js); //Do not call this directly here, use runJavaScript()
 	void runJavaScriptSignalQueued(		QString js); //Same same
+	void analysisResultsPatched(		QString patch); //Compact json, passed on to the page through the webchannel instead of being escaped into javascript
 	void zoomChanged();
 	void resultsPageLoadedSignal();
 	void resultsLoadedChanged(bool resultsLoaded);
@@ -152,6 +155,7 @@ private:
 						_scrollAtAll	= true;
 	
 	std::queue<QString>	_delayedJs;
+	std::map<int, size_t>	_resultsRevisionOnPage; ///< Analysis id -> Analysis::resultsRevision() the results page last received
 
 	static ResultsJsInterface * _singleton;
 };
@@ -7,6 +7,8 @@
 #include <QTextStream>
 #include <QFileInfo>
 #include "analysis/analyses.h"
+#include <json/json.h>
+#include <fstream>
 
 namespace resultXmlCompare
 {
@@ -67,6 +69,67 @@ bool compareResults::checkForAnalysisError()
 	return _analysisHadError;
 }
 
+void compareResults::setRefreshCalled()
+{
+	atLeastOneRefreshHappened	= true;
+	_refreshStarted				= clock::now();
+	_analysisTimings.clear();
+}
+
+long compareResults::msSinceRefresh() const
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - _refreshStarted).count();
+}
+
+void compareResults::analysisProgressed(Analysis * analysis)
+{
+	if(!atLeastOneRefreshHappened)
+		return;
+
+	analysisTiming & timing = _analysisTimings[analysis->id()];
+	timing.name		= analysis->name();
+	timing.title	= analysis->title();
+
+	if(timing.startedMs < 0 && analysis->status() == Analysis::Status::Running)
+		timing.startedMs = msSinceRefresh();
+
+	if(timing.finishedMs < 0 && analysis->isFinished())
+		timing.finishedMs = msSinceRefresh();
+}
+
+///Written for unitTestRunner, which adds it to its report and compares it to a baseline
+bool compareResults::writeTimings() const
+{
+	if(_timingsPath == "")
+		return true;
+
+	Json::Value timings		= Json::objectValue,
+				analyses	= Json::arrayValue;
+
+	for(const auto & idTiming : _analysisTimings)
+	{
+		const analysisTiming & timing = idTiming.second;
+
+		Json::Value analysis	= Json::objectValue;
+		analysis["id"]			= Json::UInt64(idTiming.first);
+		analysis["name"]		= timing.name;
+		analysis["title"]		= timing.title;
+		analysis["ms"]			= Json::Int64(timing.finishedMs < 0 || timing.startedMs < 0 ? -1 : timing.finishedMs - timing.startedMs); //Never seen running means we don't know how long it waited for an engine, so we don't know how long it took either
+
+		analyses.append(analysis);
+	}
+
+	timings["file"]			= _filePath.toStdString();
+	timings["success"]		= succes;
+	timings["refreshMs"]	= Json::Int64(_comparedMs);
+	timings["analyses"]		= analyses;
+
+	std::ofstream out(_timingsPath.toStdString());
+	out << timings.toStyledString();
+
+	return out.good();
+}
+
 result compareResults::convertXmltoResultStruct(const QString &  resultXml)
 {
 	QXmlStreamReader xml(resultXml);
@@ -286,6 +349,9 @@ bool compareResults::compare(const QString & resultOld, const QString & resultNe
 {
 	ranCompare = true;
 
+	if(atLeastOneRefreshHappened)
+		_comparedMs = msSinceRefresh();
+
 	std::cout << "Old result conversion:" << std::endl;
 	/*QFile file("out.txt");
 	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
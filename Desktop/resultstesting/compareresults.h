@@ -2,8 +2,12 @@
 #define COMPARERESULTS_H
 
 #include <QString>
+#include <chrono>
+#include <map>
 #include "resultscomparetable.h"
 
+class Analysis;
+
 namespace resultXmlCompare
 {
 
@@ -35,7 +39,7 @@ public:
 	void	enableSaving()				{ saveAfterRefresh = true; }
 	bool	shouldSave()		const	{ return saveAfterRefresh; }
 
-	void	setRefreshCalled()			{ atLeastOneRefreshHappened = true; }
+	void	setRefreshCalled();
 	bool	refreshed()			const	{ return atLeastOneRefreshHappened; }
 
 	void	setExportCalled()			{ resultsExportCalled = true; }
@@ -47,11 +51,28 @@ public:
 	QString	filePath()			const	{ return _filePath;	}
 	void	setFilePath(QString p)		{ _filePath = p;	}
 
+	void	setTimingsPath(QString p)	{ _timingsPath = p;	}
+	void	analysisProgressed(Analysis * analysis);
+	bool	writeTimings() const;
+
 	static	compareResults	*theOne();
 
 private:
 	explicit		compareResults() {}
 
+	typedef std::chrono::steady_clock clock;
+
+	///When an analysis was first seen running and when it was first seen finished, both relative to the refresh
+	struct analysisTiming
+	{
+		std::string	name,
+					title;
+		long		startedMs	= -1,
+					finishedMs	= -1;
+	};
+
+	long			msSinceRefresh() const;
+
 	bool			runningTestMode				= false,
 					atLeastOneRefreshHappened	= false,
 					resultsExportCalled			= false,
@@ -62,7 +83,12 @@ private:
 
 	QString			originalResultExport		= "",
 					refreshedResultExport		= "",
-					_filePath					= "";
+					_filePath					= "",
+					_timingsPath				= "";
+
+	clock::time_point					_refreshStarted;
+	long								_comparedMs			= -1;
+	std::map<size_t, analysisTiming>	_analysisTimings;	///< Per analysis id
 
 	static compareResults*	singleton;
 };
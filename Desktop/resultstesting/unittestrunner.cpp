@@ -0,0 +1,292 @@
+#include "unittestrunner.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QProcess>
+#include <QDir>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <memory>
+
+namespace resultXmlCompare
+{
+
+static const long	minimumSlowerFileMs		= 2000,	///< Below these differences it is more likely noise than a regression
+					minimumSlowerAnalysisMs	=  500;
+
+static bool clearlySlower(long ms, long baselineMs, long minimumMs, int slowerByPercent)
+{
+	return baselineMs >= 0 && ms >= 0 && ms - baselineMs >= minimumMs && ms * 100 > baselineMs * (100 + slowerByPercent);
+}
+
+static std::string analysisKey(const Json::Value & analysis)
+{
+	return analysis["id"].asString() + ":" + analysis["name"].asString();
+}
+
+unitTestRunner::unitTestRunner(const QString & program, int jobs, int timeOut, bool save, bool hide)
+	: _program(program), _jobs(std::max(1, jobs)), _timeOut(timeOut), _save(save), _hide(hide)
+{}
+
+bool unitTestRunner::setBaseline(const QString & reportPath, int slowerByPercent)
+{
+	_slowerByPercent = slowerByPercent;
+
+	std::ifstream	in(reportPath.toStdString());
+	Json::Value		report;
+	std::string		errors;
+
+	if(!in.is_open() || !Json::parseFromStream(Json::CharReaderBuilder(), in, &report, &errors))
+	{
+		std::cerr << "Could not read baseline " << reportPath.toStdString() << (errors != "" ? " because: " + errors : "") << std::endl;
+		return false;
+	}
+
+	for(const Json::Value & file : report["files"])
+		_baseline[file["file"].asString()] = file;
+
+	_baselineJobs = report.get("jobs", 1).asInt();
+
+	if(_baselineJobs != _jobs)
+		std::cerr << "Baseline " << reportPath.toStdString() << " was made with --jobs " << _baselineJobs << " instead of " << _jobs << ", so the timings are not compared with it." << std::endl;
+	else
+		std::cout << "Comparing timings to baseline " << reportPath.toStdString() << " with " << _baseline.size() << " files, more than " << _slowerByPercent << "% slower counts as failure." << std::endl;
+
+	return true;
+}
+
+void unitTestRunner::collectFiles(const QString & path, const QString & folder)
+{
+	const QString	jaspExtension(".jasp");
+	QFileInfo		file(path);
+
+	if(file.isDir())
+	{
+		for(QFileInfo & subFile : QDir(file.absoluteFilePath()).entryInfoList(QDir::Filter::NoDotAndDotDot | QDir::Files | QDir::Dirs))
+			collectFiles(subFile.absoluteFilePath(), folder);
+	}
+	else if(file.isFile() && file.absoluteFilePath().endsWith(jaspExtension))
+	{
+		fileTest test;
+		test.path			= file.absoluteFilePath();
+		test.relativePath	= QDir(folder).relativeFilePath(test.path);
+
+		_tests.push_back(test);
+	}
+}
+
+QStringList unitTestRunner::argumentsFor(const fileTest & test, const QString & timingsPath) const
+{
+	QStringList arguments({"--unitTest", test.path, "--timings=" + timingsPath});
+
+	if(_save)
+		arguments << "--save";
+
+	arguments << QString::fromStdString("--timeOut="+std::to_string(_timeOut));
+
+	if(_hide || _jobs > 1) //Several JASP windows fighting for focus helps nobody
+		arguments << "-platform" << "minimal";
+
+	return arguments;
+}
+
+void unitTestRunner::readTimings(fileTest & test, const QString & timingsPath)
+{
+	std::ifstream	in(timingsPath.toStdString());
+	std::string		errors;
+
+	if(!in.is_open() || !Json::parseFromStream(Json::CharReaderBuilder(), in, &test.timings, &errors))
+		test.timings = Json::nullValue; //A test that crashed or timed out doesn't get to write them
+
+	in.close();
+	QFile::remove(timingsPath);
+}
+
+void unitTestRunner::compareToBaseline(fileTest & test)
+{
+	auto found = _baseline.find(test.relativePath.toStdString());
+
+	if(found == _baseline.end())
+		return;
+
+	const Json::Value & baseline = found->second;
+
+	//With a different number of JASP processes at a time they compete differently for the cores, so the timings say nothing about regressions
+	if(_baselineJobs != _jobs)
+		return;
+
+	if(clearlySlower(test.wallMs, baseline["wallMs"].asInt64(), minimumSlowerFileMs, _slowerByPercent))
+	{
+		test.slower = true;
+		std::cerr << "JASP file " << test.relativePath.toStdString() << " took " << test.wallMs << "ms where the baseline took " << baseline["wallMs"].asInt64() << "ms!" << std::endl;
+	}
+
+	if(!test.timings.isObject())
+		return;
+
+	std::map<std::string, long> baselineAnalyses;
+	for(const Json::Value & analysis : baseline["analyses"])
+		baselineAnalyses[analysisKey(analysis)] = analysis["ms"].asInt64();
+
+	for(Json::Value & analysis : test.timings["analyses"])
+	{
+		auto baselineAnalysis = baselineAnalyses.find(analysisKey(analysis));
+
+		if(baselineAnalysis == baselineAnalyses.end())
+			continue;
+
+		analysis["baselineMs"] = Json::Int64(baselineAnalysis->second);
+
+		if(clearlySlower(analysis["ms"].asInt64(), baselineAnalysis->second, minimumSlowerAnalysisMs, _slowerByPercent))
+		{
+			test.slower			= true;
+			analysis["slower"]	= true;
+			std::cerr << "Analysis " << analysis["title"].asString() << " (" << analysis["name"].asString() << ") in " << test.relativePath.toStdString() << " took " << analysis["ms"].asInt64() << "ms where the baseline took " << baselineAnalysis->second << "ms!" << std::endl;
+		}
+	}
+}
+
+int unitTestRunner::run(const QString & folder)
+{
+	collectFiles(folder, folder);
+
+	if(_tests.size() == 0)
+	{
+		std::cerr << "Couldn't find any jasp-files in specified directory " << folder.toStdString() << ", it is be treated as a failure to notify you of this!" << std::endl;
+		return 2;
+	}
+
+	std::cout << "Found " << _tests.size() << " jasp files, testing them with " << _jobs << " JASP processes at a time." << std::endl;
+
+	struct runningTest
+	{
+		size_t						test;
+		std::unique_ptr<QProcess>	process;
+		QElapsedTimer				timer;
+		QString						timingsPath;
+	};
+
+	std::vector<std::unique_ptr<runningTest>>	running;
+	size_t										next		= 0;
+	const qint64								timeOutMs	= (_timeOut * 60000) + 10000;
+
+	auto finish = [&](runningTest & child)
+	{
+		fileTest & test	= _tests[child.test];
+		test.wallMs		= child.timer.elapsed();
+		test.exitCode	= child.process->exitStatus() == QProcess::NormalExit && !test.timedOut ? child.process->exitCode() : -1;
+
+		std::cerr << child.process->readAllStandardError().toStdString() << std::endl;
+
+		readTimings(test, child.timingsPath);
+		compareToBaseline(test);
+
+		if(test.exitCode != 0)	_failures++;
+		if(test.slower)			_regressions++;
+
+		std::cout << "JASP file " << test.path.toStdString() << (test.exitCode == 0 ? " succeeded!" : test.timedOut ? " timed out!" : " failed!") << " (" << test.wallMs << "ms)" << std::endl;
+	};
+
+	while(next < _tests.size() || running.size())
+	{
+		while(running.size() < size_t(_jobs) && next < _tests.size())
+		{
+			std::unique_ptr<runningTest> child = std::make_unique<runningTest>();
+			child->test			= next++;
+			child->timingsPath	= QDir::temp().filePath(QString("jaspUnitTestTimings_%1_%2.json").arg(QCoreApplication::applicationPid()).arg(child->test));
+			child->process		= std::make_unique<QProcess>();
+
+			QStringList arguments = argumentsFor(_tests[child->test], child->timingsPath);
+
+			std::cout << "Starting subJASP with args: " << arguments.join(' ').toStdString() << std::endl;
+
+			child->process->setProgram(_program);
+			child->process->setArguments(arguments);
+			child->process->setStandardOutputFile(QProcess::nullDevice()); //They are quite chatty, and the interesting bits go to stderr anyway
+			child->process->start();
+			child->timer.start();
+
+			running.push_back(std::move(child));
+		}
+
+		for(size_t r=0; r<running.size(); )
+		{
+			runningTest & child = *running[r];
+
+			//There is no eventloop here, so this is also what makes QProcess notice a process finished
+			child.process->waitForFinished(running.size() == 1 ? 1000 : 50);
+
+			if(child.process->state() != QProcess::NotRunning && child.timer.elapsed() > timeOutMs)
+			{
+				_tests[child.test].timedOut = true;
+				child.process->kill();
+				child.process->waitForFinished(10000);
+			}
+
+			if(child.process->state() == QProcess::NotRunning)
+			{
+				finish(child);
+				running.erase(running.begin() + r);
+			}
+			else
+				r++;
+		}
+	}
+
+	if(_failures > 0)
+		std::cerr << "Finished running test, " << _failures << " out of " << _tests.size() << " jasp files FAILED!" << std::endl;
+
+	if(_regressions > 0)
+		std::cerr << "Finished running test, " << _regressions << " out of " << _tests.size() << " jasp files became more than " << _slowerByPercent << "% slower than the baseline!" << std::endl;
+
+	if(_failures > 0 || _regressions > 0)
+		return 1;
+
+	std::cout << "All " << _tests.size() << " jasp files succeeded in refreshing and displaying the same data afterwards!" << std::endl;
+	return 0;
+}
+
+///The report can be passed as --baseline to a later run
+bool unitTestRunner::writeReport(const QString & reportPath) const
+{
+	Json::Value report		= Json::objectValue,
+				files		= Json::arrayValue;
+
+	for(const fileTest & test : _tests)
+	{
+		Json::Value file	= Json::objectValue;
+		file["file"]		= test.relativePath.toStdString();
+		file["result"]		= test.exitCode == 0 ? "passed" : test.timedOut ? "timed out" : "failed";
+		file["exitCode"]	= test.exitCode;
+		file["wallMs"]		= Json::Int64(test.wallMs);
+		file["slower"]		= test.slower;
+
+		if(test.timings.isObject())
+		{
+			file["refreshMs"]	= test.timings["refreshMs"];
+			file["analyses"]	= test.timings["analyses"];
+		}
+
+		files.append(file);
+	}
+
+	report["jobs"]				= _jobs;
+	report["slowerByPercent"]	= _slowerByPercent;
+	report["total"]				= int(_tests.size());
+	report["failures"]			= _failures;
+	report["regressions"]		= _regressions;
+	report["files"]				= files;
+
+	std::ofstream out(reportPath.toStdString());
+	out << report.toStyledString();
+
+	if(!out.good())
+		std::cerr << "Could not write timing report to " << reportPath.toStdString() << std::endl;
+	else
+		std::cout << "Timing report written to " << reportPath.toStdString() << std::endl;
+
+	return out.good();
+}
+
+}
@@ -0,0 +1,58 @@
+#ifndef UNITTESTRUNNER_H
+#define UNITTESTRUNNER_H
+
+#include <QString>
+#include <QStringList>
+#include <json/json.h>
+#include <map>
+
+namespace resultXmlCompare
+{
+
+///
+/// Runs a --unitTest for every jasp-file found under a folder, this is what --unitTestRecursive does.
+/// Each file gets its own JASP process (and thereby its own engines) and up to `jobs` of those run at the same time, so a big data library can be spread over the cores of a machine.
+/// Next to passing or failing it records how long each file took and, through compareResults::writeTimings, how long each analysis in it took.
+/// Those timings can be written to a report and compared to an earlier report (the baseline), a file or analysis that became clearly slower counts as a failure just like different results do.
+class unitTestRunner
+{
+public:
+			unitTestRunner(const QString & program, int jobs, int timeOut, bool save, bool hide);
+
+	bool	setBaseline(const QString & reportPath, int slowerByPercent);
+	int		run(const QString & folder);					///< Returns the exitcode for --unitTestRecursive
+	bool	writeReport(const QString & reportPath) const;
+
+private:
+	struct fileTest
+	{
+		QString		path,
+					relativePath;	///< To the folder, so that a baseline made on a different machine still matches
+		int			exitCode	= -1;
+		bool		timedOut	= false,
+					slower		= false;
+		long		wallMs		= -1;
+		Json::Value	timings		= Json::nullValue;
+	};
+
+	void		collectFiles(const QString & path, const QString & folder);
+	QStringList	argumentsFor(const fileTest & test, const QString & timingsPath) const;
+	void		readTimings(fileTest & test, const QString & timingsPath);
+	void		compareToBaseline(fileTest & test);
+
+	QString									_program;
+	int										_jobs,
+											_timeOut,
+											_slowerByPercent	= 25,
+											_baselineJobs		= 1;	///< The --jobs the baseline was made with, its timings are only compared when that is the same
+	bool									_save,
+											_hide;
+	std::vector<fileTest>					_tests;
+	std::map<std::string, Json::Value>		_baseline;			///< relativePath -> what the report said about that file
+	int										_failures			= 0,
+											_regressions		= 0;
+};
+
+}
+
+#endif // UNITTESTRUNNER_H
@@ -79,6 +79,8 @@ const Settings::Setting Settings::Values[] = {
 	{"dbImportPassword",			""		},
 	{"dbImportQuery",				""		},
 	{"dbImportInterval",			0		},
+	{"dbImportSyncKey",				""		},
+	{"dbImportSyncModified",		""		},
 	{"dbShowWarning",				true	},
 	{"dbRememberMe",				false	},
 	{"dataNALabel",					"."		},
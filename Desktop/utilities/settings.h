@@ -64,6 +64,8 @@ public:
 		DB_IMPORT_PASSWORD,
 		DB_IMPORT_QUERY,
 		DB_IMPORT_INTERVAL,
+		DB_IMPORT_SYNCKEY,
+		DB_IMPORT_SYNCMODIFIED,
 		DB_SHOW_WARNING,
 		DB_REMEMBER_ME,
 		DATA_LABEL_NA,
@@ -46,6 +46,8 @@ DatabaseFileMenu::DatabaseFileMenu(FileMenu *parent)
 	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::lastErrorChanged		);
 	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::portChanged			);
 	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::queryChanged			);
+	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::syncKeyChanged		);
+	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::syncModifiedChanged	);
 	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::resultsOKChanged		);
 	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::intervalChanged		);
 	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::rememberMeChanged	);
@@ -60,6 +62,8 @@ void DatabaseFileMenu::loadFromSettings()
 	_info._username		=						Settings::value( Settings::DB_IMPORT_USERNAME	).toString();
 	_info._password		= decrypt(				Settings::value( Settings::DB_IMPORT_PASSWORD	).toString());
 	_info._query		=						Settings::value( Settings::DB_IMPORT_QUERY		).toString();
+	_info._syncKey		=						Settings::value( Settings::DB_IMPORT_SYNCKEY	).toString();
+	_info._syncModified	=						Settings::value( Settings::DB_IMPORT_SYNCMODIFIED).toString();
 	_info._interval		=						Settings::value( Settings::DB_IMPORT_INTERVAL	).toInt();
 	_info._rememberMe	=						Settings::value( Settings::DB_REMEMBER_ME		).toBool();
 	
@@ -316,6 +320,30 @@ void DatabaseFileMenu::setQuery(const QString &newQuery)
 	emit queryChanged();
 }
 
+void DatabaseFileMenu::setSyncKey(const QString &newSyncKey)
+{
+	if (_info._syncKey == newSyncKey)
+		return;
+	
+	_info._syncKey = newSyncKey;
+	if(useDataSetPackage())	DataSetPackage::pkg()->setDatabaseJson(_info.toJson());
+	else					Settings::setValue(Settings::DB_IMPORT_SYNCKEY, _info._syncKey);
+	
+	emit syncKeyChanged();
+}
+
+void DatabaseFileMenu::setSyncModified(const QString &newSyncModified)
+{
+	if (_info._syncModified == newSyncModified)
+		return;
+	
+	_info._syncModified = newSyncModified;
+	if(useDataSetPackage())	DataSetPackage::pkg()->setDatabaseJson(_info.toJson());
+	else					Settings::setValue(Settings::DB_IMPORT_SYNCMODIFIED, _info._syncModified);
+	
+	emit syncModifiedChanged();
+}
+
 void DatabaseFileMenu::setResultsOK(bool newResultsOK)
 {
 	if (_resultsOK == newResultsOK)
@@ -19,6 +19,8 @@ class DatabaseFileMenu : public FileMenuObject
 	Q_PROPERTY(bool			connected	READ connected		WRITE setConnected		NOTIFY connectedChanged		)
 	Q_PROPERTY(QString		queryResult READ queryResult	WRITE setQueryResult	NOTIFY queryResultChanged	)
 	Q_PROPERTY(QString		query		READ query			WRITE setQuery			NOTIFY queryChanged			)
+	Q_PROPERTY(QString		syncKey		READ syncKey		WRITE setSyncKey		NOTIFY syncKeyChanged		)
+	Q_PROPERTY(QString		syncModified READ syncModified	WRITE setSyncModified	NOTIFY syncModifiedChanged	)
 	Q_PROPERTY(QStringList	dbTypes		READ dbTypes								NOTIFY dbTypesChanged		)
 	Q_PROPERTY(QString		lastError	READ lastError								NOTIFY lastErrorChanged		)
 	Q_PROPERTY(int			port		READ port			WRITE setPort			NOTIFY portChanged			)
@@ -46,6 +48,8 @@ public:
 	const QString		&		lastError()			const { return _lastError;							}
 	int							port()				const { return _info._port;							}
 	const QString		&		query()				const { return _info._query;						}
+	const QString		&		syncKey()			const { return _info._syncKey;						}
+	const QString		&		syncModified()		const { return _info._syncModified;					}
 	bool						resultsOK()			const { return _resultsOK;							}
 	int							interval()			const { return _info._interval;						}
 	bool						dbMaybeFile()		const { return _info._dbType == DbType::QSQLITE;	}
@@ -61,6 +65,8 @@ public:
 	void						setUsername(	const QString & newUsername		);
 	void						setPassword(	const QString & newPassword		);
 	void						setQuery(		const QString &	newQuery		);
+	void						setSyncKey(		const QString &	newSyncKey		);
+	void						setSyncModified(const QString &	newSyncModified	);
 	void						setPort(		int				newPort			);
 	void						setConnected(	bool			newConnected	);
 	void						setQueryResult(	const QString & newQueryResult	);
@@ -85,6 +91,8 @@ signals:
 	void						lastErrorChanged();
 	void						portChanged();
 	void						queryChanged();
+	void						syncKeyChanged();
+	void						syncModifiedChanged();
 	void						resultsOKChanged();
 	void						intervalChanged();
 	void						rememberMeChanged();
@@ -28,10 +28,17 @@
 #include "log.h"
 #include "databaseinterface.h"
 #include "r_functionwhitelist.h"
+#include "messagecodec.h"
+#include "tracing.h"
 
 void SendFunctionForJaspresults(const char * msg) { Engine::theEngine()->sendString(msg); }
 bool PollMessagesFunctionForJaspResults()
 {
+	Engine::theEngine()->outboxFlush(false);
+
+	if(!Engine::theEngine()->controlChanged())
+		return false;
+
 	if(Engine::theEngine()->receiveMessages())
 	{
 		if(Engine::theEngine()->paused())
@@ -61,6 +68,8 @@ bool PollMessagesFunctionForJaspResults()
 
 Engine * Engine::_EngineInstance = NULL;
 
+static const std::string extraEncodingsPrefix = "JaspExtraOptions_";
+
 Engine::Engine(int slaveNo, unsigned long parentPID)
 	: _engineNum(slaveNo), _parentPID(parentPID)
 {
@@ -75,7 +84,7 @@ Engine::Engine(int slaveNo, unsigned long parentPID)
 	if(parentPID != 0) //Otherwise we are just running to fix R packages
 		_db = new DatabaseInterface();
 
-	_extraEncodings = new ColumnEncoder("JaspExtraOptions_");
+	_extraEncodings = new ColumnEncoder(extraEncodingsPrefix);
 }
 
 void Engine::initialize()
@@ -140,6 +149,20 @@ void Engine::run()
 	_channel = nullptr;
 }
 
+///A single atomic load, so R can afford to ask this in its tightest loops, only when the Desktop published something new do we actually read and parse what it sent
+bool Engine::controlChanged()
+{
+	const uint64_t control = _channel->control();
+
+	if(control == _controlSeen)
+		return false;
+
+	JASPLOG(debug, ipc) << "Desktop published control flags " << int(control & 0xFF) << " for revision " << IPCChannel::controlRevision(control) << std::endl;
+
+	_controlSeen = control;
+	return true;
+}
+
 void Engine::beIdle(bool newlyIdle)
 {
 	static int idleStartTime = -1;
@@ -177,34 +200,40 @@ bool Engine::receiveMessages(int timeout)
 		
 
 		Json::Value		jsonRequest;
-		Json::Reader	jsonReader;
+		std::string		parseError;
+		bool			parsed = MessageCodec::decode(data, jsonRequest, &parseError);
 
-		if(!jsonReader.parse(data, jsonRequest, false))
+		if(!parsed)
 		{
 			Log::log() << "Engine got request:\nrow 0:\t";
 
 			size_t row=0;
-			for(const char & c : data)
-			{
-				if(c == '\n')
-					Log::log() << "\nrow " << ++row << ":\t";
-				Log::log() << c;
-			}
-
-			Log::log() << "Parsing request failed on:\n" << jsonReader.getFormattedErrorMessages() << std::endl;
-			// Log::log() << "Parsing request failed on:\n" << err << std::endl;
+			if(MessageCodec::isBinary(data.data(), data.data() + data.size()))
+				Log::log() << "<" << data.size() << " bytes of CBOR>";
+			else
+				for(const char & c : data)
+				{
+					if(c == '\n')
+						Log::log() << "\nrow " << ++row << ":\t";
+					Log::log() << c;
+				}
+
+			Log::log() << "Parsing request failed on:\n" << parseError << std::endl;
 		}
 
 		//Clear send buffer and anonymized log
-		Json::Value printData;
-		bool parsed = jsonReader.parse(data, printData);
-		if (parsed && printData.isMember("GITHUB_PAT")) {
-			printData["GITHUB_PAT"] = "********";
+		if(Log::enabled(logLevel::info, logCategory::ipc))
+		{
+			Json::Value printData = parsed ? jsonRequest : Json::nullValue;
+			if (parsed && printData.isMember("GITHUB_PAT")) {
+				printData["GITHUB_PAT"] = "********";
+			}
+			
+			Log::log(logLevel::info, logCategory::ipc) << "Received: '" << Log::json(printData) << "' so now clearing my send buffer" << std::endl;
 		}
-		
-		Log::log() << "Received: '" << printData.toStyledString() << "' so now clearing my send buffer" << std::endl;
 
-		sendString("");
+		_outboxLastRunningHash = 0;
+		_channel->send("");
 
 		//Check if we got anyting useful
 		std::string typeSend	= jsonRequest.get("typeRequest", Json::nullValue).asString();
@@ -307,7 +336,7 @@ void Engine::sendFilterResult(int filterRequestId)
 //	for(bool f : filterResult)	filterResponse["filterResult"].append(f);
 //	if(warning != "")			filterResponse["filterError"] = warning;
 
-	sendString(filterResponse.toStyledString());
+	sendJson(filterResponse);
 }
 
 void Engine::sendFilterError(int filterRequestId, const std::string & errorMessage)
@@ -320,7 +349,7 @@ void Engine::sendFilterError(int filterRequestId, const std::string & errorMessa
 	filterResponse["requestId"]		= filterRequestId;
 	filterResponse["error"]			= errorMessage;
 
-	sendString(filterResponse.toStyledString());
+	sendJson(filterResponse);
 }
 
 void Engine::receiveRCodeMessage(const Json::Value & jsonRequest)
@@ -394,7 +423,7 @@ void Engine::sendRCodeResult(int rCodeRequestId, const std::string & rCodeResult
 	rCodeResponse["requestId"]		= rCodeRequestId;
 
 
-	sendString(rCodeResponse.toStyledString());
+	sendJson(rCodeResponse);
 }
 
 void Engine::sendRCodeError(int rCodeRequestId)
@@ -407,7 +436,7 @@ void Engine::sendRCodeError(int rCodeRequestId)
 	rCodeResponse["rCodeError"]		= RError.size() == 0 ? "R Code failed for unknown reason. Check that R function returns a string." : RError;
 	rCodeResponse["requestId"]		= rCodeRequestId;
 
-	sendString(rCodeResponse.toStyledString());
+	sendJson(rCodeResponse);
 }
 
 void Engine::receiveComputeColumnMessage(const Json::Value & jsonRequest)
@@ -417,14 +446,28 @@ void Engine::receiveComputeColumnMessage(const Json::Value & jsonRequest)
 
 	_engineState = engineState::computeColumn;
 
-	std::string	computeColumnName =						 jsonRequest.get("columnName",  "").asString();
-	std::string	computeColumnCode =						 jsonRequest.get("computeCode", "").asString();
-	columnType	computeColumnType = columnTypeFromString(jsonRequest.get("columnType",  "").asString());
+	JASPTIMER_SCOPE(Engine::receiveComputeColumnMessage);
+
+	Json::Value computeColumnsResponse			= Json::objectValue;
+	computeColumnsResponse["typeRequest"]		= engineStateToString(engineState::computeColumn);
+	computeColumnsResponse["computeColumns"]	= Json::arrayValue;
+
+	//Desktop sends all computed columns that were waiting at once, they are computed in the order they were invalidated in
+	for(const Json::Value & computeColumn : jsonRequest.get("computeColumns", Json::arrayValue))
+	{
+		std::string	computeColumnName =						 computeColumn.get("columnName",  "").asString();
+		std::string	computeColumnCode =						 computeColumn.get("computeCode", "").asString();
+		columnType	computeColumnType = columnTypeFromString(computeColumn.get("columnType",  "").asString());
 
-	runComputeColumn(computeColumnName, computeColumnCode, computeColumnType, jsonRequest.get("forceType", false).asBool());
+		computeColumnsResponse["computeColumns"].append(runComputeColumn(computeColumnName, computeColumnCode, computeColumnType, computeColumn.get("forceType", false).asBool()));
+	}
+
+	sendJson(computeColumnsResponse);
+
+	_engineState = engineState::idle;
 }
 
-void Engine::runComputeColumn(const std::string & computeColumnName, const std::string & computeColumnCode, columnType computeColumnType, bool forceType)
+Json::Value Engine::runComputeColumn(const std::string & computeColumnName, const std::string & computeColumnCode, columnType computeColumnType, bool forceType)
 {
 	Log::log() << "Engine::runComputeColumn()" << std::endl;
 
@@ -435,7 +478,6 @@ void Engine::runComputeColumn(const std::string & computeColumnName, const std::
 		{columnType::nominalText,	".setColumnDataAsNominalText"	}};
 
 	Json::Value computeColumnResponse		= Json::objectValue;
-	computeColumnResponse["typeRequest"]	= engineStateToString(engineState::computeColumn);
 	computeColumnResponse["columnName"]		= computeColumnName;
 	
     if(provideAndUpdateDataSet())
@@ -469,9 +511,7 @@ void Engine::runComputeColumn(const std::string & computeColumnName, const std::
 		computeColumnResponse["error"]			= "No DataSet loaded in engine!";
 	}
 
-	sendString(computeColumnResponse.toStyledString());
-	
-	_engineState = engineState::idle;
+	return computeColumnResponse;
 }
 
 void Engine::receiveModuleRequestMessage(const Json::Value & jsonRequest)
@@ -502,7 +542,7 @@ void Engine::receiveModuleRequestMessage(const Json::Value & jsonRequest)
 
 	Log::log() << "Sending it." << std::endl;
 
-	sendString(jsonAnswer.toStyledString());
+	sendJson(jsonAnswer);
 
 	_engineState = engineState::idle;
 }
@@ -515,9 +555,7 @@ void Engine::receiveAnalysisMessage(const Json::Value & jsonRequest)
 	int analysisId		= jsonRequest.get("id",			-1).asInt();
 	performType perform	= performTypeFromString(jsonRequest.get("perform", "run").asString());
 	
-#ifdef PRINT_ENGINE_MESSAGES
-	Log::log() << "Engine::receiveAnalysisMessage:\n" << jsonRequest.toStyledString() << " while current analysisStatus is: " << engineAnalysisStatusToString(_analysisStatus) << "\n";
-#endif
+	JASPLOG(debug, ipc) << "Engine::receiveAnalysisMessage:\n" << Log::json(jsonRequest) << " while current analysisStatus is: " << engineAnalysisStatusToString(_analysisStatus) << std::endl;
 
 	if (analysisId == _analysisId && _analysisStatus == Status::running)
 	{
@@ -581,25 +619,306 @@ void Engine::receiveAnalysisMessage(const Json::Value & jsonRequest)
 }
 
 
+///jaspResults sends the whole results whenever something changed, but the channel only holds a single message so the Desktop only ever sees the newest one anyway.
+///That is why a message waits in the outbox until the Desktop picked up the previous one, and anything newer replaces it there without it ever being parsed.
 void Engine::sendString(std::string message)
 {
+	_outbox = std::move(message);
+	outboxFlush(false);
+}
+
+typedef std::vector<std::pair<std::string_view, std::string_view>> jsonMembers;
+
+///Finds the names and the (still encoded) values of the members of the outermost object in a single pass, without parsing or copying any of it.
+///Only meant for what jaspResults writes, so anything unexpected like comments or CBOR just returns false.
+static bool jsonTopLevelMembers(std::string_view json, jsonMembers & members)
+{
+	const char	*	whitespace	= " \t\r\n";
+	size_t			pos			= json.find_first_not_of(whitespace);
+
+	auto skipWhitespace = [&]()	{ pos = json.find_first_not_of(whitespace, pos); return pos != std::string_view::npos; };
+	auto skipString		= [&]()
+	{
+		for(pos++; pos < json.size(); pos++)
+			if		(json[pos] == '\\')	pos++;
+			else if	(json[pos] == '"')	{ pos++; return true; }
+
+		return false;
+	};
+	auto skipValue		= [&]()
+	{
+		if(json[pos] == '"')
+			return skipString();
+
+		if(json[pos] != '{' && json[pos] != '[')
+		{
+			pos = json.find_first_of(",}] \t\r\n", pos);
+			return pos != std::string_view::npos;
+		}
+
+		for(size_t depth = 0; pos < json.size();)
+			switch(json[pos])
+			{
+			case '"':	if(!skipString()) return false;			break;
+			case '{':
+			case '[':	depth++; pos++;							break;
+			case '}':
+			case ']':	pos++; if(--depth == 0) return true;	break;
+			default:	pos++;									break;
+			}
+
+		return false;
+	};
+
+	if(pos == std::string_view::npos || json[pos++] != '{')
+		return false;
+
+	while(skipWhitespace() && json[pos] == '"')
+	{
+		const size_t nameStart = pos + 1;
+
+		if(!skipString())
+			return false;
+
+		const std::string_view name = json.substr(nameStart, pos - 1 - nameStart);
+
+		if(!skipWhitespace() || json[pos++] != ':' || !skipWhitespace())
+			return false;
+
+		const size_t valueStart = pos;
+
+		if(!skipValue())
+			return false;
+
+		members.push_back(std::make_pair(name, json.substr(valueStart, pos - valueStart)));
+
+		if(!skipWhitespace())
+			return false;
+
+		if		(json[pos] == ',')	pos++;
+		else if	(json[pos] == '}')	return true;
+		else						return false;
+	}
+
+	return json.size() > pos && json[pos] == '}';
+}
+
+static std::string_view jsonMember(const jsonMembers & members, std::string_view name)
+{
+	for(const auto & member : members)
+		if(member.first == name)
+			return member.second;
+
+	return {};
+}
+
+///With force it doesn't wait for the Desktop, which is what the last message an analysis sends needs.
+///When only the progressbar moved there is no need to decode, encode and send all results again, if the Desktop got them already.
+///That is recognized on the text jaspResults sent, so such a message is never parsed whole, only what is left of it without the results.
+void Engine::outboxFlush(bool force)
+{
+	if(_outbox == "" || (!force && !_channel->lastSentReceived()))
+		return;
+
+	JASPTIMER_SCOPE(Engine::outboxFlush);
+
+	std::string message;
+	std::swap(message, _outbox);
+
+	jsonMembers	members;
+	size_t		runningHash = 0; //Of the id, revision and results of a running analysis message, 0 for anything else
+
+	if(	jsonTopLevelMembers(message, members)																		&&
+		jsonMember(members, "typeRequest")	== "\"" + engineStateToString(engineState::analysis) + "\""					&&
+		jsonMember(members, "status")		== "\"" + analysisResultStatusToString(analysisResultStatus::running) + "\""	&&
+		!jsonMember(members, "results").empty()																	)
+	{
+		runningHash = std::hash<std::string_view>{}(jsonMember(members, "results"));
+
+		for(std::string_view name : {"id", "revision"})
+			runningHash ^= std::hash<std::string_view>{}(jsonMember(members, name)) + 0x9e3779b97f4a7c15 + (runningHash << 6) + (runningHash >> 2);
+
+		runningHash = std::max<size_t>(runningHash, 1);
+	}
+
+	if(runningHash && runningHash == _outboxLastRunningHash && _channel->lastSentReceived())
+	{
+		std::string withoutResults = "{";
+
+		for(const auto & member : members)
+			if(member.first != "results")
+				withoutResults.append(withoutResults.size() > 1 ? ",\"" : "\"").append(member.first).append("\":").append(member.second);
+
+		message = withoutResults + "}";
+	}
+
+	_outboxLastRunningHash = runningHash;
+
 	ColumnUtils::convertEscapedUnicodeToUTF8(message);
 
 	Json::Value msgJson;
 
-	// JSONCPP_STRING          err;
-	// Json::CharReaderBuilder jsonReaderBuilder;
-	// std::unique_ptr<Json::CharReader> const jsonReader(jsonReaderBuilder.newCharReader());
+	if(!MessageCodec::decode(message, msgJson)) //If everything is converted to jaspResults maybe we can do this there?
+	{
+		_outboxLastRunningHash = 0;
+		_channel->send(message);
+		return;
+	}
 
-	// if(jsonReader->parse(message.c_str(), message.c_str() + message.length(), &msgJson, &err)) //If everything is converted to jaspResults maybe we can do this there?
+	sendDecodedJson(msgJson);
+}
 
-	if(Json::Reader().parse(message, msgJson)) //If everything is converted to jaspResults maybe we can do this there?
+///R might have left <U+XXXX> escapes in any string, sendString got rid of those in the text before parsing so here it is done per string instead.
+static void convertEscapedUnicodeInJson(Json::Value & json)
+{
+	switch(json.type())
 	{
-		ColumnEncoder::columnEncoder()->decodeJsonSafeHtml(msgJson); // decode all columnnames as far as you can
-		_channel->send(msgJson.toStyledString());
+	case Json::stringValue:
+	{
+		const char	*	begin;
+		const char	*	end;
+		json.getString(&begin, &end);
+
+		if(std::string_view(begin, end - begin).find("<U+") != std::string_view::npos)
+		{
+			std::string converted(begin, end);
+			ColumnUtils::convertEscapedUnicodeToUTF8(converted);
+			json = converted;
+		}
+		return;
+	}
+
+	case Json::arrayValue:
+	case Json::objectValue:
+		for(Json::Value & element : json)
+			convertEscapedUnicodeInJson(element);
+		return;
+
+	default:
+		return;
 	}
-	else
-		_channel->send(message);
+}
+
+///For messages the engine builds itself, going through sendString would mean writing them out and parsing them again just to get back where we started
+void Engine::sendJson(Json::Value & msg)
+{
+	outboxFlush(true); //Whatever jaspResults sent came first
+	_outboxLastRunningHash = 0;
+
+	convertEscapedUnicodeInJson(msg);
+	sendDecodedJson(msg);
+}
+
+///Decoding the column names in results used to go over every string once for every column, a MultiReplacer does it in a single pass.
+///What an encoded name becomes is still up to the ColumnEncoder, so they are built by having it decode each name on its own, and only again when the names changed.
+void Engine::columnNameDecodersUpdate()
+{
+	const stringvec & encoded = ColumnEncoder::columnNamesEncoded();
+
+	if(encoded == _columnNameDecodersFor)
+		return;
+
+	JASPTIMER_SCOPE(Engine::columnNameDecodersUpdate);
+
+	strstrmap values, members;
+
+	for(const std::string & name : encoded)
+	{
+		Json::Value value	= name,
+					member	= Json::objectValue;
+		member[name]		= true;
+
+		ColumnEncoder::columnEncoder()->decodeJsonSafeHtml(value);
+		ColumnEncoder::columnEncoder()->decodeJsonSafeHtml(member);
+
+		values[name]	= value.asString();
+		members[name]	= member.getMemberNames()[0];
+	}
+
+	_columnNameDecoderValues	.set(values);
+	_columnNameDecoderMembers	.set(members);
+	_columnNameDecodersFor		= encoded;
+}
+
+///Does what ColumnEncoder::decodeJsonSafeHtml does, except that anything with the extra encodings of the current analysis in it is left to the ColumnEncoder itself
+void Engine::decodeColumnNamesInJson(Json::Value & json)
+{
+	switch(json.type())
+	{
+	case Json::stringValue:
+	{
+		const char	*	begin;
+		const char	*	end;
+		json.getString(&begin, &end);
+
+		std::string_view text(begin, end - begin);
+
+		if(text.find(extraEncodingsPrefix) != std::string_view::npos)
+			ColumnEncoder::columnEncoder()->decodeJsonSafeHtml(json);
+
+		else if(_columnNameDecoderValues.contains(text))
+		{
+			std::string decoded(text);
+			_columnNameDecoderValues.replaceAll(decoded);
+			json = decoded;
+		}
+		return;
+	}
+
+	case Json::arrayValue:
+		for(Json::Value & element : json)
+			decodeColumnNamesInJson(element);
+		return;
+
+	case Json::objectValue:
+	{
+		const stringvec members = json.getMemberNames();
+
+		for(const std::string & member : members)
+			if(member.find(extraEncodingsPrefix) != std::string::npos)
+			{
+				ColumnEncoder::columnEncoder()->decodeJsonSafeHtml(json);
+				return;
+			}
+
+		for(const std::string & member : members)
+		{
+			decodeColumnNamesInJson(json[member]);
+
+			std::string decoded = member;
+
+			if(_columnNameDecoderMembers.replaceAll(decoded))
+			{
+				json[decoded] = std::move(json[member]);
+				json.removeMember(member);
+			}
+		}
+		return;
+	}
+
+	default:
+		return;
+	}
+}
+
+void Engine::sendDecodedJson(Json::Value & msg)
+{
+	columnNameDecodersUpdate();
+	decodeColumnNamesInJson(msg); // decode all columnnames as far as you can
+
+	if(Tracing::enabled() && msg.isObject())
+	{
+		Json::Value spans = Tracing::takeSpansForRemote(); //Desktop keeps the timeline, so whatever we traced goes along with whatever we send anyway
+		
+		if(!spans.isNull())
+			msg["traceSpans"] = spans;
+	}
+
+	//Desktop keeps track of how much memory each engine holds on to, and a finished analysis is when that changes the most
+	if(msg.isObject() && msg.get("typeRequest", "").asString() == engineStateToString(engineState::analysis) && msg.get("status", "").asString() != analysisResultStatusToString(analysisResultStatus::running))
+		msg["engineMemory"] = Json::UInt64(ProcessInfo::residentMemory());
+
+	_channel->send(MessageCodec::encode(msg));
 }
 
 
@@ -634,6 +953,8 @@ void Engine::runAnalysis()
 								encodedAnalysisOptions.toStyledString(),
 								_analysisStateKey, _analysisId, _analysisRevision, _developerMode);
 
+	outboxFlush(true);
+
 	switch(_analysisStatus)
 	{
 	case Status::aborted:
@@ -721,6 +1042,7 @@ void Engine::editImage()
 void Engine::rewriteImages()
 {
 	jaspRCPP_rewriteImages(_analysisName.c_str(), _analysisId);
+	outboxFlush(true);
 
 	/* Already sent from R! (Through jaspResultsCPP$send())
 	_analysisStatus				= Status::complete;
@@ -815,7 +1137,7 @@ void Engine::sendAnalysisResults()
 	response["results"] = _analysisResults.get("results", _analysisResults);
 	response["status"]  = analysisResultStatusToString(resultStatus);
 
-	sendString(response.toStyledString());
+	sendJson(response);
 }
 
 void Engine::removeNonKeepFiles(const Json::Value & filesToKeepValue)
@@ -914,7 +1236,7 @@ void Engine::sendEngineStopped()
 {
 	Json::Value rCodeResponse		= Json::objectValue;
 	rCodeResponse["typeRequest"]	= engineStateToString(_engineState);
-	sendString(rCodeResponse.toStyledString());
+	sendJson(rCodeResponse);
 }
 
 void Engine::pauseEngine(const Json::Value & json)
@@ -959,6 +1281,8 @@ void Engine::receiveReloadData()
 	//First send state, then load data
 	sendEngineLoadingData();
 
+	_db->reconnect(); //Desktop might have replaced internal.sqlite by loading a jasp-file
+
         provideAndUpdateDataSet(); //Also triggers loading from DB
 
 	reloadColumnNames();
@@ -971,7 +1295,7 @@ void Engine::sendEnginePaused()
 	Json::Value rCodeResponse		= Json::objectValue;
 	rCodeResponse["typeRequest"]	= engineStateToString(engineState::paused);
 
-	sendString(rCodeResponse.toStyledString());
+	sendJson(rCodeResponse);
 }
 
 void Engine::reloadColumnNames()
@@ -998,7 +1322,7 @@ void Engine::sendEngineResumed(bool justReloadedData)
 	response["typeRequest"]			= engineStateToString(engineState::resuming);
 	response["justReloadedData"]	= justReloadedData;
 
-	sendString(response.toStyledString());
+	sendJson(response);
 }
 
 void Engine::sendEngineLoadingData()
@@ -1008,7 +1332,7 @@ void Engine::sendEngineLoadingData()
 	Json::Value response	= Json::objectValue;
 	response["typeRequest"]	= engineStateToString(engineState::reloadData);
 
-	sendString(response.toStyledString());
+	sendJson(response);
 }
 
 void Engine::receiveLogCfg(const Json::Value & jsonRequest)
@@ -1023,7 +1347,7 @@ void Engine::receiveLogCfg(const Json::Value & jsonRequest)
 	Json::Value logCfgResponse		= Json::objectValue;
 	logCfgResponse["typeRequest"]	= engineStateToString(engineState::logCfg);
 
-	sendString(logCfgResponse.toStyledString());
+	sendJson(logCfgResponse);
 
 	_engineState = engineState::idle;
 }
@@ -1062,7 +1386,7 @@ void Engine::receiveSettings(const Json::Value & jsonRequest)
 	Json::Value response	= Json::objectValue;
 	response["typeRequest"]	= engineStateToString(engineState::settings);
 
-	sendString(response.toStyledString());
+	sendJson(response);
 
 	_engineState = engineState::idle;
 }
@@ -23,6 +23,7 @@
 #include "ipcchannel.h"
 #include <json/json.h>
 #include "columnencoder.h"
+#include "multireplacer.h"
 
 /// The Engine handles communication between Desktop and R
 /// It can be in a variety of states _currentEngineState and can run analyses, filters, compute columns and Rcode.
@@ -40,7 +41,10 @@ public:
 	bool					receiveMessages(int timeout = 0);
 	void					setSlaveNo(int no);
 	int						engineNum() const { return _engineNum; }
-	void					sendString(std::string message);
+	void					sendString(std::string message);	///< Goes through the outbox, see outboxFlush
+	void					sendJson(Json::Value & msg);
+	void					outboxFlush(bool force);
+	bool					controlChanged();									///< Whether the Desktop sent something since the last time we asked
 
 	
 
@@ -67,6 +71,9 @@ public:
 private:
 	void					initialize();
 	void					beIdle(bool newlyIdle);
+	void					sendDecodedJson(Json::Value & msg);
+	void					columnNameDecodersUpdate();
+	void					decodeColumnNamesInJson(Json::Value & json);
 
 	void					receiveRCodeMessage(			const Json::Value & jsonRequest);
 	void					receiveFilterMessage(			const Json::Value & jsonRequest);
@@ -79,7 +86,7 @@ private:
 	void					absorbSettings(					const Json::Value & json);
 
 	void					runAnalysis();
-	void					runComputeColumn(	const std::string & computeColumnName,	const std::string & computeColumnCode,	columnType computeColumnType,	bool forceType);
+	Json::Value				runComputeColumn(	const std::string & computeColumnName,	const std::string & computeColumnCode,	columnType computeColumnType,	bool forceType);
 	void					runFilter(			const std::string & filter,				const std::string & generatedFilter,	int filterRequestId				);
 	void					runRCode(			const std::string & rCode,				int rCodeRequestId,						bool whiteListed				);
 	void					runRCodeCommander(		  std::string   rCode																						);
@@ -137,9 +144,15 @@ private: // Data:
 							_analysisRFile			= "",
 							_dynamicModuleCall		= "",
 							_langR					= "en";
+	uint64_t				_controlSeen			= 0;
+	std::string				_outbox;										///< Newest message from jaspResults that the Desktop hasn't gotten yet
+	MultiReplacer			_columnNameDecoderValues,						///< Encoded column names to what ColumnEncoder::decodeJsonSafeHtml makes of them in a string
+							_columnNameDecoderMembers;						///< Same but as the name of a member, see columnNameDecodersUpdate
+	stringvec				_columnNameDecodersFor;							///< The encoded names the decoders were built for
 	Json::Value				_imageOptions,
 							_analysisOptions		= Json::nullValue,
 							_analysisResults;
+	size_t					_outboxLastRunningHash	= 0;					///< Of the id, revision and results in the text of the last running message sent, to recognize ones that only change the progress
 
 
 };
@@ -106,6 +106,7 @@ int main(int argc, char *argv[])
 		Log::setLogFileName(logFileBase + " Engine " + std::to_string(slaveNo) + ".log");
 		Log::setWhere(logTypeFromString(logFileWhere));
 		Log::setEngineNo(slaveNo);
+		Tracing::setProcessName("Engine " + std::to_string(slaveNo));
 
 		Log::log() << "Log and possible redirects initialized!" << std::endl;
 		Log::log() << "jaspEngine started and has slaveNo " << slaveNo << " and it's parent PID is " << parentPID << std::endl;
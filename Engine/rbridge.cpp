@@ -755,6 +755,8 @@ std::string rbridge_evalRCodeWhiteListed(const std::string & rCode, bool setWd)
 
 std::string rbridge_evalRComputedColumn(const std::string &rCode, const std::string & setColumnFunc)
 {
+	JASPTIMER_SCOPE(rbridge_evalRComputedColumn);
+
 	rbridge_dataSet = rbridge_engine->provideAndUpdateDataSet();
 	int rowCount	= rbridge_dataSet == nullptr ? 0 : rbridge_dataSet->rowCount();
 
@@ -131,6 +131,17 @@ size_t Term::size() const
 	return _components.size();
 }
 
+size_t Term::hash() const
+{
+	size_t hash = 0;
+
+	for(int i=0; i<_components.size(); i++)
+		if(_components.indexOf(_components[i]) == i) //operator== only checks whether all components are there, so a component that occurs twice shouldn't count twice either
+			hash += qHash(_components[i]);
+
+	return hash ^ (_components.size() * 0x9E3779B97F4A7C15ull);
+}
+
 bool Term::replaceVariableName(const std::string & oldName, const std::string & newName)
 {
 	bool changed = false;
@@ -67,6 +67,7 @@ public:
 	bool operator<(const Term &other) const;
 
 	size_t size() const;
+	size_t hash() const;	///< Doesn't depend on the order of the components, just like operator==
 
 	bool replaceVariableName(const std::string & oldName, const std::string & newName);
 
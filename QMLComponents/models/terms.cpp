@@ -64,7 +64,7 @@ Terms::Terms(Terms *parent)
 
 void Terms::set(const std::vector<Term> &terms, bool isUnique)
 {
-	_terms.clear();
+	clear();
 
 	for(const Term &term : terms)
 		add(term, isUnique);
@@ -72,7 +72,7 @@ void Terms::set(const std::vector<Term> &terms, bool isUnique)
 
 void Terms::set(const std::vector<string> &terms, bool isUnique)
 {
-	_terms.clear();
+	clear();
 
 	for(const Term &term : terms)
 		add(term, isUnique);
@@ -80,7 +80,7 @@ void Terms::set(const std::vector<string> &terms, bool isUnique)
 
 void Terms::set(const std::vector<std::vector<string> > &terms, bool isUnique)
 {
-	_terms.clear();
+	clear();
 
 	for(const Term &term : terms)
 		add(term, isUnique);
@@ -88,7 +88,7 @@ void Terms::set(const std::vector<std::vector<string> > &terms, bool isUnique)
 
 void Terms::set(const QList<Term> &terms, bool isUnique)
 {
-	_terms.clear();
+	clear();
 
 	for(const Term &term : terms)
 		add(term, isUnique);
@@ -96,7 +96,7 @@ void Terms::set(const QList<Term> &terms, bool isUnique)
 
 void Terms::set(const Terms &terms, bool isUnique)
 {
-	_terms.clear();
+	clear();
 	_hasDuplicate = terms.hasDuplicate();
 
 	for(const Term &term : terms)
@@ -105,7 +105,7 @@ void Terms::set(const Terms &terms, bool isUnique)
 
 void Terms::set(const QList<QList<QString> > &terms, bool isUnique)
 {
-	_terms.clear();
+	clear();
 
 	for(const QList<QString> &term : terms)
 		add(Term(term), isUnique);
@@ -113,7 +113,7 @@ void Terms::set(const QList<QList<QString> > &terms, bool isUnique)
 
 void Terms::set(const QList<QString> &terms, bool isUnique)
 {
-	_terms.clear();
+	clear();
 
 	for(const QString &term : terms)
 		add(Term(term), isUnique);
@@ -134,6 +134,7 @@ void Terms::add(const Term &term, bool isUnique)
 	{
 		if (!_hasDuplicate && contains(term)) _hasDuplicate = true;
 		_terms.push_back(term);
+		indexAppended();
 	}
 	else if (_parent != nullptr)
 	{
@@ -148,20 +149,29 @@ void Terms::add(const Term &term, bool isUnique)
 		}
 
 		if (result > 0)
+		{
 			_terms.insert(itr, term);
+			indexDrop();
+		}
 		else if (result == 0)
 		{
 			itr->setDraggable(term.isDraggable());
 			itr->setType(term.type());
 		}
 		else if (result < 0)
+		{
 			_terms.push_back(term);
+			indexAppended();
+		}
 	}
 	else
 	{
 		int i = indexOf(term);
 		if (i < 0)
+		{
 			_terms.push_back(term);
+			indexAppended();
+		}
 		else
 		{
 			_terms.at(i).setDraggable(term.isDraggable());
@@ -180,6 +190,7 @@ void Terms::insert(int index, const Term &term)
 			itr++;
 
 		_terms.insert(itr, term);
+		indexDrop();
 	}
 	else
 	{
@@ -197,6 +208,7 @@ void Terms::insert(int index, const Terms &terms)
 			itr++;
 
 		_terms.insert(itr, terms.begin(), terms.end());
+		indexDrop();
 	}
 	else
 	{
@@ -224,7 +236,7 @@ Term &Terms::at(size_t index)
 
 bool Terms::contains(const Term &term) const
 {
-	return std::find(_terms.begin(), _terms.end(), term) != _terms.end();
+	return indexOf(term) >= 0;
 }
 
 bool Terms::contains(const std::string & component)
@@ -234,36 +246,60 @@ bool Terms::contains(const std::string & component)
 
 int Terms::indexOf(const QString &component) const
 {
-	int i = 0;
-	for(const Term &term : _terms)
-	{
-		if (term.contains(component))
-			return i;
-		i++;
-	}
+	indexBuild();
 
-	return -1;
+	auto found = _index.components.find(component);
+	return found == _index.components.end() ? -1 : found->second;
 }
 
 int Terms::indexOf(const Term &term) const
 {
-	auto it = std::find(_terms.begin(), _terms.end(), term);
-	if (it == _terms.end())
-		return -1;
-	else
-		return it - _terms.begin();
+	indexBuild();
+
+	auto found = _index.terms.find(term);
+	return found == _index.terms.end() ? -1 : found->second;
 }
 
 
 bool Terms::contains(const QString & component)
 {
-	for(const Term &term : _terms)
-	{
-		if (term.contains(component))
-			return true;
-	}
+	return indexOf(component) >= 0;
+}
+
+void Terms::indexBuild() const
+{
+	if (_index.built)
+		return;
+
+	_index.clear();
+	_index.built = true;
+
+	for (size_t i = 0; i < _terms.size(); i++)
+		indexTerm(i);
+}
+
+void Terms::indexTerm(size_t index) const
+{
+	const Term & term = _terms[index];
+
+	// emplace leaves what is already there alone, so these keep pointing at the first one
+	_index.terms.emplace(term, int(index));
+	_index.termNames.emplace(term.asQString(), int(index));
+
+	for (const QString & component : term.components())
+		_index.components.emplace(component, int(index));
+}
 
-	return false;
+void Terms::indexAppended()
+{
+	if (_index.built)
+		indexTerm(_terms.size() - 1);
+}
+
+void Terms::indexDrop()
+{
+	if (_index.built)
+		_index.clear();
 }
 
 vector<string> Terms::asVector() const
@@ -340,64 +376,58 @@ Terms Terms::crossCombinations() const
 
 	Terms t;
 
-	for (uint r = 1; r <= _terms.size(); r++)
-	{
-		vector<bool> v(_terms.size());
-		fill(v.begin() + r, v.end(), true);
-
-		do {
+	for (size_t r = 1; r <= _terms.size(); r++)
+		combinations(r, [&](const Term & combination) { t.add(combination); });
 
-			vector<string> combination;
-
-			for (uint i = 0; i < _terms.size(); i++) {
-				if (!v[i])
-				{
-					vector<string> components = _terms.at(i).scomponents();
-					combination.insert(combination.end(), components.begin(), components.end());
-				}
-			}
+	return t;
+}
 
-			if (combination.size() == 1)
-				t.add(at(indexOf(combination[0])));
-			else
-				t.add(Term(combination));
+Terms Terms::wayCombinations(int ways) const
+{
+	Terms t;
 
-		} while (std::next_permutation(v.begin(), v.end()));
-	}
+	if (ways > 0)
+		combinations(size_t(ways), [&](const Term & combination) { t.add(combination); });
 
 	return t;
 }
 
-Terms Terms::wayCombinations(int ways) const
+void Terms::combinations(size_t ways, std::function<void(const Term &)> found) const
 {
-	Terms t;
+	if (ways == 0 || ways > _terms.size())
+		return;
+
+	// The indices of the terms in the current combination, stepped through in lexicographic order like an odometer
+	std::vector<size_t> chosen(ways);
+	for (size_t i = 0; i < ways; i++)
+		chosen[i] = i;
 
-	for (int r = ways; r <= ways; r++)
+	while (true)
 	{
-		vector<bool> v(_terms.size());
-		std::fill(v.begin() + r, v.end(), true);
+		if (ways == 1 && _terms[chosen[0]].size() == 1)
+			found(_terms[chosen[0]]); // Keeps its type and draggable flag
+		else
+		{
+			QStringList combination;
 
-		do {
+			for (size_t i : chosen)
+				combination.append(_terms[i].components());
 
-			vector<string> combination;
+			found(Term(combination));
+		}
 
-			for (uint i = 0; i < _terms.size(); ++i) {
-				if (!v[i])
-				{
-					vector<string> components = _terms.at(i).scomponents();
-					combination.insert(combination.end(), components.begin(), components.end());
-				}
-			}
+		// Find the rightmost index that can still move up, and put the ones after it right behind it
+		size_t i = ways;
+		while (i > 0 && chosen[i - 1] == _terms.size() - ways + i - 1)
+			i--;
 
-			if (combination.size() == 1)
-				t.add(at(indexOf(combination[0])));
-			else
-				t.add(Term(combination));
+		if (i == 0)
+			return;
 
-		} while (std::next_permutation(v.begin(), v.end()));
+		chosen[i - 1]++;
+		for (size_t j = i; j < ways; j++)
+			chosen[j] = chosen[j - 1] + 1;
 	}
-
-	return t;
 }
 
 Terms Terms::ffCombinations(const Terms &terms)
@@ -520,6 +550,7 @@ void Terms::setUndraggableTerms(const Terms& undraggableTerms)
 	}
 
 	_terms = newTerms;
+	indexDrop();
 }
 
 
@@ -556,16 +587,10 @@ int Terms::rankOf(const QString &component) const
 	if (_parent == nullptr)
 		return 0;
 
-	int index = 0;
+	_parent->indexBuild();
 
-	for(const Term& compare : _parent->terms())
-	{
-		if (compare.asQString() == component)
-			break;
-		index++;
-	}
-
-	return index;
+	auto found = _parent->_index.termNames.find(component);
+	return found == _parent->_index.termNames.end() ? int(_parent->_terms.size()) : found->second;
 }
 
 int Terms::termCompare(const Term &t1, const Term &t2) const
@@ -606,9 +631,12 @@ void Terms::remove(const Terms &terms)
 {
 	for(const Term &term : terms)
 	{
-		vector<Term>::iterator itr = find(_terms.begin(), _terms.end(), term);
-		if (itr != _terms.end())
-			_terms.erase(itr);
+		int i = indexOf(term);
+		if (i >= 0)
+		{
+			_terms.erase(_terms.begin() + i);
+			indexDrop();
+		}
 	}
 }
 
@@ -621,6 +649,8 @@ void Terms::remove(size_t pos, size_t n)
 
 	for (; n > 0 && itr != _terms.end(); n--)
 		_terms.erase(itr);
+
+	indexDrop();
 }
 
 void Terms::replace(int pos, const Term &term)
@@ -656,6 +686,9 @@ bool Terms::discardWhatDoesntContainTheseComponents(const Terms &terms)
 		_terms.end()
 	);
 
+	if (changed)
+		indexDrop();
+
 	return changed;
 }
 
@@ -683,6 +716,9 @@ bool Terms::discardWhatDoesContainTheseComponents(const Terms &terms)
 		_terms.end()
 	);
 
+	if (changed)
+		indexDrop();
+
 	return changed;
 }
 
@@ -708,6 +744,9 @@ bool Terms::discardWhatDoesContainTheseTerms(const Terms &terms)
 		_terms.end()
 	);
 
+	if (changed)
+		indexDrop();
+
 	return changed;
 }
 
@@ -735,12 +774,16 @@ bool Terms::discardWhatIsntTheseTerms(const Terms &terms, Terms *discarded)
 		_terms.end()
 	);
 
+	if (changed)
+		indexDrop();
+
 	return changed;
 }
 
 void Terms::clear()
 {
 	_terms.clear();
+	indexDrop();
 }
 
 size_t Terms::size() const
@@ -775,9 +818,12 @@ Terms::iterator Terms::end()
 
 void Terms::remove(const Term &term)
 {
-	vector<Term>::iterator itr = std::find(_terms.begin(), _terms.end(), term);
-	if (itr != end())
-		_terms.erase(itr);
+	int i = indexOf(term);
+	if (i >= 0)
+	{
+		_terms.erase(_terms.begin() + i);
+		indexDrop();
+	}
 }
 
 QSet<int> Terms::replaceVariableName(const std::string & oldName, const std::string & newName)
@@ -792,5 +838,8 @@ QSet<int> Terms::replaceVariableName(const std::string & oldName, const std::str
 		i++;
 	}
 
+	if (!change.isEmpty())
+		indexDrop();
+
 	return change;
 }
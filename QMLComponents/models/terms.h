@@ -22,6 +22,8 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <functional>
+#include <unordered_map>
 
 #include <QString>
 #include <QList>
@@ -110,6 +112,7 @@ public:
 
 	Terms crossCombinations()					const;
 	Terms wayCombinations(int ways)				const;
+	void  combinations(size_t ways, std::function<void(const Term &)> found) const; ///< Gives each combination of `ways` terms as soon as it is made, in the same order as the old next_permutation approach
 	Terms ffCombinations(const Terms &terms);
 	Terms combineTerms(JASPControl::CombinationType type);
 
@@ -131,9 +134,32 @@ private:
 	bool	termLessThan(const Term &t1, const Term &t2)			const;
 	bool	componentLessThan(const QString &c1, const QString &c2)	const;
 
+	struct termHash { size_t operator()(const Term & term) const { return term.hash(); } };
+
+	///Copies start without one and build their own when needed, the copy of a Terms is often just passed along
+	struct termsIndex
+	{
+		termsIndex() = default;
+		termsIndex(const termsIndex &)					{}
+		termsIndex & operator=(const termsIndex &)		{ clear(); return *this; }
+
+		void clear() { built = false; terms.clear(); termNames.clear(); components.clear(); }
+
+		bool										built = false;
+		std::unordered_map<Term, int, termHash>		terms;			///< term -> first index, order of components does not matter
+		std::unordered_map<QString, int>			termNames,		///< asQString -> first index, for rankOf of the Terms that have this as parent
+													components;		///< component -> index of the first term that contains it
+	};
+
+	void	indexBuild()				const;
+	void	indexTerm(size_t index)		const;
+	void	indexAppended();
+	void	indexDrop();
+
 	const Terms			*	_parent;
 	std::vector<Term>		_terms;
 	bool					_hasDuplicate = false;
+	mutable termsIndex		_index;
 };
 
 #endif // TERMS_H
@@ -17,6 +17,7 @@
 
 #include "jasprcpp.h"
 #include <fstream>
+#include <unordered_map>
 #include "tempfiles.h"
 
 static const	std::string NullString			= "null";
@@ -221,6 +222,22 @@ void STDCALL jaspRCPP_init(const char* buildYear, const char* version, RBridgeCa
 	_R_HOME = jaspRCPP_parseEvalStringReturn("R.home('')");
 	jaspRCPP_logString("R_HOME is: " + _R_HOME + "\n");
 	
+	//Computed columns are parsed and byte-compiled once by .compileComputedColumn, see jaspRCPP_compiledComputedColumnCode
+	jaspRCPP_parseEvalQNT(
+		".compileComputedColumn <- function(code) tryCatch(\n"
+		"    compiler::compile(as.call(c(as.name('{'), parse(text=code))), env=globalenv(), options=list(suppressAll=TRUE)),\n"
+		"    error = function(e) { .setRError(toString(e$message)); NULL }\n"
+		");\n"
+		".evalComputedColumn <- function(compiled) {\n"
+		"    sink(.outputSink); on.exit(sink());\n"
+		"    returnVal <- NULL;\n"
+		"    tryCatch(\n"
+		"        suppressWarnings({	returnVal <- eval(compiled, envir=globalenv())	}),\n"
+		"        error	= function(e) { .setRError( toString(e$message)) }\n"
+		"    );\n"
+		"    returnVal\n"
+		"}");
+
 	jaspRCPP_logString("initializeDoNotRemoveList().\n");
 	jaspRCPP_parseEvalQNT("jaspBase:::.initializeDoNotRemoveList()");
 }
@@ -453,42 +470,63 @@ void STDCALL jaspRCPP_rewriteImages(const char * name, int analysisID)
 
 
 
+///Parsing and byte-compiling the code of a computed column happens only the first time it is seen, after that the compiled code is looked up by the code itself.
+///Returns NULL if it didn't parse, in which case .compileComputedColumn already passed the error on to .setRError.
+static Rcpp::RObject jaspRCPP_compiledComputedColumnCode(const std::string & code)
+{
+	static std::unordered_map<std::string, Rcpp::RObject>	compiled;
+	static const size_t										maxCompiled = 1000; //Every edit of a computed column gives new code, so make sure this doesn't grow forever
+
+	auto found = compiled.find(code);
+	if(found != compiled.end())
+		return found->second;
+
+	static Rcpp::Function compileComputedColumn(".compileComputedColumn");
+
+	Rcpp::RObject compiledCode = compileComputedColumn(code);
+
+	if(compiledCode.isNULL())
+		return compiledCode;
+
+	if(compiled.size() >= maxCompiled)
+		compiled.clear();
+
+	return compiled[code] = compiledCode;
+}
+
 const char*	STDCALL jaspRCPP_evalComputedColumn(const char *rCode, const char * setColumnCode) 
 {
 	// Function to evaluate computed column R code from C++
 	// Returns string if R result is a string, else returns "null"
 	// Can also load the entire dataset if need be
-	bool setWd = false;
 
 	//jaspRCPP_logString(std::string("jaspRCPP_evalComputedColumn runs: \n\"") + rCode + "\"\nand \""+setColumnCode+"\"\n" );
 
 	lastErrorMessage = "";
-	rinside->instance()[".rCode"] = rCode;
-	const std::string rCodeTryCatch(""
-		"returnVal = NULL;	"
-		"tryCatch("
-		"    suppressWarnings({	returnVal <- eval(parse(text=.rCode))     }),	"
-		"    error	= function(e) { .setRError( toString(e$message)) } 	"
-		")"
-		"; returnVal	");
 
 	static std::string staticResult;
 	try
 	{
+		static Rcpp::Function evalComputedColumn(".evalComputedColumn");
+
 		try
 		{
-			rinside->instance()[".calcedVals"]	= Rcpp::RObject(jaspRCPP_parseEval(rCodeTryCatch,	false, false));
+			Rcpp::RObject compiled				= jaspRCPP_compiledComputedColumnCode(rCode);
+			rinside->instance()[".calcedVals"]	= compiled.isNULL() ? compiled : Rcpp::RObject(evalComputedColumn(compiled));
 		}
-		catch(std::runtime_error e)
+		catch(std::runtime_error & e)
 		{
 			jaspRCPP_setErrorMsg(e.what());	
 			staticResult						=	NullString;
-			rinside->instance()[".calcedVals"]	=	NULL;
+			rinside->instance()[".calcedVals"]	=	R_NilValue;
 		}
+
+		Rcpp::RObject compiledSetColumn	= jaspRCPP_compiledComputedColumnCode(setColumnCode),
+					  setColumnResult	= compiledSetColumn.isNULL() ? compiledSetColumn : Rcpp::RObject(evalComputedColumn(compiledSetColumn));
+
+		staticResult = Rf_isString(setColumnResult) ? Rcpp::as<std::string>(setColumnResult) : NullString;
 		
-		staticResult = jaspRCPP_parseEvalStringReturn(setColumnCode,	false, false);
-		
-		rinside->instance()[".calcedVals"]	=	NULL;
+		rinside->instance()[".calcedVals"]	=	R_NilValue;
 		
 	}
 	catch(...)
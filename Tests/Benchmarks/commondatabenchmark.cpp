@@ -0,0 +1,399 @@
+///
+/// Times the hot paths of CommonData on a synthetic dataset, without Qt, R or an engine.
+/// Run it with --help to see the options, the results are written as json (to stdout or --output) so they can be compared between commits.
+/// Every case is run --repeat times on the same data, the minimum and median are reported next to the time per row (or per cell).
+/// The database round trip (dataSetBatchedValuesUpdate and dbLoad) is best judged with --rows 1000000, at the default size sqlite overhead is a small part of it.
+/// The label cases use a nominal column with --labels distinct values, try 1000 up to 1000000 (with as many --rows) to see how they scale.
+/// The MultiReplacer cases decode --names encoded column names in results of about 100 bytes per row, next to looking for each name separately as a baseline.
+
+#include "dataset.h"
+#include "column.h"
+#include "filter.h"
+#include "columnutils.h"
+#include "multireplacer.h"
+#include "databaseinterface.h"
+#include "tempfiles.h"
+#include "processinfo.h"
+#include "log.h"
+#include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/device/null.hpp>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <random>
+
+struct BenchmarkConfig
+{
+	size_t		rows		= 100000,
+				columns		= 12,
+				labels		= 10000,
+				names		= 1000,
+				repeat		= 5;
+	unsigned	seed		= 20240101;
+	std::string	output		= "",
+				only		= "";
+};
+
+static BenchmarkConfig parseArguments(int argc, char * argv[])
+{
+	BenchmarkConfig config;
+
+	for(int i=1; i<argc; i++)
+	{
+		const std::string	arg		= argv[i];
+		const bool			hasNext	= i + 1 < argc;
+
+		if		(arg == "--rows"	&& hasNext)	config.rows		= std::stoul(argv[++i]);
+		else if	(arg == "--columns"	&& hasNext)	config.columns	= std::stoul(argv[++i]);
+		else if	(arg == "--labels"	&& hasNext)	config.labels	= std::max<size_t>(1, std::stoul(argv[++i]));
+		else if	(arg == "--names"	&& hasNext)	config.names	= std::max<size_t>(1, std::stoul(argv[++i]));
+		else if	(arg == "--repeat"	&& hasNext)	config.repeat	= std::max<size_t>(1, std::stoul(argv[++i]));
+		else if	(arg == "--seed"	&& hasNext)	config.seed		= std::stoul(argv[++i]);
+		else if	(arg == "--output"	&& hasNext)	config.output	= argv[++i];
+		else if	(arg == "--only"	&& hasNext)	config.only		= argv[++i];
+		else
+		{
+			std::cerr	<< "Usage: " << argv[0] << " [--rows N] [--columns N] [--labels N] [--names N] [--repeat N] [--seed N] [--output file.json] [--only substring-of-case-name]" << std::endl;
+			std::exit(arg == "--help" ? 0 : 1);
+		}
+	}
+
+	return config;
+}
+
+///The kinds of columns we see in practice, every column of the synthetic dataset is one of these in turn
+enum class syntheticKind { integers, doubles, commaDoubles, text, mixedWithEmpty, fewLevels };
+static const stringvec syntheticKindNames = { "integers", "doubles", "commaDoubles", "text", "mixedWithEmpty", "fewLevels" };
+
+static stringvec syntheticColumn(syntheticKind kind, size_t rows, std::mt19937 & rng)
+{
+	std::uniform_int_distribution<int>		wideInt(-100000, 100000),
+											fewInts(1, 5),
+											percent(0, 99);
+	std::normal_distribution<double>		normal(10.0, 3.0);
+	static const stringvec					words = { "apple", "pear", "<U+00E9>clair", "banana", "kiwi", "mango", "cherry", "plum" };
+
+	stringvec values;
+	values.reserve(rows);
+
+	for(size_t r=0; r<rows; r++)
+		switch(kind)
+		{
+		case syntheticKind::integers:		values.push_back(std::to_string(wideInt(rng)));															break;
+		case syntheticKind::doubles:		values.push_back(ColumnUtils::doubleToString(normal(rng)));												break;
+		case syntheticKind::commaDoubles:	{ std::string d = ColumnUtils::doubleToString(normal(rng)); std::replace(d.begin(), d.end(), '.', ','); values.push_back(d); break; }
+		case syntheticKind::text:			values.push_back(words[rng() % words.size()] + std::to_string(rng() % 50));								break;
+		case syntheticKind::mixedWithEmpty:	values.push_back(percent(rng) < 10 ? "" : percent(rng) < 5 ? "NA" : std::to_string(wideInt(rng) / 100));	break;
+		case syntheticKind::fewLevels:		values.push_back(std::to_string(fewInts(rng)));															break;
+		}
+
+	return values;
+}
+
+class Benchmark
+{
+public:
+	Benchmark(const BenchmarkConfig & config) : _config(config) {}
+
+	///Runs `run` config.repeat times, `prepare` runs before each of those but isn't timed
+	void measure(const std::string & name, size_t items, std::function<void()> run, std::function<void()> prepare = [](){})
+	{
+		if(_config.only != "" && name.find(_config.only) == std::string::npos)
+			return;
+
+		std::vector<double> ms;
+
+		for(size_t i=0; i<_config.repeat; i++)
+		{
+			prepare();
+
+			auto start = std::chrono::steady_clock::now();
+			run();
+			ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+
+		std::sort(ms.begin(), ms.end());
+
+		Json::Value result		= Json::objectValue;
+		result["name"]			= name;
+		result["items"]			= Json::UInt64(items);
+		result["repeat"]		= Json::UInt64(ms.size());
+		result["minMs"]			= ms.front();
+		result["medianMs"]		= ms[ms.size() / 2];
+		result["maxMs"]			= ms.back();
+		result["nsPerItem"]		= items ? ms[ms.size() / 2] * 1e6 / items : 0.0;
+
+		std::cerr << name << ": median " << ms[ms.size() / 2] << "ms (" << result["nsPerItem"].asDouble() << "ns per item)" << std::endl;
+
+		_results.append(result);
+	}
+
+	Json::Value report() const
+	{
+		Json::Value report		= Json::objectValue;
+		report["benchmark"]		= "CommonData";
+		report["rows"]			= Json::UInt64(_config.rows);
+		report["columns"]		= Json::UInt64(_config.columns);
+		report["labels"]		= Json::UInt64(_config.labels);
+		report["names"]			= Json::UInt64(_config.names);
+		report["seed"]			= _config.seed;
+		report["results"]		= _results;
+
+		return report;
+	}
+
+private:
+	const BenchmarkConfig	&	_config;
+	Json::Value					_results = Json::arrayValue;
+};
+
+int main(int argc, char * argv[])
+{
+	const BenchmarkConfig config = parseArguments(argc, argv);
+
+	static boost::iostreams::stream<boost::iostreams::null_sink> nullstream((boost::iostreams::null_sink()));
+	Log::init(&nullstream);
+	Log::setWhere(logType::null); //The data paths log quite a bit, which is not what we want to measure
+
+	TempFiles::init(ProcessInfo::currentPID());
+
+	std::mt19937				rng(config.seed);
+	std::vector<stringvec>		data;
+	std::vector<syntheticKind>	kinds;
+	size_t						cells = config.rows * config.columns;
+
+	for(size_t c=0; c<config.columns; c++)
+	{
+		kinds.push_back(syntheticKind(c % syntheticKindNames.size()));
+		data.push_back(syntheticColumn(kinds.back(), config.rows, rng));
+	}
+
+	Benchmark bench(config);
+
+	{
+		stringvec	allValues;
+		for(const stringvec & column : data)
+			allValues.insert(allValues.end(), column.begin(), column.end());
+
+		bench.measure("ColumnUtils::sniffValues", allValues.size(), [&]()
+		{
+			ColumnUtils::sniffValues(allValues);
+		});
+
+		bench.measure("ColumnUtils::getDoubleValue", allValues.size(), [&]()
+		{
+			double dbl;
+			for(const std::string & value : allValues)
+				ColumnUtils::getDoubleValue(value, dbl);
+		});
+
+		std::string escaped, converted;
+		for(const std::string & value : syntheticColumn(syntheticKind::text, config.rows, rng))
+			escaped += "{\"cell\":\"" + value + "\"},";
+
+		bench.measure("ColumnUtils::convertEscapedUnicodeToUTF8", escaped.size(), [&]()
+		{
+			ColumnUtils::convertEscapedUnicodeToUTF8(converted);
+		}, [&](){ converted = escaped; });
+	}
+
+	{
+		strstrmap	decodeNames;
+		stringvec	encodedNames;
+
+		for(size_t n=0; n<config.names; n++)
+		{
+			encodedNames.push_back("JaspColumn_." + std::to_string(n) + "._Encoded");
+			decodeNames[encodedNames.back()] = "column " + std::to_string(n);
+		}
+
+		std::string results, decoded;
+		for(size_t r=0; r<config.rows; r++)
+			results += "{\"name\":\"" + encodedNames[rng() % encodedNames.size()] + "\",\"value\":" + std::to_string(r) + ",\"title\":\"Descriptives of <em>" + encodedNames[rng() % encodedNames.size()] + "</em>\"},";
+
+		MultiReplacer replacer;
+
+		bench.measure("MultiReplacer::set", config.names, [&]()
+		{
+			replacer.set(decodeNames);
+		});
+
+		bench.measure("MultiReplacer::replaceAll results", results.size(), [&]()
+		{
+			replacer.replaceAll(decoded);
+		}, [&](){ decoded = results; });
+
+		bench.measure("std::string::find per name results", results.size(), [&]()
+		{
+			for(const auto & fromTo : decodeNames)
+				for(size_t pos = decoded.find(fromTo.first); pos != std::string::npos; pos = decoded.find(fromTo.first, pos + fromTo.second.size()))
+					decoded.replace(pos, fromTo.first.size(), fromTo.second);
+		}, [&](){ decoded = results; });
+	}
+
+	DatabaseInterface	db(true);
+	DataSet			*	dataSet = new DataSet();
+
+	dataSet->beginBatchedToDB();
+	dataSet->setColumnCount(config.columns);
+	dataSet->setRowCount(config.rows);
+
+	for(size_t c=0; c<config.columns; c++)
+		dataSet->column(c)->setName("column" + std::to_string(c) + "_" + syntheticKindNames[size_t(kinds[c])]);
+
+	bench.measure("Column::setValues", cells, [&]()
+	{
+		for(size_t c=0; c<config.columns; c++)
+			dataSet->column(c)->setValues(data[c], {}, 10);
+	});
+
+	bench.measure("DatabaseInterface::dataSetBatchedValuesUpdate", cells, [&]()
+	{
+		db.dataSetBatchedValuesUpdate(dataSet);
+	});
+
+	dataSet->endBatchedToDB();
+
+	//Single value edits, like the data editor does them, they all run the same prepared statement
+	const size_t edits = std::min<size_t>(config.rows, 10000);
+
+	bench.measure("DatabaseInterface::columnSetValue", edits, [&]()
+	{
+		Column * column = dataSet->column(0);
+
+		for(size_t r=0; r<edits; r++)
+			db.columnSetValue(column->id(), r, column->ints()[r], column->dbls()[r]);
+	});
+
+	bench.measure("DataSet::dbLoad", cells, [&]()
+	{
+		DataSet loaded(0);
+		loaded.dbLoad(dataSet->id());
+	});
+
+	bench.measure("Column::labelsTempCount", cells, [&]()
+	{
+		for(Column * column : dataSet->columns())
+			column->labelsTempCount();
+	}, [&]()
+	{
+		for(Column * column : dataSet->columns())
+			column->labelsTempReset();
+	});
+
+	boolvec filterResult(config.rows);
+	for(size_t r=0; r<config.rows; r++)
+		filterResult[r] = rng() % 4 != 0;
+
+	bench.measure("Filter::setFilterVector", config.rows, [&]()
+	{
+		dataSet->filter()->setFilterVector(filterResult);
+	}, [&]()
+	{
+		dataSet->filter()->setFilterVector(boolvec(config.rows, true)); //Otherwise there would be nothing to change after the first run
+	});
+
+	dataSet->filter()->setFilterVector(filterResult);
+
+	bench.measure("Column::dataAsRLevels", cells, [&]()
+	{
+		intvec values;
+		for(Column * column : dataSet->columns())
+			column->dataAsRLevels(values, dataSet->filter()->filtered());
+	});
+
+	//Every distinct value of a nominal column becomes a label, so importing one with many of them looks up labels by value and display for every row
+	const size_t	distinctLabels	= std::min(config.labels, config.rows);
+	stringvec		levels;
+	levels.reserve(config.rows);
+
+	for(size_t r=0; r<config.rows; r++)
+		levels.push_back("level" + std::to_string(r % distinctLabels));
+
+	Column * levelsColumn = dataSet->newColumn("levels");
+
+	bench.measure("Column::setValues with many labels", config.rows, [&]()
+	{
+		levelsColumn->beginBatchedLabelsDB();
+		levelsColumn->setValues(levels, {}, 10);
+		levelsColumn->endBatchedLabelsDB();
+	}, [&]()
+	{
+		levelsColumn->labelsClear();
+	});
+
+	bench.measure("Column::labelByValueAndDisplay", distinctLabels, [&]()
+	{
+		for(size_t l=0; l<distinctLabels; l++)
+			levelsColumn->labelByValueAndDisplay(levels[l], levels[l]);
+	});
+
+	bench.measure("Column::labelsMergeDuplicates", distinctLabels, [&]()
+	{
+		levelsColumn->labelsMergeDuplicates();
+	});
+
+	//Outside of a batch, like the label editor or typing in the data editor does it, each of these writes the order of the labels that moved
+	const size_t	addedLabels		= std::min<size_t>(distinctLabels, 5000);
+	Column		*	addedColumn		= dataSet->newColumn("addedLabels");
+
+	addedColumn->setRowCount(dataSet->rowCount());
+
+	bench.measure("Column::labelsAdd outside batch", addedLabels, [&]()
+	{
+		for(size_t l=0; l<addedLabels; l++)
+			addedColumn->labelsAdd(levels[l]);
+	}, [&]()
+	{
+		addedColumn->labelsClear();
+	});
+
+	//Pasting into a column that is empty at first, each cell has to know whether it is the first value to decide the columntype
+	const size_t	pastedCells		= std::min<size_t>(config.rows, 100000);
+	const stringvec	pastedValues	= syntheticColumn(syntheticKind::doubles, pastedCells, rng);
+	Column		*	pastedColumn	= dataSet->newColumn("pasted");
+
+	pastedColumn->setRowCount(dataSet->rowCount());
+
+	bench.measure("Column::setStringValue paste", pastedCells, [&]()
+	{
+		for(size_t p=0; p<pastedCells; p++)
+			pastedColumn->setStringValue(p * (config.rows / pastedCells), pastedValues[p], "", false);
+	}, [&]()
+	{
+		pastedColumn->setDefaultValues(columnType::unknown);
+	});
+
+	//Like the data editor inserting and deleting a selection of rows, this includes writing the whole dataset to the db again
+	const size_t	movedRows	= std::max<size_t>(1, config.rows / 100);
+	rowRanges		scattered;
+
+	for(size_t r=0; r<movedRows; r++)
+		scattered.push_back({r * 50, 1});
+
+	bench.measure("DataSet::rowsInsert", movedRows * dataSet->columnCount(), [&]()
+	{
+		dataSet->rowsInsert(config.rows / 2, movedRows);
+	});
+
+	bench.measure("DataSet::rowsDelete scattered", movedRows * dataSet->columnCount(), [&]()
+	{
+		dataSet->rowsDelete(scattered);
+	});
+
+	const Json::Value report = bench.report();
+
+	if(config.output == "")
+		std::cout << report.toStyledString() << std::endl;
+	else
+	{
+		std::ofstream out(config.output);
+		out << report.toStyledString();
+	}
+
+	delete dataSet;
+	TempFiles::clearSessionDir();
+
+	return 0;
+}
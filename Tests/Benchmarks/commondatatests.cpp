@@ -0,0 +1,502 @@
+///
+/// Randomized correctness checks for CommonData, next to the benchmark because they need the same: only CommonData, no Qt, R or an engine.
+/// Run it with --help to see the options, it prints what failed and exits with 1 if anything did, so ctest can run it.
+/// ColumnUtils::convertEscapedUnicodeToUTF8 is compared with the regex based decoder it replaced on randomly assembled inputs,
+/// and with a straightforward reference for what the old one couldn't do: surrogates and a buffer that ends halfway an escape.
+/// JournalReplay gets journals of random records, sometimes with the last line cut short, and is compared with a model of what they add up to.
+
+#include "columnutils.h"
+#include "journalreplay.h"
+#include "log.h"
+#include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/device/null.hpp>
+#include <iostream>
+#include <sstream>
+#include <codecvt>
+#include <locale>
+#include <algorithm>
+#include <numeric>
+#include <memory>
+#include <random>
+#include <regex>
+#include <map>
+
+struct TestConfig
+{
+	size_t		iterations	= 20000;
+	unsigned	seed		= 20240101;
+};
+
+static TestConfig parseArguments(int argc, char * argv[])
+{
+	TestConfig config;
+
+	for(int i=1; i<argc; i++)
+	{
+		const std::string	arg		= argv[i];
+		const bool			hasNext	= i + 1 < argc;
+
+		if		(arg == "--iterations"	&& hasNext)	config.iterations	= std::stoul(argv[++i]);
+		else if	(arg == "--seed"		&& hasNext)	config.seed			= std::stoul(argv[++i]);
+		else
+		{
+			std::cerr	<< "Usage: " << argv[0] << " [--iterations N] [--seed N]" << std::endl;
+			std::exit(arg == "--help" ? 0 : 1);
+		}
+	}
+
+	return config;
+}
+
+///The decoder as it was before it became a single pass, kept here verbatim to compare with
+namespace oldDecoder
+{
+	static std::string codepointToUTF8(std::string hex)
+	{
+		std::istringstream iss(hex);
+
+		uint32_t bytes;
+#ifdef _WIN32
+		static std::wstring_convert<std::codecvt_utf8<unsigned int>, unsigned int> conv;
+#else
+		static std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv;
+#endif
+		if (iss >> std::hex >> bytes) hex = conv.to_bytes(char32_t(bytes));
+
+		return hex;
+	}
+
+	static void convertEscapedUnicodeToUTF8(std::string& inputStr)
+	{
+		static const std::regex unicodeExpression ("<U\\+([0-9a-fA-F]{4})>");
+
+		std::smatch match;
+		auto begin	= inputStr.cbegin();
+
+		while (std::regex_search(begin, inputStr.cend(), match, unicodeExpression))
+		{
+			std::string utf8 = codepointToUTF8(match[1].str());
+			auto pos = match.position(0);
+			inputStr.replace(begin + pos, begin + pos + 8, utf8);
+			begin = inputStr.begin() + pos;
+		}
+	}
+}
+
+static std::string utf8(char32_t codepoint)
+{
+	std::string out;
+
+	if(codepoint < 0x80)
+		out += char(codepoint);
+	else if(codepoint < 0x800)
+	{
+		out += char(0xC0 |  (codepoint >> 6));
+		out += char(0x80 |  (codepoint			& 0x3F));
+	}
+	else if(codepoint < 0x10000)
+	{
+		out += char(0xE0 |  (codepoint >> 12));
+		out += char(0x80 | ((codepoint >> 6)	& 0x3F));
+		out += char(0x80 |  (codepoint			& 0x3F));
+	}
+	else
+	{
+		out += char(0xF0 |  (codepoint >> 18));
+		out += char(0x80 | ((codepoint >> 12)	& 0x3F));
+		out += char(0x80 | ((codepoint >> 6)	& 0x3F));
+		out += char(0x80 |  (codepoint			& 0x3F));
+	}
+
+	return out;
+}
+
+///The codepoint of a "<U+FFFF>" at pos, or -1
+static int32_t escapeAt(const std::string & in, size_t pos)
+{
+	static const std::regex escape("<U\\+[0-9a-fA-F]{4}>");
+
+	if(pos + 8 > in.size() || !std::regex_match(in.begin() + pos, in.begin() + pos + 8, escape))
+		return -1;
+
+	return std::stoi(in.substr(pos + 3, 4), nullptr, 16);
+}
+
+///Decodes one escape at a time into a new string, combining surrogate pairs and leaving lone surrogates as they are
+static std::string referenceDecode(const std::string & in)
+{
+	std::string out;
+
+	for(size_t i=0; i<in.size();)
+	{
+		int32_t codepoint = escapeAt(in, i);
+
+		if(codepoint >= 0xD800 && codepoint <= 0xDBFF)
+		{
+			int32_t low = escapeAt(in, i + 8);
+
+			if(low >= 0xDC00 && low <= 0xDFFF)
+			{
+				out += utf8(0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00));
+				i	+= 16;
+				continue;
+			}
+		}
+
+		if(codepoint < 0 || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+			out += in[i++];
+		else
+		{
+			out += utf8(codepoint);
+			i	+= 8;
+		}
+	}
+
+	return out;
+}
+
+///Assembles inputs out of text, escapes and things that almost are escapes
+class InputGenerator
+{
+public:
+	InputGenerator(unsigned seed) : _rng(seed) {}
+
+	///With surrogates the old decoder throws, so those only go to the reference
+	std::string generate(bool surrogates)
+	{
+		std::string input;
+		const size_t pieces = _rng() % 12;
+
+		for(size_t p=0; p<pieces; p++)
+			switch(_rng() % (surrogates ? 7 : 4))
+			{
+			case 0:	input += text();																		break;
+			case 1:	input += escape(codepoint());															break;
+			case 2:	input += malformed();																	break;
+			case 3:	input += "<";																			break;
+			case 4:	input += escape(0xD800 + _rng() % 0x400) + escape(0xDC00 + _rng() % 0x400);			break;
+			case 5:	input += escape(0xD800 + _rng() % 0x800);												break; //lone high or low
+			case 6:	input += escape(0xDC00 + _rng() % 0x400) + escape(0xD800 + _rng() % 0x400);			break; //wrong way around
+			}
+
+		return input;
+	}
+
+private:
+	std::string text()
+	{
+		static const std::string alphabet = "abz {}\":,.-_0123456789éU+>";
+
+		std::string out;
+		for(size_t i=_rng() % 6; i>0; i--)
+			out += alphabet[_rng() % alphabet.size()];
+
+		return out;
+	}
+
+	///Never one that decodes to something that could be part of an escape, the old decoder scanned its own output again and would decode the combination as well
+	char32_t codepoint()
+	{
+		static const std::vector<char32_t> interesting = { 0x0000, 0x0009, 0x0021, 0x007F, 0x0080, 0x00E9, 0x07FF, 0x0800, 0x20AC, 0xD7FF, 0xE000, 0xFFFD, 0xFFFF };
+
+		if(_rng() % 2)
+			return interesting[_rng() % interesting.size()];
+
+		char32_t codepoint;
+
+		do		codepoint = 0x80 + _rng() % (0x10000 - 0x80);
+		while	(codepoint >= 0xD800 && codepoint <= 0xDFFF);
+
+		return codepoint;
+	}
+
+	std::string escape(char32_t codepoint)
+	{
+		static const char	*	upper = "0123456789ABCDEF",
+							*	lower = "0123456789abcdef";
+		const char			*	digits = _rng() % 2 ? upper : lower;
+
+		std::string out = "<U+";
+		for(int shift=12; shift>=0; shift-=4)
+			out += digits[(codepoint >> shift) & 0xF];
+
+		return out + ">";
+	}
+
+	///Cut off, a non-hex digit, the wrong case or sign, or an escape within an escape
+	std::string malformed()
+	{
+		std::string valid = escape(codepoint());
+
+		switch(_rng() % 6)
+		{
+		case 0:		return valid.substr(0, 1 + _rng() % 7);
+		case 1:		valid[3 + _rng() % 4] = "gGxz <"[_rng() % 6];	return valid;
+		case 2:		valid[1] = 'u';									return valid;
+		case 3:		valid[2] = '-';									return valid;
+		case 4:		valid.pop_back();								return valid + "<";
+		default:	return valid.substr(0, 3 + _rng() % 4) + escape(codepoint());
+		}
+	}
+
+	std::mt19937 _rng;
+};
+
+class Checks
+{
+public:
+	void check(const std::string & what, const std::string & input, const std::string & expected, const std::string & got)
+	{
+		_checked++;
+
+		if(expected == got)
+			return;
+
+		if(++_failed <= 10)
+			std::cerr << what << " failed for input '" << input << "':\n  expected '" << expected << "'\n  but got  '" << got << "'" << std::endl;
+	}
+
+	int report() const
+	{
+		std::cerr << _checked << " checks, " << _failed << " failed" << std::endl;
+		return _failed ? 1 : 0;
+	}
+
+private:
+	size_t	_checked	= 0,
+			_failed		= 0;
+};
+
+static std::string newDecode(std::string input)
+{
+	ColumnUtils::convertEscapedUnicodeToUTF8(input);
+	return input;
+}
+
+///Only the first size bytes are given to the decoder, in a buffer of exactly that size so reading beyond it shows up under a sanitizer
+static std::string newDecodePrefix(const std::string & input, size_t size)
+{
+	std::unique_ptr<char[]> buffer(new char[size]);
+	std::copy(input.begin(), input.begin() + size, buffer.get());
+
+	return std::string(buffer.get(), ColumnUtils::convertEscapedUnicodeToUTF8(buffer.get(), size));
+}
+
+static std::string journalAnalysis(size_t id, const std::string & title)
+{
+	Json::Value record			= Json::objectValue;
+	record["journal"]			= "analysis";
+	record["analysis"]["id"]	= Json::UInt64(id);
+	record["analysis"]["title"]	= title;
+
+	return Json::FastWriter().write(record);
+}
+
+static std::string journalRemoved(size_t id)
+{
+	Json::Value record	= Json::objectValue;
+	record["journal"]	= "removed";
+	record["id"]		= Json::UInt64(id);
+
+	return Json::FastWriter().write(record);
+}
+
+static std::string journalOrder(const std::vector<size_t> & ids)
+{
+	Json::Value record	= Json::objectValue;
+	record["journal"]	= "order";
+	record["ids"]		= Json::arrayValue;
+
+	for(size_t id : ids)
+		record["ids"].append(Json::UInt64(id));
+
+	return Json::FastWriter().write(record);
+}
+
+///"id:title" of each analysis in the order replay put them
+static std::string replayedAnalyses(const JournalReplay & replayed)
+{
+	std::string out;
+
+	for(const Json::Value & analysis : replayed.analysesData["analyses"])
+		out += analysis["id"].asString() + ":" + analysis["title"].asString() + " ";
+
+	return out;
+}
+
+static std::string replayAnalyses(const std::string & journal)
+{
+	std::istringstream in(journal);
+	return replayedAnalyses(JournalReplay::replay(in));
+}
+
+///A random journal of analyses that are added, changed and removed, and of the order they are in, with what it should replay to
+class JournalGenerator
+{
+public:
+	JournalGenerator(unsigned seed) : _rng(seed) {}
+
+	///The last record is cut short when truncate, the model then leaves it out
+	std::string generate(bool truncate, std::string & expected)
+	{
+		std::map<size_t, std::string>	analyses;
+		std::vector<size_t>				order;
+		std::string						journal,
+										record;
+		const size_t					records = 1 + _rng() % 12;
+
+		for(size_t r=0; r<records; r++)
+		{
+			const size_t id = _rng() % 6;
+
+			switch(_rng() % 4)
+			{
+			case 0:
+			case 1:	record = journalAnalysis(id, "t" + std::to_string(_rng() % 100));	break;
+			case 2:	record = journalRemoved(id);										break;
+			case 3:
+			{
+				std::vector<size_t> ids;
+				for(size_t i=0; i<8; i++)
+					if(_rng() % 2)
+						ids.push_back(i);
+
+				std::shuffle(ids.begin(), ids.end(), _rng);
+				record = journalOrder(ids);
+				break;
+			}
+			}
+
+			if(truncate && r + 1 == records)
+			{
+				journal += record.substr(0, _rng() % (record.size() - 1)); //Never up to the closing brace, the newline isn't what makes it incomplete
+				break;
+			}
+
+			journal += record;
+			apply(record, analyses, order);
+		}
+
+		expected = "";
+
+		for(size_t id : order)
+			if(analyses.count(id))
+			{
+				expected += std::to_string(id) + ":" + analyses[id] + " ";
+				analyses.erase(id);
+			}
+
+		for(const auto & idTitle : analyses)
+			expected += std::to_string(idTitle.first) + ":" + idTitle.second + " ";
+
+		return journal;
+	}
+
+private:
+	static void apply(const std::string & line, std::map<size_t, std::string> & analyses, std::vector<size_t> & order)
+	{
+		Json::Value record;
+		Json::Reader().parse(line, record);
+
+		const std::string type = record["journal"].asString();
+
+		if		(type == "analysis")	analyses[record["analysis"]["id"].asUInt64()] = record["analysis"]["title"].asString();
+		else if	(type == "removed")		analyses.erase(record["id"].asUInt64());
+		else if	(type == "order")
+		{
+			order.clear();
+			for(const Json::Value & id : record["ids"])
+				order.push_back(id.asUInt64());
+		}
+	}
+
+	std::mt19937 _rng;
+};
+
+static void checkJournalReplay(const TestConfig & config, Checks & checks)
+{
+	const std::string	ordered		= journalAnalysis(1, "a") + journalAnalysis(2, "b") + journalAnalysis(3, "c") + journalOrder({3, 1, 2}) + journalAnalysis(4, "d"),
+						removed		= journalAnalysis(1, "a") + journalAnalysis(2, "b") + journalRemoved(2) + journalOrder({1, 2}),
+						readded		= removed + journalAnalysis(2, "b2"),
+						complete	= journalAnalysis(1, "a") + journalAnalysis(1, "a2"),
+						cut			= complete + journalRemoved(1).substr(0, 10);
+
+	checks.check("replay in the last order, new ones after",	ordered,					"3:c 1:a 2:b 4:d ",	replayAnalyses(ordered));
+	checks.check("replay of a removed analysis",				removed,					"1:a ",				replayAnalyses(removed));
+	checks.check("replay of a removed analysis added again",	readded,					"1:a 2:b2 ",		replayAnalyses(readded));
+	checks.check("replay of a later record for the same id",	complete,					"1:a2 ",			replayAnalyses(complete));
+	checks.check("replay of a journal cut short",				cut,						"1:a2 ",			replayAnalyses(cut));
+
+	std::istringstream	cutStream(cut);
+	JournalReplay		cutReplayed = JournalReplay::replay(cutStream);
+	checks.check("records replayed of a journal cut short",		cut,						"2",				std::to_string(cutReplayed.records));
+
+	Json::Value workspace	= Json::objectValue,
+				columns		= Json::objectValue;
+	workspace["journal"]	= "workspace";
+	workspace["file"]		= "some.jasp";
+	workspace["data"]		= true;
+	columns["journal"]		= "columns";
+	columns["columns"]		= Json::arrayValue;
+	columns["columns"].append("A");
+	columns["columns"].append("B");
+
+	std::istringstream	workspaceStream(Json::FastWriter().write(workspace) + Json::FastWriter().write(columns) + journalAnalysis(1, "a"));
+	JournalReplay		workspaceReplayed = JournalReplay::replay(workspaceStream);
+	checks.check("replay of the workspace",						"",							"some.jasp 1 A,B,",	workspaceReplayed.file + " " + std::to_string(workspaceReplayed.hasData) + " " + std::accumulate(workspaceReplayed.columnsEdited.begin(), workspaceReplayed.columnsEdited.end(), std::string(), [](std::string l, const std::string & r) { return l + r + ","; }));
+
+	JournalGenerator generator(config.seed);
+
+	for(size_t i=0; i<config.iterations / 10; i++)
+	{
+		std::string			expected;
+		const bool			truncate	= i % 2;
+		const std::string	journal		= generator.generate(truncate, expected);
+
+		checks.check(truncate ? "same as the model when cut short" : "same as the model", journal, expected, replayAnalyses(journal));
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	const TestConfig config = parseArguments(argc, argv);
+
+	static boost::iostreams::stream<boost::iostreams::null_sink> nullstream((boost::iostreams::null_sink()));
+	Log::init(&nullstream);
+	Log::setWhere(logType::null);
+
+	InputGenerator	generator(config.seed);
+	std::mt19937	rng(config.seed);
+	Checks			checks;
+
+	//The cases where the old decoder did something else on purpose: it decoded its own output again, and surrogates made it throw
+	checks.check("no second decoding",	"<U+003C>U+0041>",		"<U+0041>",						newDecode("<U+003C>U+0041>"));
+	checks.check("no second decoding",	"<U+004<U+0031>>",		"<U+0041>",						newDecode("<U+004<U+0031>>"));
+	checks.check("surrogate pair",		"<U+D83D><U+DE00>",		utf8(0x1F600),					newDecode("<U+D83D><U+DE00>"));
+	checks.check("lone surrogate",		"<U+D83D>x",			"<U+D83D>x",					newDecode("<U+D83D>x"));
+	checks.check("truncated pair",		"<U+D83D><U+DE0",		"<U+D83D><U+DE0",				newDecode("<U+D83D><U+DE0"));
+	checks.check("escape at the end",	"a<U+00E9>",			"a" + utf8(0xE9),				newDecode("a<U+00E9>"));
+
+	for(size_t i=0; i<config.iterations; i++)
+	{
+		const std::string input = generator.generate(false);
+
+		std::string old = input;
+		oldDecoder::convertEscapedUnicodeToUTF8(old);
+
+		checks.check("same as the old decoder", input, old, newDecode(input));
+	}
+
+	for(size_t i=0; i<config.iterations; i++)
+	{
+		const std::string	input	= generator.generate(true);
+		const size_t		cut		= input.size() ? rng() % (input.size() + 1) : 0;
+
+		checks.check("same as the reference",				input,					referenceDecode(input),					newDecode(input));
+		checks.check("same as the reference when cut off",	input.substr(0, cut),	referenceDecode(input.substr(0, cut)),	newDecodePrefix(input, cut));
+	}
+
+	checkJournalReplay(config, checks);
+
+	return checks.report();
+}
@@ -47,6 +47,7 @@ option(USE_CCACHE "Whether to use ccache for build" OFF)
 option(RUN_IWYU "Whether to run Include What You Use" OFF)
 option(INSTALL_R_MODULES "Whether or not installing R Modules" ON)
 option(BUILD_TESTS "Whether to build the test suits" OFF)
+option(BUILD_BENCHMARKS "Whether to build the CommonData benchmark and tests" OFF)
 option(USE_CONAN "Whether to use CONAN package manager" OFF)
 
 # ------------